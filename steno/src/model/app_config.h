@@ -5,6 +5,20 @@
 
 namespace Model
 {
+// Values of ODAS_TRANSPORT, odaslive sends its streams on TCP sockets unless it supports shared memory
+const char* const ODAS_TRANSPORT_TCP = "tcp";
+const char* const ODAS_TRANSPORT_SHARED_MEMORY = "shm";
+
+// Values of CAMERA_CAPTURE_MEMORY, the camera captures in the pipeline buffers unless it only supports its own
+const char* const CAMERA_CAPTURE_MEMORY_MMAP = "mmap";
+const char* const CAMERA_CAPTURE_MEMORY_USERPTR = "userptr";
+const char* const CAMERA_CAPTURE_MEMORY_DMABUF = "dmabuf";
+
+// Values of AUDIO_OUTPUT, the mix is played on PulseAudio unless it is recorded to a file of the output folder
+const char* const AUDIO_OUTPUT_PULSEAUDIO = "pulseaudio";
+const char* const AUDIO_OUTPUT_WAV_FILE = "wav";
+const char* const AUDIO_OUTPUT_RAW_FILE = "raw";
+
 class AppConfig : public BaseConfig
 {
     Q_OBJECT
@@ -13,7 +27,11 @@ class AppConfig : public BaseConfig
     {
         OUTPUT_FOLDER,
         MICROPHONE_CONFIGURATION,
-        ODAS_LIBRARY
+        ODAS_LIBRARY,
+        ODAS_TRANSPORT,
+        CAMERA_CAPTURE_MEMORY,
+        ODAS_SOCKET_FOLDER,
+        AUDIO_OUTPUT
     };
     Q_ENUM(Key)
 
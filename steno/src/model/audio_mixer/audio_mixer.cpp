@@ -0,0 +1,278 @@
+#include "audio_mixer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "model/stream/utils/audio/sample_conversion.h"
+#include "model/stream/utils/math/math_constants.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define AUDIO_MIXER_AVX2
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define AUDIO_MIXER_NEON
+#endif
+
+namespace
+{
+const char* OUTPUT_RING_SUBSYSTEM = "audio output ring";
+
+using MixFunction = void (*)(const float* sourceLane, const float* gainRamp, float gain, float gainDelta,
+                             std::size_t frameCount, float* channelLane);
+
+/**
+ * @brief Add a source to a channel with a gain interpolated over the chunk, the lanes are contiguous.
+ */
+void mixLaneScalar(const float* sourceLane, const float* gainRamp, float gain, float gainDelta, std::size_t frameCount,
+                   float* channelLane)
+{
+    for (std::size_t frame = 0; frame < frameCount; ++frame)
+    {
+        channelLane[frame] += sourceLane[frame] * (gain + gainDelta * gainRamp[frame]);
+    }
+}
+
+#ifdef AUDIO_MIXER_AVX2
+__attribute__((target("avx2"))) void mixLaneAvx2(const float* sourceLane, const float* gainRamp, float gain,
+                                                 float gainDelta, std::size_t frameCount, float* channelLane)
+{
+    __m256 gains = _mm256_set1_ps(gain);
+    __m256 gainDeltas = _mm256_set1_ps(gainDelta);
+
+    std::size_t frame = 0;
+    for (; frame + 8 <= frameCount; frame += 8)
+    {
+        __m256 frameGains = _mm256_add_ps(gains, _mm256_mul_ps(gainDeltas, _mm256_loadu_ps(gainRamp + frame)));
+        __m256 mixed = _mm256_add_ps(_mm256_loadu_ps(channelLane + frame),
+                                     _mm256_mul_ps(_mm256_loadu_ps(sourceLane + frame), frameGains));
+        _mm256_storeu_ps(channelLane + frame, mixed);
+    }
+
+    mixLaneScalar(sourceLane + frame, gainRamp + frame, gain, gainDelta, frameCount - frame, channelLane + frame);
+}
+#endif
+
+#ifdef AUDIO_MIXER_NEON
+void mixLaneNeon(const float* sourceLane, const float* gainRamp, float gain, float gainDelta, std::size_t frameCount,
+                 float* channelLane)
+{
+    float32x4_t gains = vdupq_n_f32(gain);
+    float32x4_t gainDeltas = vdupq_n_f32(gainDelta);
+
+    std::size_t frame = 0;
+    for (; frame + 4 <= frameCount; frame += 4)
+    {
+        float32x4_t frameGains = vmlaq_f32(gains, gainDeltas, vld1q_f32(gainRamp + frame));
+        vst1q_f32(channelLane + frame,
+                  vmlaq_f32(vld1q_f32(channelLane + frame), vld1q_f32(sourceLane + frame), frameGains));
+    }
+
+    mixLaneScalar(sourceLane + frame, gainRamp + frame, gain, gainDelta, frameCount - frame, channelLane + frame);
+}
+#endif
+
+MixFunction getMixFunction()
+{
+#ifdef AUDIO_MIXER_AVX2
+    // Not every x86 target has AVX2, the kernel is chosen at run time
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return mixLaneAvx2;
+    }
+#endif
+#ifdef AUDIO_MIXER_NEON
+    return mixLaneNeon;
+#else
+    return mixLaneScalar;
+#endif
+}
+}    // namespace
+
+namespace Model
+{
+/**
+ * @param [IN] inputSampleRate - rate of the separated sources.
+ * @param [IN] outputFormat - native format of the sink, of any channel count.
+ * @param [IN] outputChunkCount - number of mixed chunks that can be held by the consumers at the same time.
+ * @param [IN] memoryAccounting - where the output ring is accounted.
+ */
+AudioMixer::AudioMixer(int inputSampleRate, const AudioFormat& outputFormat, int outputChunkCount,
+                       std::shared_ptr<MemoryAccounting> memoryAccounting)
+    : outputFormat_(outputFormat)
+    , outputChannels_(outputFormat.channels)
+    , pannedChannels_(std::min(outputFormat.channels, 2))
+    , outputChunkCount_(outputChunkCount)
+    , memoryAccounting_(memoryAccounting)
+{
+    if (outputChannels_ < 1)
+    {
+        throw std::invalid_argument("Error in AudioMixer - the output must have at least one channel");
+    }
+
+    if (!memoryAccounting_)
+    {
+        throw std::invalid_argument("Error in AudioMixer - Null is not a valid memory accounting");
+    }
+
+    if (inputSampleRate != outputFormat_.sampleRate)
+    {
+        resampler_ = std::make_unique<audio::PolyphaseResampler>(inputSampleRate, outputFormat_.sampleRate,
+                                                                 outputChannels_);
+    }
+}
+
+/**
+ * @brief Sum the sources in the output layout.
+ * @param [IN] audioChunk - separated sources, one per channel.
+ * @param [IN] sourcePositions - position of the sources, in the same order as the channels.
+ * @param [IN] sourcesToMix - channels to mix, the others are silent.
+ * @param [OUT] outAudioChunk - mixed chunk with the same timestamp, in the output format.
+ * @return false if every output buffer is still held by a consumer.
+ */
+bool AudioMixer::mix(const AudioChunk& audioChunk, const SourcePositions& sourcePositions,
+                     const std::vector<int>& sourcesToMix, AudioChunk& outAudioChunk)
+{
+    int inputChannels = audioChunk.channels;
+    int frameCount = static_cast<int>(audioChunk.size) / (inputChannels * audioChunk.bytesPerChannel);
+
+    // The resampler output varies by a frame from chunk to chunk when the rates are not multiples
+    std::size_t maxOutputFrameCount =
+        resampler_ ? resampler_->getMaxOutputFrameCount(frameCount) : static_cast<std::size_t>(frameCount);
+    std::size_t slotSize = maxOutputFrameCount * outputFormat_.getFrameBytes();
+
+    if (!outputRing_ || outputRing_->getSlotSize() != slotSize)
+    {
+        // Chunks still held keep the previous ring alive
+        outputRing_ =
+            std::make_unique<AudioRingBuffer>(outputChunkCount_, slotSize, memoryAccounting_, OUTPUT_RING_SUBSYSTEM);
+    }
+
+    updateSourceGains(inputChannels, sourcePositions);
+
+    inputSamples_.resize(static_cast<std::size_t>(frameCount) * inputChannels);
+    audio::convertToFloat(audioChunk.audioData.get(), audioChunk.bytesPerChannel, inputSamples_.size(),
+                          inputSamples_.data());
+
+    std::size_t laneSize = static_cast<std::size_t>(frameCount);
+    updateGainRamp(frameCount);
+    sourceLane_.resize(laneSize);
+    mixLanes_.assign(laneSize * pannedChannels_, 0.f);
+    for (int source : sourcesToMix)
+    {
+        if (source >= 0 && source < inputChannels)
+        {
+            mixSource(source, inputChannels, frameCount);
+        }
+    }
+
+    // Channels past the front left and right are silent for every source
+    outputSamples_.assign(laneSize * outputChannels_, 0.f);
+    for (int channel = 0; channel < pannedChannels_; ++channel)
+    {
+        const float* mixLane = mixLanes_.data() + channel * laneSize;
+        for (std::size_t frame = 0; frame < laneSize; ++frame)
+        {
+            outputSamples_[frame * outputChannels_ + channel] = mixLane[frame];
+        }
+    }
+
+    const float* outputSamples = outputSamples_.data();
+    std::size_t outputFrameCount = static_cast<std::size_t>(frameCount);
+    if (resampler_)
+    {
+        resampledSamples_.resize(maxOutputFrameCount * outputChannels_);
+        outputFrameCount = resampler_->process(outputSamples_.data(), outputFrameCount, resampledSamples_.data());
+        outputSamples = resampledSamples_.data();
+    }
+
+    AudioChunk mixedChunk(static_cast<int>(outputFrameCount), outputChannels_, outputFormat_.getBytesPerSample());
+    mixedChunk.timestamp = audioChunk.timestamp;
+
+    uint8_t* outputData = outputRing_->beginWrite();
+    audio::convertFromFloat(outputSamples, outputFrameCount * outputChannels_, outputFormat_.sampleFormat,
+                            outputData);
+    mixedChunk.audioData = outputRing_->commitWrite();
+
+    if (mixedChunk.audioData == nullptr)
+    {
+        return false;
+    }
+
+    outAudioChunk = mixedChunk;
+    return true;
+}
+
+void AudioMixer::updateSourceGains(int sourceCount, const SourcePositions& sourcePositions)
+{
+    std::size_t gainCount = static_cast<std::size_t>(sourceCount) * outputChannels_;
+    bool isFirstChunk = sourceGains_.size() != gainCount;
+
+    previousSourceGains_ = sourceGains_;
+    sourceGains_.resize(gainCount);
+
+    for (int source = 0; source < sourceCount; ++source)
+    {
+        float* gains = sourceGains_.data() + source * outputChannels_;
+        std::fill(gains, gains + outputChannels_, 0.f);
+        if (pannedChannels_ == 1)
+        {
+            gains[0] = 1.f;
+            continue;
+        }
+
+        // Pan on the lateral axis, a source in front or behind is centered. Without a position it stays centered
+        float pan = 0.5f;
+        if (static_cast<std::size_t>(source) < sourcePositions.size())
+        {
+            pan = (1.f - std::sin(sourcePositions[source].azimuth)) / 2.f;
+        }
+
+        gains[0] = std::cos(pan * math::PI / 2.f);
+        gains[1] = std::sin(pan * math::PI / 2.f);
+    }
+
+    if (isFirstChunk)
+    {
+        previousSourceGains_ = sourceGains_;
+    }
+}
+
+void AudioMixer::updateGainRamp(int frameCount)
+{
+    if (gainRamp_.size() == static_cast<std::size_t>(frameCount))
+    {
+        return;
+    }
+
+    gainRamp_.resize(frameCount);
+    for (int frame = 0; frame < frameCount; ++frame)
+    {
+        gainRamp_[frame] = static_cast<float>(frame) / frameCount;
+    }
+}
+
+void AudioMixer::mixSource(int source, int inputChannels, int frameCount)
+{
+    static const MixFunction mixLane = getMixFunction();
+
+    const float* input = inputSamples_.data() + source;
+    const float* gains = sourceGains_.data() + source * outputChannels_;
+    const float* previousGains = previousSourceGains_.data() + source * outputChannels_;
+    std::size_t laneSize = static_cast<std::size_t>(frameCount);
+
+    // The source is deinterleaved once for every channel it is mixed in
+    for (std::size_t frame = 0; frame < laneSize; ++frame)
+    {
+        sourceLane_[frame] = input[frame * inputChannels];
+    }
+
+    for (int channel = 0; channel < pannedChannels_; ++channel)
+    {
+        mixLane(sourceLane_.data(), gainRamp_.data(), previousGains[channel], gains[channel] - previousGains[channel],
+                laneSize, mixLanes_.data() + channel * laneSize);
+    }
+}
+
+}    // namespace Model
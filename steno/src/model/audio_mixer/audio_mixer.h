@@ -0,0 +1,62 @@
+#ifndef AUDIO_MIXER_H
+#define AUDIO_MIXER_H
+
+#include <memory>
+#include <vector>
+
+#include "model/stream/audio/audio_chunk.h"
+#include "model/stream/audio/audio_format.h"
+#include "model/stream/audio/audio_ring_buffer.h"
+#include "model/stream/audio/source_positions.h"
+#include "model/stream/utils/alloc/memory_accounting.h"
+#include "model/stream/utils/audio/polyphase_resampler.h"
+
+namespace Model
+{
+/**
+ * @brief Mixes the separated audio sources in the channels of the output. With two channels or more each source is
+ * panned with a constant power law from its azimuth on the front left and right channels, the others are silent. The
+ * gains are interpolated over a chunk when a source moves. The mix is resampled and converted once to the native
+ * format of the sink, which plays it as is.
+ */
+class AudioMixer
+{
+   public:
+    AudioMixer(int inputSampleRate, const AudioFormat& outputFormat, int outputChunkCount,
+               std::shared_ptr<MemoryAccounting> memoryAccounting);
+
+    bool mix(const AudioChunk& audioChunk, const SourcePositions& sourcePositions,
+             const std::vector<int>& sourcesToMix, AudioChunk& outAudioChunk);
+
+   private:
+    void updateSourceGains(int sourceCount, const SourcePositions& sourcePositions);
+    void updateGainRamp(int frameCount);
+    void mixSource(int source, int inputChannels, int frameCount);
+
+    AudioFormat outputFormat_;
+    int outputChannels_;
+    int pannedChannels_;
+    int outputChunkCount_;
+    std::shared_ptr<MemoryAccounting> memoryAccounting_;
+    std::unique_ptr<AudioRingBuffer> outputRing_;
+    std::unique_ptr<audio::PolyphaseResampler> resampler_;
+
+    // Gains of each source for each output channel, [source * outputChannels + outputChannel]
+    std::vector<float> sourceGains_;
+    std::vector<float> previousSourceGains_;
+
+    std::vector<float> inputSamples_;
+    std::vector<float> outputSamples_;
+
+    // The sources are mixed in contiguous lanes of a chunk, one per panned channel, and interleaved once mixed
+    std::vector<float> sourceLane_;
+    std::vector<float> mixLanes_;
+
+    // Position of each frame in the chunk from 0 to 1, the gains are interpolated along it
+    std::vector<float> gainRamp_;
+    std::vector<float> resampledSamples_;
+};
+
+}    // namespace Model
+
+#endif    //! AUDIO_MIXER_H
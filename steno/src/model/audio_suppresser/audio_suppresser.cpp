@@ -1,38 +1,551 @@
 #include "audio_suppresser.h"
 
-#include <cstring>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define AUDIO_SUPPRESSER_AVX2
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define AUDIO_SUPPRESSER_NEON
+#endif
 
 namespace Model
 {
+namespace
+{
+// Largest vector width of the kernels, the mask holds one frame plus this many bytes
+const std::size_t MASK_WINDOW_BYTES = 32;
+
+using MaskFunction = void (*)(uint8_t* data, std::size_t size, const uint8_t* mask, std::size_t frameBytes);
+
+/**
+ * @brief AND the data with a repeating mask, one frame long. The mask is read through windows starting at the
+ * position of the data in its frame, which removes the per byte channel computation.
+ */
+template <std::size_t WindowBytes>
+void applyMaskScalar(uint8_t* data, std::size_t size, const uint8_t* mask, std::size_t frameBytes)
+{
+    std::size_t i = 0;
+    std::size_t maskOffset = 0;
+    for (; i + WindowBytes <= size; i += WindowBytes)
+    {
+        for (std::size_t j = 0; j < WindowBytes; ++j)
+        {
+            data[i + j] &= mask[maskOffset + j];
+        }
+        maskOffset = (maskOffset + WindowBytes) % frameBytes;
+    }
+
+    for (std::size_t j = 0; i + j < size; ++j)
+    {
+        data[i + j] &= mask[maskOffset + j];
+    }
+}
+
+#ifdef AUDIO_SUPPRESSER_AVX2
+__attribute__((target("avx2"))) void applyMaskAvx2(uint8_t* data, std::size_t size, const uint8_t* mask,
+                                                   std::size_t frameBytes)
+{
+    std::size_t i = 0;
+    std::size_t maskOffset = 0;
+    for (; i + 32 <= size; i += 32)
+    {
+        __m256i samples = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i window = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(mask + maskOffset));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i), _mm256_and_si256(samples, window));
+        maskOffset = (maskOffset + 32) % frameBytes;
+    }
+
+    for (std::size_t j = 0; i + j < size; ++j)
+    {
+        data[i + j] &= mask[maskOffset + j];
+    }
+}
+#endif
+
+#ifdef AUDIO_SUPPRESSER_NEON
+void applyMaskNeon(uint8_t* data, std::size_t size, const uint8_t* mask, std::size_t frameBytes)
+{
+    std::size_t i = 0;
+    std::size_t maskOffset = 0;
+    for (; i + 16 <= size; i += 16)
+    {
+        uint8x16_t samples = vld1q_u8(data + i);
+        uint8x16_t window = vld1q_u8(mask + maskOffset);
+        vst1q_u8(data + i, vandq_u8(samples, window));
+        maskOffset = (maskOffset + 16) % frameBytes;
+    }
+
+    for (std::size_t j = 0; i + j < size; ++j)
+    {
+        data[i + j] &= mask[maskOffset + j];
+    }
+}
+#endif
+
+// Largest vector width of the ramp kernels in samples, the ramp table period is a multiple of it
+const std::size_t RAMP_WINDOW_SAMPLES = 8;
+
+template <typename T>
+using RampFunction = void (*)(T* samples, std::size_t count, const float* table, std::size_t period);
+
+/**
+ * @brief Apply the ramping gains from a sample to the end, the gain of a sample is the entry of its position in the
+ * period plus the increment per period times the period index, clamped to the bounds of the ramp.
+ */
+template <typename T>
+void applyRampRange(T* samples, std::size_t begin, std::size_t count, const float* table, std::size_t period)
+{
+    const float* bases = table;
+    const float* slopes = table + period;
+    const float* lows = table + 2 * period;
+    const float* highs = table + 3 * period;
+
+    std::size_t position = begin % period;
+    float periodIndex = static_cast<float>(begin / period);
+    for (std::size_t i = begin; i < count; ++i)
+    {
+        float gain = std::min(std::max(bases[position] + slopes[position] * periodIndex, lows[position]),
+                              highs[position]);
+        samples[i] = static_cast<T>(samples[i] * static_cast<double>(gain));
+
+        if (++position == period)
+        {
+            position = 0;
+            periodIndex += 1.f;
+        }
+    }
+}
+
+template <typename T>
+void applyRampScalar(T* samples, std::size_t count, const float* table, std::size_t period)
+{
+    applyRampRange(samples, 0, count, table, period);
+}
+
+#ifdef AUDIO_SUPPRESSER_AVX2
+__attribute__((target("avx2"))) void applyRampAvx2(int16_t* samples, std::size_t count, const float* table,
+                                                   std::size_t period)
+{
+    std::size_t i = 0;
+    std::size_t position = 0;
+    float periodIndex = 0.f;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 gains = _mm256_add_ps(_mm256_loadu_ps(table + position),
+                                     _mm256_mul_ps(_mm256_loadu_ps(table + period + position),
+                                                   _mm256_set1_ps(periodIndex)));
+        gains = _mm256_min_ps(_mm256_max_ps(gains, _mm256_loadu_ps(table + 2 * period + position)),
+                              _mm256_loadu_ps(table + 3 * period + position));
+
+        __m256i values = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i)));
+        values = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(values), gains));
+        __m128i packed = _mm_packs_epi32(_mm256_castsi256_si128(values), _mm256_extracti128_si256(values, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(samples + i), packed);
+
+        position += 8;
+        if (position == period)
+        {
+            position = 0;
+            periodIndex += 1.f;
+        }
+    }
+
+    applyRampRange(samples, i, count, table, period);
+}
+
+/**
+ * @brief 32 bits samples are scaled in double precision like the scalar kernel, a float can't hold them exactly.
+ */
+__attribute__((target("avx2"))) void applyRampAvx2(int32_t* samples, std::size_t count, const float* table,
+                                                   std::size_t period)
+{
+    std::size_t i = 0;
+    std::size_t position = 0;
+    float periodIndex = 0.f;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 gains = _mm_add_ps(_mm_loadu_ps(table + position),
+                                  _mm_mul_ps(_mm_loadu_ps(table + period + position), _mm_set1_ps(periodIndex)));
+        gains = _mm_min_ps(_mm_max_ps(gains, _mm_loadu_ps(table + 2 * period + position)),
+                           _mm_loadu_ps(table + 3 * period + position));
+
+        __m256d values = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i)));
+        __m128i scaled = _mm256_cvttpd_epi32(_mm256_mul_pd(values, _mm256_cvtps_pd(gains)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(samples + i), scaled);
+
+        position += 4;
+        if (position == period)
+        {
+            position = 0;
+            periodIndex += 1.f;
+        }
+    }
+
+    applyRampRange(samples, i, count, table, period);
+}
+#endif
+
+#ifdef AUDIO_SUPPRESSER_NEON
+void applyRampNeon(int16_t* samples, std::size_t count, const float* table, std::size_t period)
+{
+    std::size_t i = 0;
+    std::size_t position = 0;
+    float periodIndex = 0.f;
+    for (; i + 4 <= count; i += 4)
+    {
+        float32x4_t gains = vmlaq_n_f32(vld1q_f32(table + position), vld1q_f32(table + period + position), periodIndex);
+        gains = vminq_f32(vmaxq_f32(gains, vld1q_f32(table + 2 * period + position)),
+                          vld1q_f32(table + 3 * period + position));
+
+        float32x4_t values = vcvtq_f32_s32(vmovl_s16(vld1_s16(samples + i)));
+        vst1_s16(samples + i, vmovn_s32(vcvtq_s32_f32(vmulq_f32(values, gains))));
+
+        position += 4;
+        if (position == period)
+        {
+            position = 0;
+            periodIndex += 1.f;
+        }
+    }
+
+    applyRampRange(samples, i, count, table, period);
+}
+
+#ifdef __aarch64__
+/**
+ * @brief 32 bits samples are scaled in double precision like the scalar kernel, a float can't hold them exactly.
+ */
+void applyRampNeon(int32_t* samples, std::size_t count, const float* table, std::size_t period)
+{
+    std::size_t i = 0;
+    std::size_t position = 0;
+    float periodIndex = 0.f;
+    for (; i + 2 <= count; i += 2)
+    {
+        float32x2_t gains = vmla_n_f32(vld1_f32(table + position), vld1_f32(table + period + position), periodIndex);
+        gains = vmin_f32(vmax_f32(gains, vld1_f32(table + 2 * period + position)),
+                         vld1_f32(table + 3 * period + position));
+
+        float64x2_t values = vcvtq_f64_s64(vmovl_s32(vld1_s32(samples + i)));
+        vst1_s32(samples + i, vmovn_s64(vcvtq_s64_f64(vmulq_f64(values, vcvt_f64_f32(gains)))));
+
+        position += 2;
+        if (position == period)
+        {
+            position = 0;
+            periodIndex += 1.f;
+        }
+    }
+
+    applyRampRange(samples, i, count, table, period);
+}
+#endif
+#endif
+
+template <typename T>
+RampFunction<T> getRampFunction()
+{
+    return applyRampScalar<T>;
+}
+
+template <>
+RampFunction<int16_t> getRampFunction<int16_t>()
+{
+#ifdef AUDIO_SUPPRESSER_AVX2
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return applyRampAvx2;
+    }
+#endif
+#ifdef AUDIO_SUPPRESSER_NEON
+    return applyRampNeon;
+#else
+    return applyRampScalar<int16_t>;
+#endif
+}
+
+template <>
+RampFunction<int32_t> getRampFunction<int32_t>()
+{
+#ifdef AUDIO_SUPPRESSER_AVX2
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return applyRampAvx2;
+    }
+#endif
+#if defined(AUDIO_SUPPRESSER_NEON) && defined(__aarch64__)
+    return applyRampNeon;
+#else
+    return applyRampScalar<int32_t>;
+#endif
+}
+
+MaskFunction getMaskFunction()
+{
+#ifdef AUDIO_SUPPRESSER_AVX2
+    // Not every x86 target has AVX2, the kernel is chosen at run time
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return applyMaskAvx2;
+    }
+#endif
+#ifdef AUDIO_SUPPRESSER_NEON
+    return applyMaskNeon;
+#else
+    return applyMaskScalar<MASK_WINDOW_BYTES>;
+#endif
+}
+
+}    // namespace
+
+/**
+ * @param [IN] sampleRate - sample rate of the audio chunks.
+ * @param [IN] rampDurationMs - time for a source gain to go from kept to suppressed, or the opposite.
+ */
+AudioSuppresser::AudioSuppresser(int sampleRate, int rampDurationMs)
+    : rampFrameCount_(std::max(1, sampleRate * rampDurationMs / 1000))
+    , rampStep_(1.f / rampFrameCount_)
+    , rampingChannelCount_(0)
+    , rampPeriod_(0)
+    , maskBytesPerChannel_(0)
+    , isMaskValid_(false)
+{
+    if (sampleRate <= 0 || rampDurationMs < 0)
+    {
+        throw std::invalid_argument("AudioSuppresser error : sample rate and ramp duration must be positive");
+    }
+}
+
 /**
  * @brief Removes all audio sources that are not in the vector sourcesToKeep
  * @param [IN] sourcesToKeep - vector of audio sources to keep.
  * @param [IN/OUT] audioChunk - Audio chunk to modify
  */
-void AudioSuppresser::suppressNoise(const std::vector<int> &sourcesToKeep, AudioChunk& audioChunk)
+void AudioSuppresser::suppressNoise(const ArenaVector<int>& sourcesToKeep, AudioChunk& audioChunk)
 {
-    // Initialize mask to zeros
-    uint8_t mask[audioChunk.channels] = {};
+    if (static_cast<int>(gains_.size()) != audioChunk.channels)
+    {
+        resetChannels(audioChunk.channels);
+    }
 
-    // Build mask
+    std::fill(targetGains_.begin(), targetGains_.end(), 0.f);
     for (int channel : sourcesToKeep)
     {
-        if (channel >= audioChunk.channels)
+        if (channel < 0 || channel >= audioChunk.channels)
         {
             throw std::runtime_error("AudioSuppresser error : channel index is invalid!");
         }
-        
-        mask[channel] = 0xFF;
+
+        targetGains_[channel] = 1.f;
+    }
+
+    process(audioChunk);
+}
+
+/**
+ * @brief Ramps every suppressed source back in, used when there is nothing to classify the sources against.
+ */
+void AudioSuppresser::keepAllSources(AudioChunk& audioChunk)
+{
+    if (static_cast<int>(gains_.size()) != audioChunk.channels)
+    {
+        resetChannels(audioChunk.channels);
+    }
+
+    std::fill(targetGains_.begin(), targetGains_.end(), 1.f);
+    process(audioChunk);
+}
+
+/**
+ * @brief Sources not completely suppressed in the last processed chunk, the others are silent.
+ */
+void AudioSuppresser::getAudibleSources(std::vector<int>& outSources) const
+{
+    outSources = audibleSources_;
+}
+
+void AudioSuppresser::resetChannels(int channels)
+{
+    // A new stream starts with every source kept, like when no source was suppressed yet
+    gains_.assign(channels, 1.f);
+    targetGains_.assign(channels, 1.f);
+    rampingChannelCount_ = 0;
+    isMaskValid_ = false;
+}
+
+void AudioSuppresser::process(AudioChunk& audioChunk)
+{
+    rampingChannelCount_ = 0;
+    audibleSources_.clear();
+    for (std::size_t i = 0; i < gains_.size(); ++i)
+    {
+        if (gains_[i] != targetGains_[i])
+        {
+            ++rampingChannelCount_;
+        }
+
+        if (gains_[i] > 0.f || targetGains_[i] > 0.f)
+        {
+            audibleSources_.push_back(static_cast<int>(i));
+        }
+    }
+
+    int frameBytes = audioChunk.channels * audioChunk.bytesPerChannel;
+    if (frameBytes <= 0)
+    {
+        return;
     }
 
     uint8_t* data = audioChunk.audioData.get();
+    int frameCount = static_cast<int>(audioChunk.size) / frameBytes;
+    int rampedFrameCount = 0;
+
+    if (rampingChannelCount_ > 0)
+    {
+        isMaskValid_ = false;
+
+        switch (audioChunk.bytesPerChannel)
+        {
+            case 2:
+                rampedFrameCount = applyRamps(reinterpret_cast<int16_t*>(data), frameCount);
+                break;
+            case 4:
+                rampedFrameCount = applyRamps(reinterpret_cast<int32_t*>(data), frameCount);
+                break;
+            default:
+                // No ramp for other sample sizes, the gains switch at once
+                gains_ = targetGains_;
+                rampingChannelCount_ = 0;
+                break;
+        }
 
-    // Supress sources that we don't want to keep
-    for (int i = 0; i < static_cast<int>(audioChunk.size); i++)
+        if (rampingChannelCount_ > 0)
+        {
+            return;
+        }
+    }
+
+    // Steady state, every gain is 0 or 1 and can be applied as a byte mask whatever the sample size
+    bool isEverySourceKept = std::all_of(gains_.begin(), gains_.end(), [](float gain) { return gain == 1.f; });
+    if (isEverySourceKept)
+    {
+        return;
+    }
+
+    if (!isMaskValid_ || maskBytesPerChannel_ != audioChunk.bytesPerChannel)
+    {
+        updateMask(audioChunk.bytesPerChannel);
+    }
+
+    static const MaskFunction applyMask = getMaskFunction();
+    std::size_t offset = static_cast<std::size_t>(rampedFrameCount) * frameBytes;
+    applyMask(data + offset, audioChunk.size - offset, mask_.data(), frameBytes);
+}
+
+/**
+ * @brief Apply the ramping gains until every ramp is done or the chunk is over.
+ * @return number of frames processed.
+ */
+template <typename T>
+int AudioSuppresser::applyRamps(T* samples, int frameCount)
+{
+    static const RampFunction<T> applyRamp = getRampFunction<T>();
+
+    int rampedFrameCount = updateRampTable(frameCount);
+    applyRamp(samples, static_cast<std::size_t>(rampedFrameCount) * gains_.size(), rampTable_.data(), rampPeriod_);
+    updateRampGains(rampedFrameCount);
+
+    return rampedFrameCount;
+}
+
+/**
+ * @brief Fill the ramp table from the current gains, a gain moves by the ramp step each frame toward its target.
+ * @return number of frames until every ramp is done, at most the frame count.
+ */
+int AudioSuppresser::updateRampTable(int frameCount)
+{
+    std::size_t channels = gains_.size();
+
+    rampPeriod_ = channels;
+    while (rampPeriod_ % RAMP_WINDOW_SAMPLES != 0)
+    {
+        rampPeriod_ += channels;
+    }
+    float periodFrameCount = static_cast<float>(rampPeriod_ / channels);
+
+    rampTable_.resize(4 * rampPeriod_);
+    float* bases = rampTable_.data();
+    float* slopes = bases + rampPeriod_;
+    float* lows = bases + 2 * rampPeriod_;
+    float* highs = bases + 3 * rampPeriod_;
+
+    int rampedFrameCount = 0;
+    for (std::size_t i = 0; i < rampPeriod_; ++i)
+    {
+        std::size_t channel = i % channels;
+        float gain = gains_[channel];
+        float target = targetGains_[channel];
+        float step = target > gain ? rampStep_ : (target < gain ? -rampStep_ : 0.f);
+
+        bases[i] = gain + step * static_cast<float>(i / channels);
+        slopes[i] = step * periodFrameCount;
+        lows[i] = std::min(gain, target);
+        highs[i] = std::max(gain, target);
+
+        if (i < channels && step != 0.f)
+        {
+            rampedFrameCount = std::max(rampedFrameCount, static_cast<int>(std::ceil((target - gain) / step)));
+        }
+    }
+
+    return std::min(rampedFrameCount, frameCount);
+}
+
+/**
+ * @brief Move the gains to where the ramps are after a number of frames.
+ */
+void AudioSuppresser::updateRampGains(int rampedFrameCount)
+{
+    rampingChannelCount_ = 0;
+    for (std::size_t channel = 0; channel < gains_.size(); ++channel)
     {
-        int channel = (i / audioChunk.bytesPerChannel) % audioChunk.channels;
-        data[i] &= mask[channel];
+        float gain = gains_[channel];
+        float target = targetGains_[channel];
+        float rampDelta = rampStep_ * static_cast<float>(rampedFrameCount);
+        gain = target > gain ? std::min(target, gain + rampDelta) : std::max(target, gain - rampDelta);
+
+        // The ramp can end a rounding error away from its target
+        if (gain != target && std::abs(target - gain) < rampStep_ * 0.5f)
+        {
+            gain = target;
+        }
+
+        gains_[channel] = gain;
+        if (gain != target)
+        {
+            ++rampingChannelCount_;
+        }
     }
 }
 
+void AudioSuppresser::updateMask(int bytesPerChannel)
+{
+    std::size_t channels = gains_.size();
+    std::size_t frameBytes = channels * bytesPerChannel;
+
+    mask_.resize(frameBytes + MASK_WINDOW_BYTES);
+    for (std::size_t i = 0; i < mask_.size(); ++i)
+    {
+        std::size_t channel = (i % frameBytes) / bytesPerChannel;
+        mask_[i] = gains_[channel] == 1.f ? 0xFF : 0x00;
+    }
+
+    maskBytesPerChannel_ = bytesPerChannel;
+    isMaskValid_ = true;
+}
+
 }    // namespace Model
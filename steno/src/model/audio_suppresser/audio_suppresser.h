@@ -5,13 +5,49 @@
 #include <vector>
 
 #include "model/stream/audio/audio_chunk.h"
+#include "model/stream/utils/alloc/monotonic_arena.h"
 
 namespace Model
 {
+/**
+ * @brief Applies a gain per audio source (channel). Gains ramp linearly between kept and suppressed so speaker
+ * switches don't click, the state of the ramps is kept between chunks.
+ */
 class AudioSuppresser
 {
    public:
-    static void suppressNoise(const std::vector<int> &indexToKeep, AudioChunk& audioChunk);
+    AudioSuppresser(int sampleRate, int rampDurationMs);
+
+    void suppressNoise(const ArenaVector<int>& sourcesToKeep, AudioChunk& audioChunk);
+    void keepAllSources(AudioChunk& audioChunk);
+    void getAudibleSources(std::vector<int>& outSources) const;
+
+   private:
+    void resetChannels(int channels);
+    void process(AudioChunk& audioChunk);
+    template <typename T>
+    int applyRamps(T* samples, int frameCount);
+    int updateRampTable(int frameCount);
+    void updateRampGains(int rampedFrameCount);
+    void updateMask(int bytesPerChannel);
+
+    int rampFrameCount_;
+    float rampStep_;
+
+    std::vector<float> gains_;
+    std::vector<float> targetGains_;
+    std::vector<int> audibleSources_;
+    int rampingChannelCount_;
+
+    // Gain of each sample of a ramp as a function of its period, the rows are the gains of the first period, their
+    // increment per period, and the lower and upper bounds. A period spans whole frames and vector windows
+    std::vector<float> rampTable_;
+    std::size_t rampPeriod_;
+
+    // Byte mask of the steady state gains, repeated so any 32 bytes window starting on a frame boundary is valid
+    std::vector<uint8_t> mask_;
+    int maskBytesPerChannel_;
+    bool isMaskValid_;
 };
 
 }    // namespace Model
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cmath>
 
 #include "classifier.h"
@@ -10,28 +11,26 @@ namespace Model
  * @param audioPositions - audio positions from odas localization.
  * @param imagePositions - image positions to compare with audio positions.
  * @param rangeThreshold - distance threshold
- * @return vector of index of the sources we want to keep in the audio.
+ * @param outSourcesToKeep - index of the sources we want to keep in the audio, in increasing order.
  */
-std::vector<int> Classifier::getSourcesToKeep(const std::vector<SourcePosition> &audioPositions,
-                                              const std::vector<SphericalAngleRect> &imagePositions,
-                                              const float &rangeThreshold)
+void Classifier::getSourcesToKeep(const SourcePositions &audioPositions,
+                                  const ArenaVector<SphericalAngleRect> &imagePositions, const float &rangeThreshold,
+                                  ArenaVector<int> &outSourcesToKeep)
 {
-    std::vector<int> sourcesToKeep;
-    std::vector<std::pair<int, int>> audioImagePairs =
-        getAudioImagePairs(audioPositions, imagePositions, rangeThreshold);
+    outSourcesToKeep.clear();
 
-    for (size_t i = 0; i < audioImagePairs.size(); i++)
+    for (size_t i = 0; i < audioPositions.size(); i++)
     {
-        std::pair<int, int> pair = audioImagePairs[i];
+        // A source is kept once, whatever the number of images at its position
+        auto isPaired = [&](const SphericalAngleRect &imagePosition) {
+            return isAudioImagePair(audioPositions[i], imagePosition, rangeThreshold);
+        };
 
-        // Check if the index to keep is not already in the vector
-        if (std::find(sourcesToKeep.begin(), sourcesToKeep.end(), pair.first) == sourcesToKeep.end())
+        if (std::any_of(imagePositions.begin(), imagePositions.end(), isPaired))
         {
-            sourcesToKeep.push_back(pair.first);
+            outSourcesToKeep.push_back(i);
         }
     }
-
-    return sourcesToKeep;
 }
 
 /**
@@ -39,30 +38,34 @@ std::vector<int> Classifier::getSourcesToKeep(const std::vector<SourcePosition>
  * @param audioPositions - audio positions from odas localization.
  * @param imagePositions - image positions to compare with audio positions.
  * @param rangeThreshold - distance threshold
- * @return vector of pairs of index that represents the audio sources and images that are at the same spatial position
+ * @param outAudioImagePairs - pairs of index that represents the audio sources and images that are at the same
+ * spatial position
  */
-std::vector<std::pair<int, int>> Classifier::getAudioImagePairs(const std::vector<SourcePosition> &audioPositions,
-                                                                const std::vector<SphericalAngleRect> &imagePositions,
-                                                                const float &rangeThreshold)
+void Classifier::getAudioImagePairs(const SourcePositions &audioPositions,
+                                    const ArenaVector<SphericalAngleRect> &imagePositions, const float &rangeThreshold,
+                                    ArenaVector<std::pair<int, int>> &outAudioImagePairs)
 {
-    std::pair<int, int> audioImagePair;
-    std::vector<std::pair<int, int>> audioImagePairs;
+    outAudioImagePairs.clear();
 
     for (size_t i = 0; i < audioPositions.size(); i++)
     {
         for (size_t j = 0; j < imagePositions.size(); j++)
         {
-            // Set the azimuth counter-clockwise to match the audio
-            float imagePositionAzimuth = math::getAngleAroundCircle(2.0 * M_PI - imagePositions[j].azimuth - M_PI / 2.f);
-
-            if (std::abs(audioPositions[i].azimuth - imagePositionAzimuth) < rangeThreshold)
+            if (isAudioImagePair(audioPositions[i], imagePositions[j], rangeThreshold))
             {
-                audioImagePairs.push_back(std::make_pair(i, j));
+                outAudioImagePairs.push_back(std::make_pair(i, j));
             }
         }
     }
+}
+
+bool Classifier::isAudioImagePair(const SourcePosition &audioPosition, const SphericalAngleRect &imagePosition,
+                                  const float &rangeThreshold)
+{
+    // Set the azimuth counter-clockwise to match the audio
+    float imagePositionAzimuth = math::getAngleAroundCircle(2.0 * M_PI - imagePosition.azimuth - M_PI / 2.f);
 
-    return audioImagePairs;
+    return std::abs(audioPosition.azimuth - imagePositionAzimuth) < rangeThreshold;
 }
 
 }    // namespace Model
@@ -1,9 +1,10 @@
 #ifndef CLASSIFIER_H
 #define CLASSIFIER_H
 
-#include <vector>
+#include <utility>
 
-#include "model/stream/audio/source_position.h"
+#include "model/stream/audio/source_positions.h"
+#include "model/stream/utils/alloc/monotonic_arena.h"
 #include "model/stream/utils/models/spherical_angle_rect.h"
 
 namespace Model
@@ -11,13 +12,17 @@ namespace Model
 class Classifier
 {
    public:
-    static std::vector<int> getSourcesToKeep(const std::vector<SourcePosition> &audioPositions,
-                                             const std::vector<SphericalAngleRect> &imagePositions,
-                                             const float &rangeThreshold);
+    static void getSourcesToKeep(const SourcePositions &audioPositions,
+                                 const ArenaVector<SphericalAngleRect> &imagePositions, const float &rangeThreshold,
+                                 ArenaVector<int> &outSourcesToKeep);
 
-    static std::vector<std::pair<int, int>> getAudioImagePairs(const std::vector<SourcePosition> &audioPositions,
-                                                               const std::vector<SphericalAngleRect> &imagePositions,
-                                                               const float &rangeThreshold);
+    static void getAudioImagePairs(const SourcePositions &audioPositions,
+                                   const ArenaVector<SphericalAngleRect> &imagePositions, const float &rangeThreshold,
+                                   ArenaVector<std::pair<int, int>> &outAudioImagePairs);
+
+   private:
+    static bool isAudioImagePair(const SourcePosition &audioPosition, const SphericalAngleRect &imagePosition,
+                                 const float &rangeThreshold);
 };
 
 }    // namespace Model
@@ -13,6 +13,7 @@
 #include <QCoreApplication>
 #include <QDir>
 #include <QFileInfo>
+#include <QStandardPaths>
 
 namespace Model
 {
@@ -107,6 +108,11 @@ void Config::loadDefault()
                           QCoreApplication::applicationDirPath() + "/../configs/odas/odas_16_mic.cfg");
     m_appConfig->setValue(AppConfig::Key::ODAS_LIBRARY,
                           QCoreApplication::applicationDirPath() + "/../../odas/bin/odaslive");
+    m_appConfig->setValue(AppConfig::Key::ODAS_TRANSPORT, ODAS_TRANSPORT_TCP);
+    m_appConfig->setValue(AppConfig::Key::ODAS_SOCKET_FOLDER,
+                          QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation));
+    m_appConfig->setValue(AppConfig::Key::CAMERA_CAPTURE_MEMORY, CAMERA_CAPTURE_MEMORY_USERPTR);
+    m_appConfig->setValue(AppConfig::Key::AUDIO_OUTPUT, AUDIO_OUTPUT_PULSEAUDIO);
 
     m_transcriptionConfig->setValue(TranscriptionConfig::Key::LANGUAGE, Transcription::Language::FR_CA);
     m_transcriptionConfig->setValue(TranscriptionConfig::Key::AUTOMATIC_TRANSCRIPTION, false);
@@ -128,6 +134,7 @@ void Config::loadDefault()
     m_videoInputConfig->setValue(VideoConfig::Key::HEIGHT, 2160);
     m_videoInputConfig->setValue(VideoConfig::Key::DEVICE_NAME, "/dev/video0");
     m_videoInputConfig->setValue(VideoConfig::Key::IMAGE_FORMAT, ImageFormat::UYVY_FMT);
+    m_videoInputConfig->setValue(VideoConfig::Key::MJPEG_CAPTURE, false);
 
     m_videoOutputConfig->setValue(VideoConfig::Key::FPS, 20);
     m_videoOutputConfig->setValue(VideoConfig::Key::WIDTH, 800);
@@ -144,17 +151,19 @@ void Config::loadDefault()
     m_audioInputConfig->setValue(AudioConfig::Key::PACKET_HEADER_SIZE, 8);
 
     m_audioOutputConfig->setValue(AudioConfig::Key::DEVICE_NAME, "webrtc_in");
-    m_audioOutputConfig->setValue(AudioConfig::Key::CHANNELS, 4);
-    m_audioOutputConfig->setValue(AudioConfig::Key::RATE, 16000);
+    m_audioOutputConfig->setValue(AudioConfig::Key::CHANNELS, 2);
+    m_audioOutputConfig->setValue(AudioConfig::Key::RATE, 48000);
     m_audioOutputConfig->setValue(AudioConfig::Key::FORMAT_BYTES, 2);
     m_audioOutputConfig->setValue(AudioConfig::Key::IS_LITTLE_ENDIAN, true);
     m_audioOutputConfig->setValue(AudioConfig::Key::PACKET_AUDIO_SIZE, 4096);
     m_audioOutputConfig->setValue(AudioConfig::Key::PACKET_HEADER_SIZE, 0);
+    m_audioOutputConfig->setValue(AudioConfig::Key::TARGET_LATENCY_MS, 60);
 
     m_streamConfig->setValue(StreamConfig::Key::ASPECT_RATIO_WIDTH, 3);
     m_streamConfig->setValue(StreamConfig::Key::ASPECT_RATIO_HEIGHT, 4);
     m_streamConfig->setValue(StreamConfig::Key::MIN_ELEVATION, 0);
     m_streamConfig->setValue(StreamConfig::Key::MAX_ELEVATION, 90);
+    m_streamConfig->setValue(StreamConfig::Key::LIP_SYNC_OFFSET_MS, 0);
 
     m_darknetConfig->setValue(DarknetConfig::Key::SLEEP_BETWEEN_LAYERS_FORWARD_US, 2000);
 
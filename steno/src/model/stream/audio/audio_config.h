@@ -19,7 +19,8 @@ class AudioConfig : public BaseConfig
         FORMAT_BYTES,
         IS_LITTLE_ENDIAN,
         PACKET_AUDIO_SIZE,
-        PACKET_HEADER_SIZE
+        PACKET_HEADER_SIZE,
+        TARGET_LATENCY_MS
     };
     Q_ENUM(Key)
 
@@ -38,6 +39,7 @@ class AudioConfig : public BaseConfig
         isLittleEndian = value(Key::IS_LITTLE_ENDIAN).toBool();
         packetAudioSize = value(Key::PACKET_AUDIO_SIZE).toInt();
         packetHeaderSize = value(Key::PACKET_HEADER_SIZE).toInt();
+        targetLatencyMs = value(Key::TARGET_LATENCY_MS).toInt();
     }
 
     std::string deviceName;
@@ -47,6 +49,7 @@ class AudioConfig : public BaseConfig
     bool isLittleEndian;
     int packetAudioSize;
     int packetHeaderSize;
+    int targetLatencyMs;    // Output only, from a write to the sink to the speakers
 };
 
 }    // namespace Model
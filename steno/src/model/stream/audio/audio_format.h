@@ -0,0 +1,80 @@
+#ifndef AUDIO_FORMAT_H
+#define AUDIO_FORMAT_H
+
+#include <stdexcept>
+
+#include "model/stream/audio/audio_config.h"
+
+namespace Model
+{
+/**
+ * @brief Native endian sample formats of the audio pipeline.
+ */
+enum class SampleFormat
+{
+    S16,
+    S32,
+    F32
+};
+
+/**
+ * @brief Interleaved audio layout, e.g. the one a sink wants to receive.
+ */
+struct AudioFormat
+{
+    AudioFormat()
+        : sampleFormat(SampleFormat::S16)
+        , channels(0)
+        , sampleRate(0)
+    {
+    }
+
+    AudioFormat(SampleFormat sampleFormat, int channels, int sampleRate)
+        : sampleFormat(sampleFormat)
+        , channels(channels)
+        , sampleRate(sampleRate)
+    {
+    }
+
+    /**
+     * @brief Integer PCM format of an audio config, only 16 and 32 bits samples are supported.
+     */
+    static AudioFormat fromConfig(const AudioConfig& audioConfig)
+    {
+        if (audioConfig.formatBytes != 2 && audioConfig.formatBytes != 4)
+        {
+            throw std::invalid_argument("Error in AudioFormat - only 16 and 32 bits samples are supported");
+        }
+
+        SampleFormat sampleFormat = audioConfig.formatBytes == 2 ? SampleFormat::S16 : SampleFormat::S32;
+        return AudioFormat(sampleFormat, audioConfig.channels, audioConfig.rate);
+    }
+
+    int getBytesPerSample() const
+    {
+        return sampleFormat == SampleFormat::S16 ? 2 : 4;
+    }
+
+    int getFrameBytes() const
+    {
+        return getBytesPerSample() * channels;
+    }
+
+    bool operator==(const AudioFormat& other) const
+    {
+        return sampleFormat == other.sampleFormat && channels == other.channels && sampleRate == other.sampleRate;
+    }
+
+    bool operator!=(const AudioFormat& other) const
+    {
+        return !(*this == other);
+    }
+
+    SampleFormat sampleFormat;
+    int channels;
+    int sampleRate;
+};
+
+}    // namespace Model
+
+#endif    //! AUDIO_FORMAT_H
@@ -0,0 +1,230 @@
+#include "audio_jitter_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace Model
+{
+namespace
+{
+// Larger timestamp jumps are a new stream (e.g. odaslive restarted), not missing chunks
+const int64_t MAX_GAP_US = 500000;
+
+}    // namespace
+
+/**
+ * @param [IN] sampleRate - frames per second.
+ * @param [IN] frameBytes - bytes of one frame, all channels included.
+ * @param [IN] maxDepthUs - oldest audio is dropped past this depth.
+ */
+AudioJitterBuffer::AudioJitterBuffer(int sampleRate, int frameBytes, int64_t maxDepthUs)
+    : sampleRate_(sampleRate)
+    , frameBytes_(static_cast<std::size_t>(frameBytes))
+    , maxDepthUs_(maxDepthUs)
+    , frontOffset_(0)
+    , bufferedBytes_(0)
+    , pendingSilenceBytes_(0)
+    , nextTimestamp_(0)
+    , isPlaying_(false)
+{
+    if (sampleRate <= 0 || frameBytes <= 0 || maxDepthUs <= 0)
+    {
+        throw std::invalid_argument("Error in AudioJitterBuffer - sample rate, frame size and depth must be positive");
+    }
+}
+
+void AudioJitterBuffer::push(const AudioChunk& audioChunk)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::size_t size = audioChunk.size - audioChunk.size % frameBytes_;
+    if (size == 0)
+    {
+        return;
+    }
+
+    unsigned long long chunkEnd = audioChunk.timestamp + bytesToUs(size);
+    if (isPlaying_ && chunkEnd <= nextTimestamp_)
+    {
+        if (static_cast<int64_t>(nextTimestamp_ - audioChunk.timestamp) > MAX_GAP_US)
+        {
+            reset();
+        }
+        else
+        {
+            ++stats_.lateChunkCount;
+            return;
+        }
+    }
+
+    // Chunks are almost always in order, search from the back
+    auto it = chunks_.end();
+    while (it != chunks_.begin() && std::prev(it)->timestamp > audioChunk.timestamp)
+    {
+        --it;
+    }
+
+    if (it != chunks_.begin() && std::prev(it)->timestamp == audioChunk.timestamp)
+    {
+        ++stats_.lateChunkCount;
+        return;
+    }
+
+    // The front chunk may be partially read, never insert before it
+    if (it == chunks_.begin() && frontOffset_ > 0)
+    {
+        ++stats_.lateChunkCount;
+        return;
+    }
+
+    AudioChunk chunk = audioChunk;
+    chunk.size = size;
+    chunks_.insert(it, chunk);
+    bufferedBytes_ += size;
+
+    std::size_t maxDepthBytes = usToBytes(maxDepthUs_);
+    if (bufferedBytes_ + pendingSilenceBytes_ > maxDepthBytes)
+    {
+        dropFront(bufferedBytes_ + pendingSilenceBytes_ - maxDepthBytes);
+    }
+}
+
+/**
+ * @brief Fill the output with the next frames to play, silence is output when the buffer is empty.
+ */
+void AudioJitterBuffer::read(uint8_t* outData, std::size_t size)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    while (size > 0)
+    {
+        std::size_t readSize = 0;
+
+        if (pendingSilenceBytes_ > 0)
+        {
+            readSize = std::min(size, pendingSilenceBytes_);
+            std::memset(outData, 0, readSize);
+            pendingSilenceBytes_ -= readSize;
+            nextTimestamp_ += bytesToUs(readSize);
+        }
+        else if (chunks_.empty())
+        {
+            readSize = size;
+            std::memset(outData, 0, readSize);
+            stats_.insertedFrameCount += readSize / frameBytes_;
+            if (isPlaying_)
+            {
+                ++stats_.underrunCount;
+                nextTimestamp_ += bytesToUs(readSize);
+            }
+        }
+        else
+        {
+            const AudioChunk& chunk = chunks_.front();
+
+            // A chunk is missing, play silence for its duration so the next one plays at its time
+            int64_t gapUs = static_cast<int64_t>(chunk.timestamp - nextTimestamp_);
+            if (isPlaying_ && frontOffset_ == 0 && gapUs > bytesToUs(chunk.size) / 2 && gapUs < MAX_GAP_US)
+            {
+                std::size_t silenceSize = usToBytes(gapUs);
+                pendingSilenceBytes_ += silenceSize;
+                stats_.insertedFrameCount += silenceSize / frameBytes_;
+                continue;
+            }
+
+            readSize = std::min(size, chunk.size - frontOffset_);
+            std::memcpy(outData, chunk.audioData.get() + frontOffset_, readSize);
+            frontOffset_ += readSize;
+            bufferedBytes_ -= readSize;
+            nextTimestamp_ = chunk.timestamp + bytesToUs(frontOffset_);
+            isPlaying_ = true;
+
+            if (frontOffset_ == chunk.size)
+            {
+                chunks_.pop_front();
+                frontOffset_ = 0;
+            }
+        }
+
+        outData += readSize;
+        size -= readSize;
+    }
+}
+
+/**
+ * @brief Change the latency at once, by inserting silence when positive or dropping the oldest frames when negative.
+ */
+void AudioJitterBuffer::adjustDepth(int64_t deltaUs)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (deltaUs > 0)
+    {
+        std::size_t silenceSize = usToBytes(deltaUs);
+        pendingSilenceBytes_ += silenceSize;
+        stats_.insertedFrameCount += silenceSize / frameBytes_;
+    }
+    else
+    {
+        dropFront(usToBytes(-deltaUs));
+    }
+}
+
+int64_t AudioJitterBuffer::getDepthUs() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bytesToUs(bufferedBytes_ + pendingSilenceBytes_);
+}
+
+AudioJitterBufferStats AudioJitterBuffer::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void AudioJitterBuffer::dropFront(std::size_t size)
+{
+    std::size_t silenceSize = std::min(size, pendingSilenceBytes_);
+    pendingSilenceBytes_ -= silenceSize;
+    stats_.insertedFrameCount -= silenceSize / frameBytes_;
+    size -= silenceSize;
+
+    while (size > 0 && !chunks_.empty())
+    {
+        const AudioChunk& chunk = chunks_.front();
+        std::size_t dropSize = std::min(size, chunk.size - frontOffset_);
+        frontOffset_ += dropSize;
+        bufferedBytes_ -= dropSize;
+        size -= dropSize;
+        stats_.droppedFrameCount += dropSize / frameBytes_;
+        nextTimestamp_ = chunk.timestamp + bytesToUs(frontOffset_);
+
+        if (frontOffset_ == chunk.size)
+        {
+            chunks_.pop_front();
+            frontOffset_ = 0;
+        }
+    }
+}
+
+void AudioJitterBuffer::reset()
+{
+    chunks_.clear();
+    frontOffset_ = 0;
+    bufferedBytes_ = 0;
+    pendingSilenceBytes_ = 0;
+    isPlaying_ = false;
+}
+
+std::size_t AudioJitterBuffer::usToBytes(int64_t us) const
+{
+    return static_cast<std::size_t>(us * sampleRate_ / 1000000) * frameBytes_;
+}
+
+int64_t AudioJitterBuffer::bytesToUs(std::size_t size) const
+{
+    return static_cast<int64_t>(size / frameBytes_) * 1000000 / sampleRate_;
+}
+
+}    // namespace Model
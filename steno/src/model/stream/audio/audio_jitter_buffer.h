@@ -0,0 +1,62 @@
+#ifndef AUDIO_JITTER_BUFFER_H
+#define AUDIO_JITTER_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+#include "model/stream/audio/audio_chunk.h"
+
+namespace Model
+{
+struct AudioJitterBufferStats
+{
+    uint64_t underrunCount = 0;         // Reads that found the buffer empty
+    uint64_t lateChunkCount = 0;        // Chunks that arrived after their playout time
+    uint64_t droppedFrameCount = 0;     // Frames removed to reduce the latency or on overflow
+    uint64_t insertedFrameCount = 0;    // Silence frames for underruns, gaps and latency increases
+};
+
+/**
+ * @brief Orders the audio chunks by timestamp between a producer and the playout. Missing chunks are replaced by
+ * silence so the following ones play at their time, chunks arriving after their time are dropped.
+ */
+class AudioJitterBuffer
+{
+   public:
+    AudioJitterBuffer(int sampleRate, int frameBytes, int64_t maxDepthUs);
+
+    void push(const AudioChunk& audioChunk);
+    void read(uint8_t* outData, std::size_t size);
+    void adjustDepth(int64_t deltaUs);
+
+    int64_t getDepthUs() const;
+    AudioJitterBufferStats getStats() const;
+
+   private:
+    void dropFront(std::size_t size);
+    void reset();
+    std::size_t usToBytes(int64_t us) const;
+    int64_t bytesToUs(std::size_t size) const;
+
+    int sampleRate_;
+    std::size_t frameBytes_;
+    int64_t maxDepthUs_;
+
+    mutable std::mutex mutex_;
+    std::deque<AudioChunk> chunks_;
+    std::size_t frontOffset_;
+    std::size_t bufferedBytes_;
+    std::size_t pendingSilenceBytes_;
+
+    // Timestamp of the next frame to play, only valid once something was played
+    unsigned long long nextTimestamp_;
+    bool isPlaying_;
+
+    AudioJitterBufferStats stats_;
+};
+
+}    // namespace Model
+
+#endif    //! AUDIO_JITTER_BUFFER_H
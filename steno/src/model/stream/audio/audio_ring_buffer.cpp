@@ -0,0 +1,133 @@
+#include "audio_ring_buffer.h"
+
+#include <stdexcept>
+
+namespace Model
+{
+namespace
+{
+// Slots start on their own cache line so the producer and a consumer never share one
+const std::size_t SLOT_ALIGNMENT = 64;
+const int NO_SLOT = -1;
+
+}    // namespace
+
+AudioRingBuffer::Storage::~Storage()
+{
+    if (memoryAccounting)
+    {
+        memoryAccounting->recordDeallocation(subsystem, memory.size());
+    }
+}
+
+AudioRingBuffer::AudioRingBuffer(int slotCount, std::size_t slotSize,
+                                 std::shared_ptr<MemoryAccounting> memoryAccounting, const std::string& subsystem)
+    : storage_(std::make_shared<Storage>())
+    , discardBuffer_(slotSize)
+    , slotCount_(slotCount)
+    , slotSize_(slotSize)
+    , slotStride_((slotSize + SLOT_ALIGNMENT - 1) / SLOT_ALIGNMENT * SLOT_ALIGNMENT)
+    , writeIndex_(0)
+    , currentSlot_(NO_SLOT)
+    , overrunCount_(0)
+{
+    if (slotCount <= 0 || slotSize == 0)
+    {
+        throw std::invalid_argument("Error in AudioRingBuffer - slot count and slot size must be greater than 0");
+    }
+
+    if (!memoryAccounting)
+    {
+        throw std::invalid_argument("Error in AudioRingBuffer - Null is not a valid memory accounting");
+    }
+
+    storage_->memory.resize(slotStride_ * slotCount + SLOT_ALIGNMENT);
+
+    memoryAccounting->recordAllocation(subsystem, storage_->memory.size());
+    storage_->memoryAccounting = memoryAccounting;
+    storage_->subsystem = subsystem;
+
+    // The reference counts are allocated once, a view of a slot only increments its count
+    slotReferences_.reserve(slotCount);
+    for (int i = 0; i < slotCount; ++i)
+    {
+        slotReferences_.push_back(std::make_shared<SlotReference>());
+        slotReferences_.back()->storage = storage_;
+    }
+}
+
+/**
+ * @brief Reserve the next free slot, in ring order. Beginning again without a commit abandons the slot.
+ * @return where the slot data must be written, the discard buffer if every slot is held by a consumer.
+ */
+uint8_t* AudioRingBuffer::beginWrite()
+{
+    // Consumers release slots roughly in order, but one held longer than the others must not stall the ring
+    for (int i = 0; i < slotCount_; ++i)
+    {
+        int slot = (writeIndex_ + i) % slotCount_;
+        if (isSlotFree(slot))
+        {
+            currentSlot_ = slot;
+            writeIndex_ = (slot + 1) % slotCount_;
+            return getSlotData(slot);
+        }
+    }
+
+    currentSlot_ = NO_SLOT;
+    ++overrunCount_;
+    return discardBuffer_.data();
+}
+
+/**
+ * @brief Hand out the slot written since the last begin.
+ * @return view of the slot data, the slot is free again once every copy is destroyed. Null after an overrun.
+ */
+std::shared_ptr<uint8_t> AudioRingBuffer::commitWrite()
+{
+    if (currentSlot_ == NO_SLOT)
+    {
+        return nullptr;
+    }
+
+    int slot = currentSlot_;
+    currentSlot_ = NO_SLOT;
+
+    // The view shares the reference count of the slot, which keeps the storage alive for consumers outliving the ring
+    return std::shared_ptr<uint8_t>(slotReferences_[slot], getSlotData(slot));
+}
+
+std::size_t AudioRingBuffer::getSlotSize() const
+{
+    return slotSize_;
+}
+
+uint64_t AudioRingBuffer::getOverrunCount() const
+{
+    return overrunCount_;
+}
+
+/**
+ * @brief A slot is free once the last view of it is destroyed, only the ring can reference it again.
+ */
+bool AudioRingBuffer::isSlotFree(int slot) const
+{
+    if (slotReferences_[slot].use_count() != 1)
+    {
+        return false;
+    }
+
+    // The count is read relaxed, the fence orders the reads of the consumers before the slot is written again
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return true;
+}
+
+uint8_t* AudioRingBuffer::getSlotData(int slot)
+{
+    uint8_t* memory = storage_->memory.data();
+    std::size_t alignmentOffset =
+        (SLOT_ALIGNMENT - reinterpret_cast<uintptr_t>(memory) % SLOT_ALIGNMENT) % SLOT_ALIGNMENT;
+    return memory + alignmentOffset + slot * slotStride_;
+}
+
+}    // namespace Model
@@ -0,0 +1,65 @@
+#ifndef AUDIO_RING_BUFFER_H
+#define AUDIO_RING_BUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "model/stream/utils/alloc/memory_accounting.h"
+
+namespace Model
+{
+/**
+ * @brief Contiguous ring of fixed size audio slots written in place by a single producer. A committed slot is handed
+ * out as a view that releases the slot once its last copy is destroyed, a slot is never rewritten while a consumer
+ * still holds it. When no slot is free the producer writes in a discard buffer and the overrun is counted. The slots
+ * are accounted under a subsystem label until the ring and every view are destroyed.
+ */
+class AudioRingBuffer
+{
+   public:
+    AudioRingBuffer(int slotCount, std::size_t slotSize, std::shared_ptr<MemoryAccounting> memoryAccounting,
+                    const std::string& subsystem);
+
+    uint8_t* beginWrite();
+    std::shared_ptr<uint8_t> commitWrite();
+
+    std::size_t getSlotSize() const;
+    uint64_t getOverrunCount() const;
+
+   private:
+    struct Storage
+    {
+        ~Storage();
+
+        std::vector<uint8_t> memory;
+        std::shared_ptr<MemoryAccounting> memoryAccounting;
+        std::string subsystem;
+    };
+
+    // Reference count of a slot, the views of the slot share it. The ring holds the only reference of a free slot
+    struct SlotReference
+    {
+        std::shared_ptr<Storage> storage;
+    };
+
+    bool isSlotFree(int slot) const;
+    uint8_t* getSlotData(int slot);
+
+    std::shared_ptr<Storage> storage_;
+    std::vector<std::shared_ptr<SlotReference>> slotReferences_;
+    std::vector<uint8_t> discardBuffer_;
+    int slotCount_;
+    std::size_t slotSize_;
+    std::size_t slotStride_;
+    int writeIndex_;
+    int currentSlot_;
+    std::atomic<uint64_t> overrunCount_;
+};
+
+}    // namespace Model
+
+#endif    //! AUDIO_RING_BUFFER_H
@@ -0,0 +1,341 @@
+#include "async_file_audio_sink.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+namespace Model
+{
+namespace
+{
+// Disk writes are done by blocks of this size, the ring holds a whole number of them
+const std::size_t WRITE_BLOCK_SIZE = 64 * 1024;
+const std::size_t RING_ALIGNMENT = 4096;
+
+const int WRITE_INTERVAL_MS = 50;
+const int64_t LATE_WRITE_US = 100000;
+
+// RIFF header, a JUNK chunk the size of a ds64 chunk so the file can become RF64 in place, fmt and data headers
+const std::size_t WAV_HEADER_SIZE = 80;
+const std::size_t WAV_DS64_OFFSET = 12;
+const std::size_t WAV_FMT_OFFSET = 48;
+const std::size_t WAV_DATA_OFFSET = 72;
+const uint16_t WAV_FORMAT_PCM = 1;
+const uint16_t WAV_FORMAT_IEEE_FLOAT = 3;
+const uint64_t MAX_RIFF_SIZE = 0xFFFFFFFF;
+
+void putLe16(uint8_t* data, uint16_t value)
+{
+    data[0] = static_cast<uint8_t>(value);
+    data[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void putLe32(uint8_t* data, uint32_t value)
+{
+    putLe16(data, static_cast<uint16_t>(value));
+    putLe16(data + 2, static_cast<uint16_t>(value >> 16));
+}
+
+void putLe64(uint8_t* data, uint64_t value)
+{
+    putLe32(data, static_cast<uint32_t>(value));
+    putLe32(data + 4, static_cast<uint32_t>(value >> 32));
+}
+
+}    // namespace
+
+/**
+ * @param [IN] fileName - file to create, an existing file is overwritten.
+ * @param [IN] fileFormat - raw samples or WAV.
+ * @param [IN] format - format of the chunks, written as is.
+ * @param [IN] bufferDurationMs - how long the disk can stall before chunks are dropped.
+ */
+AsyncFileAudioSink::AsyncFileAudioSink(const std::string& fileName, FileFormat fileFormat, const AudioFormat& format,
+                                       int bufferDurationMs)
+    : fileName_(fileName)
+    , fileFormat_(fileFormat)
+    , format_(format)
+    , fd_(-1)
+    , ring_(nullptr)
+    , ringSize_(0)
+    , writeCount_(0)
+    , readCount_(0)
+    , dataSize_(0)
+    , hasWriteError_(false)
+    , droppedChunkCount_(0)
+    , lateWriteCount_(0)
+    , maxWriteTimeUs_(0)
+{
+    if (bufferDurationMs <= 0 || format_.channels <= 0 || format_.sampleRate <= 0)
+    {
+        throw std::invalid_argument("Error in AsyncFileAudioSink - invalid audio format or buffer duration");
+    }
+
+#if __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+    if (fileFormat_ == FileFormat::WAV)
+    {
+        throw std::invalid_argument("Error in AsyncFileAudioSink - WAV files only hold little endian samples");
+    }
+#endif
+
+    std::size_t bufferSize = static_cast<std::size_t>(format_.sampleRate) * format_.getFrameBytes() * bufferDurationMs / 1000;
+    std::size_t blockCount = std::max<std::size_t>(2, (bufferSize + WRITE_BLOCK_SIZE - 1) / WRITE_BLOCK_SIZE);
+    ringSize_ = blockCount * WRITE_BLOCK_SIZE;
+
+    memory_.resize(ringSize_ + RING_ALIGNMENT);
+    std::size_t misalignment = reinterpret_cast<uintptr_t>(memory_.data()) % RING_ALIGNMENT;
+    ring_ = memory_.data() + (misalignment == 0 ? 0 : RING_ALIGNMENT - misalignment);
+}
+
+AsyncFileAudioSink::~AsyncFileAudioSink()
+{
+    close();
+}
+
+void AsyncFileAudioSink::open()
+{
+    if (fd_ >= 0)
+    {
+        return;
+    }
+
+    int fd = ::open(fileName_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        throw std::runtime_error("cannot open file " + fileName_ + ": " + std::strerror(errno));
+    }
+
+    writeCount_ = 0;
+    readCount_ = 0;
+    dataSize_ = 0;
+    hasWriteError_ = false;
+    droppedChunkCount_ = 0;
+    lateWriteCount_ = 0;
+    maxWriteTimeUs_ = 0;
+
+    fd_.store(fd, std::memory_order_release);
+
+    // Sizes are zero until close, a player still opens the file if the recording is interrupted
+    if (fileFormat_ == FileFormat::WAV)
+    {
+        writeHeader();
+    }
+
+    start();
+}
+
+void AsyncFileAudioSink::close()
+{
+    if (fd_ < 0)
+    {
+        return;
+    }
+
+    // The writer flushes the buffer before stopping
+    stop();
+    join();
+
+    if (fileFormat_ == FileFormat::WAV)
+    {
+        writeHeader();
+    }
+
+    ::close(fd_.exchange(-1));
+
+    AudioFileSinkStats stats = getStats();
+    std::cout << "Audio recording " << fileName_ << " closed, " << stats.writtenBytes << " bytes written, "
+              << stats.droppedChunkCount << " chunks dropped, " << stats.lateWriteCount << " late writes (max "
+              << stats.maxWriteTimeUs / 1000 << " ms)" << std::endl;
+}
+
+/**
+ * @brief Copy the chunk in the buffer of the writer thread, never blocks.
+ * @return number of bytes queued, 0 if the chunk was dropped.
+ */
+int AsyncFileAudioSink::write(const AudioChunk& audioChunk)
+{
+    // The counters are read after the descriptor, they were reset before it was set
+    if (fd_.load(std::memory_order_acquire) < 0)
+    {
+        ++droppedChunkCount_;
+        return 0;
+    }
+
+    uint64_t writeCount = writeCount_.load(std::memory_order_relaxed);
+    uint64_t queuedSize = writeCount - readCount_.load(std::memory_order_acquire);
+    std::size_t freeSize = ringSize_ - static_cast<std::size_t>(queuedSize);
+
+    if (audioChunk.size > freeSize)
+    {
+        ++droppedChunkCount_;
+        return 0;
+    }
+
+    std::size_t offset = static_cast<std::size_t>(writeCount % ringSize_);
+    std::size_t firstSize = std::min(audioChunk.size, ringSize_ - offset);
+    std::memcpy(ring_ + offset, audioChunk.audioData.get(), firstSize);
+    std::memcpy(ring_, audioChunk.audioData.get() + firstSize, audioChunk.size - firstSize);
+
+    writeCount_.store(writeCount + audioChunk.size, std::memory_order_release);
+    return static_cast<int>(audioChunk.size);
+}
+
+AudioFormat AsyncFileAudioSink::getNativeFormat() const
+{
+    return format_;
+}
+
+int64_t AsyncFileAudioSink::getLatencyUs() const
+{
+    // Nothing is heard
+    return 0;
+}
+
+AudioFileSinkStats AsyncFileAudioSink::getStats() const
+{
+    AudioFileSinkStats stats;
+    stats.writtenBytes = readCount_;
+    stats.droppedChunkCount = droppedChunkCount_;
+    stats.lateWriteCount = lateWriteCount_;
+    stats.maxWriteTimeUs = maxWriteTimeUs_;
+    return stats;
+}
+
+void AsyncFileAudioSink::run()
+{
+    while (!isAbortRequested())
+    {
+        writeBlocks(false);
+        sleep(WRITE_INTERVAL_MS);
+    }
+
+    writeBlocks(true);
+}
+
+/**
+ * @brief Write the whole blocks available in the buffer, or everything when flushing.
+ */
+void AsyncFileAudioSink::writeBlocks(bool isFlushing)
+{
+    uint64_t readCount = readCount_.load(std::memory_order_relaxed);
+    uint64_t availableSize = writeCount_.load(std::memory_order_acquire) - readCount;
+    if (!isFlushing)
+    {
+        availableSize -= availableSize % WRITE_BLOCK_SIZE;
+    }
+
+    uint64_t headerSize = fileFormat_ == FileFormat::WAV ? WAV_HEADER_SIZE : 0;
+
+    while (availableSize > 0)
+    {
+        // Blocks never wrap around since the ring holds a whole number of them
+        std::size_t offset = static_cast<std::size_t>(readCount % ringSize_);
+        std::size_t size = static_cast<std::size_t>(std::min<uint64_t>(availableSize, ringSize_ - offset));
+
+        std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+        if (!hasWriteError_ && writeFile(ring_ + offset, size, headerSize + dataSize_))
+        {
+            dataSize_ += size;
+        }
+
+        int64_t writeTimeUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                                  std::chrono::steady_clock::now() - startTime).count();
+        if (writeTimeUs > LATE_WRITE_US)
+        {
+            ++lateWriteCount_;
+        }
+        maxWriteTimeUs_ = std::max<int64_t>(maxWriteTimeUs_, writeTimeUs);
+
+        readCount += size;
+        availableSize -= size;
+        readCount_.store(readCount, std::memory_order_release);
+    }
+}
+
+/**
+ * @brief Write the WAV header for the data written so far, as RF64 if the file is too big for RIFF sizes.
+ */
+void AsyncFileAudioSink::writeHeader()
+{
+    std::array<uint8_t, WAV_HEADER_SIZE> header{};
+    uint32_t frameSize = static_cast<uint32_t>(format_.getFrameBytes());
+    uint32_t sampleRate = static_cast<uint32_t>(format_.sampleRate);
+
+    // The data chunk is padded to an even size
+    bool hasPadding = dataSize_ % 2 != 0;
+    if (hasPadding)
+    {
+        uint8_t padding = 0;
+        writeFile(&padding, 1, WAV_HEADER_SIZE + dataSize_);
+    }
+
+    uint64_t riffSize = WAV_HEADER_SIZE - 8 + dataSize_ + (hasPadding ? 1 : 0);
+    bool isRf64 = riffSize > MAX_RIFF_SIZE;
+
+    std::memcpy(header.data(), isRf64 ? "RF64" : "RIFF", 4);
+    putLe32(header.data() + 4, static_cast<uint32_t>(isRf64 ? MAX_RIFF_SIZE : riffSize));
+    std::memcpy(header.data() + 8, "WAVE", 4);
+
+    uint8_t* ds64 = header.data() + WAV_DS64_OFFSET;
+    std::memcpy(ds64, isRf64 ? "ds64" : "JUNK", 4);
+    putLe32(ds64 + 4, 28);
+    if (isRf64)
+    {
+        putLe64(ds64 + 8, riffSize);
+        putLe64(ds64 + 16, dataSize_);
+        putLe64(ds64 + 24, dataSize_ / frameSize);
+        putLe32(ds64 + 32, 0);
+    }
+
+    uint8_t* fmt = header.data() + WAV_FMT_OFFSET;
+    std::memcpy(fmt, "fmt ", 4);
+    putLe32(fmt + 4, 16);
+    putLe16(fmt + 8, format_.sampleFormat == SampleFormat::F32 ? WAV_FORMAT_IEEE_FLOAT : WAV_FORMAT_PCM);
+    putLe16(fmt + 10, static_cast<uint16_t>(format_.channels));
+    putLe32(fmt + 12, sampleRate);
+    putLe32(fmt + 16, sampleRate * frameSize);
+    putLe16(fmt + 20, static_cast<uint16_t>(frameSize));
+    putLe16(fmt + 22, static_cast<uint16_t>(format_.getBytesPerSample() * 8));
+
+    uint8_t* data = header.data() + WAV_DATA_OFFSET;
+    std::memcpy(data, "data", 4);
+    putLe32(data + 4, static_cast<uint32_t>(isRf64 ? MAX_RIFF_SIZE : dataSize_));
+
+    writeFile(header.data(), header.size(), 0);
+}
+
+bool AsyncFileAudioSink::writeFile(const uint8_t* data, std::size_t size, uint64_t offset)
+{
+    while (size > 0)
+    {
+        ssize_t writtenSize = pwrite(fd_, data, size, static_cast<off_t>(offset));
+        if (writtenSize < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (writtenSize <= 0)
+        {
+            // Keep draining the buffer so the caller never stalls, the recording stops here
+            std::cout << "Error in AsyncFileAudioSink - cannot write " << fileName_ << ": " << std::strerror(errno)
+                      << std::endl;
+            hasWriteError_ = true;
+            return false;
+        }
+
+        data += writtenSize;
+        size -= static_cast<std::size_t>(writtenSize);
+        offset += static_cast<uint64_t>(writtenSize);
+    }
+
+    return true;
+}
+
+}    // namespace Model
@@ -0,0 +1,83 @@
+#ifndef ASYNC_FILE_AUDIO_SINK_H
+#define ASYNC_FILE_AUDIO_SINK_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "model/stream/audio/audio_format.h"
+#include "model/stream/audio/i_audio_sink.h"
+#include "model/stream/utils/threads/thread.h"
+
+namespace Model
+{
+struct AudioFileSinkStats
+{
+    uint64_t writtenBytes = 0;
+    uint64_t droppedChunkCount = 0;    // Chunks that did not fit in the buffer while the disk was behind
+    uint64_t lateWriteCount = 0;       // Disk writes slower than expected, the buffer absorbed them
+    int64_t maxWriteTimeUs = 0;
+};
+
+/**
+ * @brief Records audio to a file without blocking the caller. Chunks are copied in a preallocated single producer,
+ * single consumer byte ring and a background thread writes it to disk in large aligned blocks. A chunk is dropped
+ * if the disk falls behind by more than the buffer duration. WAV files become RF64 when they outgrow 4 GiB, the
+ * header is patched on close.
+ */
+class AsyncFileAudioSink : public IAudioSink, protected Thread
+{
+   public:
+    enum class FileFormat
+    {
+        RAW,
+        WAV
+    };
+
+    AsyncFileAudioSink(const std::string& fileName, FileFormat fileFormat, const AudioFormat& format,
+                       int bufferDurationMs);
+    ~AsyncFileAudioSink() override;
+
+    void open() override;
+    void close() override;
+    int write(const AudioChunk& audioChunk) override;
+    AudioFormat getNativeFormat() const override;
+    int64_t getLatencyUs() const override;
+
+    AudioFileSinkStats getStats() const;
+
+   protected:
+    void run() override;
+
+   private:
+    void writeBlocks(bool isFlushing);
+    void writeHeader();
+    bool writeFile(const uint8_t* data, std::size_t size, uint64_t offset);
+
+    std::string fileName_;
+    FileFormat fileFormat_;
+    AudioFormat format_;
+
+    // Also read by the caller of write, it is only set once the buffer of a new recording is empty
+    std::atomic<int> fd_;
+
+    std::vector<uint8_t> memory_;
+    uint8_t* ring_;
+    std::size_t ringSize_;
+    std::atomic<uint64_t> writeCount_;
+    std::atomic<uint64_t> readCount_;
+
+    // Only used by the writer thread once open
+    uint64_t dataSize_;
+    bool hasWriteError_;
+
+    std::atomic<uint64_t> droppedChunkCount_;
+    std::atomic<uint64_t> lateWriteCount_;
+    std::atomic<int64_t> maxWriteTimeUs_;
+};
+
+}    // namespace Model
+
+#endif    //! ASYNC_FILE_AUDIO_SINK_H
@@ -4,9 +4,10 @@
 
 namespace Model
 {
-RawFileAudioSink::RawFileAudioSink(const std::string& fileName)
+RawFileAudioSink::RawFileAudioSink(const std::string& fileName, const AudioFormat& format)
     : m_file(nullptr)
     , m_fileName(fileName)
+    , m_format(format)
 {
 }
 
@@ -37,4 +38,14 @@ int RawFileAudioSink::write(const AudioChunk& audioChunk)
 {
     return fwrite(audioChunk.audioData.get(), sizeof(audioChunk.audioData.get()[0]), audioChunk.size, m_file);
 }
+
+AudioFormat RawFileAudioSink::getNativeFormat() const
+{
+    return m_format;
+}
+
+int64_t RawFileAudioSink::getLatencyUs() const
+{
+    return 0;
+}
 }    // namespace Model
@@ -10,16 +10,19 @@ namespace Model
 class RawFileAudioSink : public IAudioSink
 {
    public:
-    RawFileAudioSink(const std::string& fileName);
+    RawFileAudioSink(const std::string& fileName, const AudioFormat& format);
     ~RawFileAudioSink() override;
 
     void open() override;
     void close() override;
     int write(const AudioChunk& audioChunk) override;
+    AudioFormat getNativeFormat() const override;
+    int64_t getLatencyUs() const override;
 
    private:
     FILE* m_file;
     std::string m_fileName;
+    AudioFormat m_format;
 };
 
 }    // namespace Model
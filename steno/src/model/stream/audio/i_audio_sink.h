@@ -4,6 +4,7 @@
 #include <cstdint>
 
 #include "model/stream/audio/audio_chunk.h"
+#include "model/stream/audio/audio_format.h"
 
 namespace Model
 {
@@ -15,6 +16,16 @@ class IAudioSink
     virtual void open() = 0;
     virtual void close() = 0;
     virtual int write(const AudioChunk& audioChunk) = 0;
+
+    /**
+     * @brief Format the chunks must be written in, the pipeline converts to it once before the sink.
+     */
+    virtual AudioFormat getNativeFormat() const = 0;
+
+    /**
+     * @brief Time from a write to when the chunk is heard, used to present the video with the audio.
+     */
+    virtual int64_t getLatencyUs() const = 0;
 };
 
 }    // namespace Model
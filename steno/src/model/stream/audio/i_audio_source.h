@@ -13,6 +13,7 @@ class IAudioSource
     virtual void open() = 0;
     virtual void close() = 0;
     virtual bool readAudioChunk(AudioChunk& outAudioChunk) = 0;
+    virtual bool waitAudioChunk(AudioChunk& outAudioChunk, int timeoutUs) = 0;
 };
 
 }    // namespace Model
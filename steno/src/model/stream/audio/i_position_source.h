@@ -1,9 +1,9 @@
 #ifndef I_POSITION_SOURCE_H
 #define I_POSITION_SOURCE_H
 
-#include <vector>
+#include <cstdint>
 
-#include "source_position.h"
+#include "model/stream/audio/source_positions.h"
 
 namespace Model
 {
@@ -14,7 +14,8 @@ class IPositionSource
 
     virtual void open() = 0;
     virtual void close() = 0;
-    virtual std::vector<SourcePosition> getPositions() = 0;
+    virtual SourcePositions getPositions() = 0;
+    virtual SourcePositions getPositionsAt(uint64_t timestamp) = 0;
 };
 
 }    // namespace Model
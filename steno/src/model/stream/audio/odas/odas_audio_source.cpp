@@ -1,143 +1,172 @@
 #include "odas_audio_source.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
 
-#include <QDebug>
-#include <QTcpServer>
-#include <QTcpSocket>
+namespace
+{
+const char* INPUT_RING_SUBSYSTEM = "audio input ring";
+}    // namespace
 
 namespace Model
 {
-OdasAudioSource::OdasAudioSource(int port, int desiredChunkDurationMs, int numberOfBuffers,
-                                 std::shared_ptr<AudioConfig> audioConfig)
-    : port_(port)
-    , audioConfig_(audioConfig)
-    // We add 10 buffers to make sure we don't overwrite data when reading from the socket
-    , audioChunks_(numberOfBuffers + 10, AudioChunk(desiredChunkDurationMs / 1000.f * audioConfig_->rate,
-                                               audioConfig_->channels, audioConfig_->formatBytes))
+OdasAudioSource::OdasAudioSource(const OdasEndpoint& endpoint, int desiredChunkDurationMs, int numberOfBuffers,
+                                 std::shared_ptr<AudioConfig> audioConfig, std::shared_ptr<MediaClock> mediaClock,
+                                 std::shared_ptr<OdasSocketReactor> reactor,
+                                 std::shared_ptr<MemoryAccounting> memoryAccounting)
+    : audioConfig_(audioConfig)
+    , reactor_(reactor)
+    , sourceClock_(mediaClock ? mediaClock->addSource("odas") : nullptr)
+    , isOpen_(false)
+    , currentChunk_(desiredChunkDurationMs / 1000.f * audioConfig_->rate, audioConfig_->channels,
+                    audioConfig_->formatBytes)
+    // We add 10 slots for the chunks held past the queue, a slot is only rewritten once every holder released it
+    , audioRing_(numberOfBuffers + 10, currentChunk_.size, memoryAccounting, INPUT_RING_SUBSYSTEM)
+    , currentChunkData_(nullptr)
     , audioQueue_(std::make_shared<moodycamel::BlockingReaderWriterQueue<AudioChunk>>(numberOfBuffers))
+    , packetHeader_(audioConfig_->packetHeaderSize)
+    , packetHeaderIndex_(0)
+    , packetAudioIndex_(0)
+    , packetTimestamp_(0)
+    , chunkIndex_(0)
+    , droppedChunkCount_(0)
 {
-    for (int i = 0; i < audioChunks_.size(); i++)
+    if (!reactor_)
+    {
+        throw std::invalid_argument("Error in OdasAudioSource - Null is not a valid reactor");
+    }
+
+    if (!sourceClock_)
     {
-        audioChunks_.current().audioData =
-            std::shared_ptr<uint8_t>(new uint8_t[audioChunks_.current().size], std::default_delete<uint8_t[]>());
-        audioChunks_.next();
+        throw std::invalid_argument("Error in OdasAudioSource - Null is not a valid media clock");
     }
+
+    // A shared memory message holds one packet
+    reactor_->addListener(endpoint, audioConfig_->packetHeaderSize + audioConfig_->packetAudioSize, this);
 }
 
 OdasAudioSource::~OdasAudioSource()
 {
     close();
+    reactor_->removeListener(this);
 }
 
 void OdasAudioSource::open()
 {
-    start();
+    if (!isOpen_)
+    {
+        reactor_->open();
+        isOpen_ = true;
+    }
 }
 
 void OdasAudioSource::close()
 {
-    requestInterruption();
+    if (isOpen_)
+    {
+        reactor_->close();
+        isOpen_ = false;
+    }
 }
 
-void OdasAudioSource::run()
+/**
+ * @brief Packet headers are received in a scratch buffer, the audio is received directly in the ring slot of the
+ * current chunk.
+ */
+std::size_t OdasAudioSource::getReceiveBuffer(uint8_t*& outBuffer)
 {
-    QTcpSocket* socket = nullptr;
+    if (packetHeaderIndex_ < audioConfig_->packetHeaderSize)
+    {
+        outBuffer = packetHeader_.data() + packetHeaderIndex_;
+        return audioConfig_->packetHeaderSize - packetHeaderIndex_;
+    }
 
-    std::unique_ptr<QTcpServer> server = std::make_unique<QTcpServer>();
-    server->setMaxPendingConnections(1);
-    server->listen(QHostAddress::Any, port_);
+    if (currentChunkData_ == nullptr)
+    {
+        currentChunkData_ = audioRing_.beginWrite();
+    }
 
-    qDebug() << "Odas audio source thread started";
+    std::size_t remainingChunkSpace = currentChunk_.size - chunkIndex_;
+    std::size_t remainingPacketBytes = audioConfig_->packetAudioSize - packetAudioIndex_;
 
-    unsigned int readIndex = 0;
-    while (!isInterruptionRequested())
+    outBuffer = currentChunkData_ + chunkIndex_;
+    return remainingChunkSpace < remainingPacketBytes ? remainingChunkSpace : remainingPacketBytes;
+}
+
+void OdasAudioSource::onReceived(std::size_t byteCount)
+{
+    if (packetHeaderIndex_ < audioConfig_->packetHeaderSize)
     {
-        if (socket == nullptr)
+        packetHeaderIndex_ += byteCount;
+
+        if (packetHeaderIndex_ == audioConfig_->packetHeaderSize)
         {
-            if (server->waitForNewConnection(1))
+            packetTimestamp_ = 0;
+            std::memcpy(&packetTimestamp_, packetHeader_.data(),
+                        std::min(packetHeader_.size(), sizeof(packetTimestamp_)));
+            sourceClock_->observe(packetTimestamp_, MediaClock::now());
+
+            // The packet starts a new chunk
+            if (chunkIndex_ == 0)
             {
-                socket = server->nextPendingConnection();
+                currentChunk_.timestamp = packetTimestamp_;
             }
         }
-        else
+        return;
+    }
+
+    chunkIndex_ += byteCount;
+    packetAudioIndex_ += byteCount;
+
+    // Current chunk is full
+    if (chunkIndex_ == currentChunk_.size)
+    {
+        outputAudioChunk();
+        chunkIndex_ = 0;
+
+        // Start a new chunk if there is still data in the packet
+        if (packetAudioIndex_ < audioConfig_->packetAudioSize)
         {
-            if (socket->state() == QAbstractSocket::ConnectedState)
-            {
-                if (socket->bytesAvailable() >= audioConfig_->packetAudioSize)
-                {
-                    AudioChunk& audioChunk = audioChunks_.current();
-
-                    unsigned long long currentTimeStamp = 0;
-                    socket->read(reinterpret_cast<char*>(&currentTimeStamp), audioConfig_->packetHeaderSize);
-                    
-                    if (readIndex == 0)
-                    {
-                        audioChunk.timestamp = currentTimeStamp;
-                    }
-
-                    int remainingChunkSpace = audioChunk.size - readIndex;
-                    int bytesToRead = remainingChunkSpace < audioConfig_->packetAudioSize
-                                          ? remainingChunkSpace
-                                          : audioConfig_->packetAudioSize;
-
-                    int firstBytesRead =
-                        socket->read(reinterpret_cast<char*>(audioChunk.audioData.get()) + readIndex, bytesToRead);
-                    readIndex += firstBytesRead;
-
-                    // There is still data to be read if the chunk didn't have enough space
-                    int remainingBytesToRead = audioConfig_->packetAudioSize - firstBytesRead;
-
-                    // Current chunk is full
-                    if (readIndex == audioChunk.size)
-                    {
-                        audioChunks_.next();
-                        readIndex = 0;
-
-                        // Start a new chunk if there is still data in the packet
-                        if (remainingBytesToRead > 0)
-                        {
-                            AudioChunk& newAudioChunk = audioChunks_.current();
-
-                            unsigned long long newTimeStamp = calculateNewTimestamp(currentTimeStamp, bytesToRead);
-                            newAudioChunk.timestamp = newTimeStamp;
-
-                            // Read remaining packet data in the new chunk
-                            int secondBytesRead =
-                                socket->read(reinterpret_cast<char*>(newAudioChunk.audioData.get()) + readIndex,
-                                             remainingBytesToRead);
-                            readIndex += secondBytesRead;
-                        }
-
-                        // Output audio chunk, if queue is full keep trying...
-                        bool success = false;
-                        while (!success && !isInterruptionRequested())
-                        {
-                            success = audioQueue_->try_enqueue(audioChunk);
-
-                            if (!success)
-                            {
-                                std::this_thread::sleep_for(std::chrono::milliseconds(1));
-                            }
-                        }
-                    }
-                }
-                else
-                {
-                    socket->waitForReadyRead(1);
-                }
-            }
-            else
-            {
-                // reset read
-                readIndex = 0;
-                delete socket;
-                socket = nullptr;
-            }
+            currentChunk_.timestamp = calculateNewTimestamp(packetTimestamp_, packetAudioIndex_);
         }
     }
 
-    qDebug() << "Odas audio source thread stopped";
+    // Packet is complete, the next bytes are the header of the next one
+    if (packetAudioIndex_ == audioConfig_->packetAudioSize)
+    {
+        packetHeaderIndex_ = 0;
+        packetAudioIndex_ = 0;
+    }
+}
+
+void OdasAudioSource::onConnected()
+{
+    std::cout << "Odas audio source connected" << std::endl;
+
+    packetHeaderIndex_ = 0;
+    packetAudioIndex_ = 0;
+    chunkIndex_ = 0;
+    droppedChunkCount_ = 0;
+
+    // Odas may have restarted with another clock
+    sourceClock_->reset();
+}
+
+void OdasAudioSource::onDisconnected()
+{
+    ClockEstimate clockEstimate = sourceClock_->getEstimate();
+    std::cout << "Odas audio source disconnected, " << droppedChunkCount_ << " audio chunks dropped, "
+              << audioRing_.getOverrunCount() << " audio ring overruns, clock skew " << clockEstimate.skewPpm
+              << " ppm, jitter " << clockEstimate.jitterUs << " us" << std::endl;
+
+    // The partial chunk is discarded, the next connection starts a new one
+    packetHeaderIndex_ = 0;
+    packetAudioIndex_ = 0;
+    chunkIndex_ = 0;
+    currentChunkData_ = nullptr;
 }
 
 bool OdasAudioSource::readAudioChunk(AudioChunk& outAudioChunk)
@@ -145,6 +174,38 @@ bool OdasAudioSource::readAudioChunk(AudioChunk& outAudioChunk)
     return audioQueue_->try_dequeue(outAudioChunk);
 }
 
+/**
+ * @brief Block until a chunk is received or the timeout expires.
+ */
+bool OdasAudioSource::waitAudioChunk(AudioChunk& outAudioChunk, int timeoutUs)
+{
+    return audioQueue_->wait_dequeue_timed(outAudioChunk, static_cast<std::int64_t>(timeoutUs));
+}
+
+/**
+ * @brief Queue the current chunk, stamped on the media timeline, the next chunk starts in a new ring slot. The reactor
+ * can't wait on the consumer, if the queue is full the chunk is dropped and its slot released right away.
+ */
+void OdasAudioSource::outputAudioChunk()
+{
+    currentChunk_.timestamp = sourceClock_->toMediaTime(currentChunk_.timestamp);
+    currentChunk_.audioData = audioRing_.commitWrite();
+    currentChunkData_ = nullptr;
+
+    // Every slot was held by a consumer, the chunk was received in the discard buffer and is already counted
+    if (currentChunk_.audioData == nullptr)
+    {
+        return;
+    }
+
+    if (!audioQueue_->try_enqueue(currentChunk_))
+    {
+        ++droppedChunkCount_;
+    }
+
+    currentChunk_.audioData.reset();
+}
+
 unsigned long long OdasAudioSource::calculateNewTimestamp(unsigned long long currentTimestamp, int bytesForward)
 {
     int numberOfSamples = bytesForward / audioConfig_->formatBytes / audioConfig_->channels;
@@ -2,35 +2,56 @@
 #define ODAS_AUDIO_SOURCE_H
 
 #include <memory>
-
-#include <QThread>
+#include <vector>
 
 #include "model/stream/audio/audio_config.h"
+#include "model/stream/audio/audio_ring_buffer.h"
 #include "model/stream/audio/i_audio_source.h"
-#include "model/stream/utils/models/circular_buffer.h"
+#include "model/stream/audio/odas/odas_socket_reactor.h"
 #include "model/stream/utils/threads/readerwriterqueue.h"
+#include "model/stream/utils/time/media_clock.h"
 
 namespace Model
 {
-class OdasAudioSource : public QThread, public IAudioSource
+class OdasAudioSource : public IAudioSource, public IOdasSocketHandler
 {
    public:
-    OdasAudioSource(int port, int desiredChunkDurationMs, int numberOfBuffers,
-                    std::shared_ptr<AudioConfig> audioConfig);
+    OdasAudioSource(const OdasEndpoint& endpoint, int desiredChunkDurationMs, int numberOfBuffers,
+                    std::shared_ptr<AudioConfig> audioConfig, std::shared_ptr<MediaClock> mediaClock,
+                    std::shared_ptr<OdasSocketReactor> reactor, std::shared_ptr<MemoryAccounting> memoryAccounting);
     ~OdasAudioSource() override;
 
     void open() override;
     void close() override;
     bool readAudioChunk(AudioChunk& outAudioChunk) override;
+    bool waitAudioChunk(AudioChunk& outAudioChunk, int timeoutUs) override;
+
+    std::size_t getReceiveBuffer(uint8_t*& outBuffer) override;
+    void onReceived(std::size_t byteCount) override;
+    void onConnected() override;
+    void onDisconnected() override;
 
    private:
-    void run() override;
+    void outputAudioChunk();
     unsigned long long calculateNewTimestamp(unsigned long long currentTimestamp, int bytesForward);
 
-    int port_;
     std::shared_ptr<AudioConfig> audioConfig_;
-    CircularBuffer<AudioChunk> audioChunks_;
+    std::shared_ptr<OdasSocketReactor> reactor_;
+    std::shared_ptr<SourceClock> sourceClock_;
+    bool isOpen_;
+
+    AudioChunk currentChunk_;
+    AudioRingBuffer audioRing_;
+    uint8_t* currentChunkData_;
     std::shared_ptr<moodycamel::BlockingReaderWriterQueue<AudioChunk>> audioQueue_;
+
+    // Packet framing state, only used by the reactor thread
+    std::vector<uint8_t> packetHeader_;
+    int packetHeaderIndex_;
+    int packetAudioIndex_;
+    unsigned long long packetTimestamp_;
+    std::size_t chunkIndex_;
+    int droppedChunkCount_;
 };
 
 }    // namespace Model
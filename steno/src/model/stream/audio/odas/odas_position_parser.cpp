@@ -0,0 +1,338 @@
+#include "odas_position_parser.h"
+
+#include <cstring>
+
+namespace Model
+{
+namespace
+{
+const int MAX_TRACKED_DEPTH = 32;
+
+// Levels of the message: 1 is the message object, 2 the src array and 3 its sources
+const int SOURCES_ARRAY_DEPTH = 2;
+const int SOURCE_OBJECT_DEPTH = 3;
+
+bool isKey(const char* key, std::size_t length, const char* expected)
+{
+    return length == std::strlen(expected) && std::memcmp(key, expected, length) == 0;
+}
+
+/**
+ * @brief Parse a JSON number without strtof, which depends on the locale Qt sets (e.g. "0,5" in french).
+ * @return value of the number, 0 if it is not a valid number.
+ */
+float parseNumber(const char* text, std::size_t length)
+{
+    std::size_t i = 0;
+    bool isNegative = i < length && text[i] == '-';
+    i += isNegative ? 1 : 0;
+
+    double value = 0;
+    std::size_t digitCount = 0;
+    for (; i < length && text[i] >= '0' && text[i] <= '9'; ++i, ++digitCount)
+    {
+        value = value * 10 + (text[i] - '0');
+    }
+
+    if (i < length && text[i] == '.')
+    {
+        double scale = 0.1;
+        for (++i; i < length && text[i] >= '0' && text[i] <= '9'; ++i, ++digitCount, scale *= 0.1)
+        {
+            value += (text[i] - '0') * scale;
+        }
+    }
+
+    if (i < length && (text[i] == 'e' || text[i] == 'E'))
+    {
+        ++i;
+        bool isExponentNegative = i < length && text[i] == '-';
+        i += i < length && (text[i] == '-' || text[i] == '+') ? 1 : 0;
+
+        int exponent = 0;
+        for (; i < length && text[i] >= '0' && text[i] <= '9' && exponent < 100; ++i)
+        {
+            exponent = exponent * 10 + (text[i] - '0');
+        }
+
+        for (; exponent > 0; --exponent)
+        {
+            value = isExponentNegative ? value / 10 : value * 10;
+        }
+    }
+
+    if (i != length || digitCount == 0)
+    {
+        return 0.f;
+    }
+
+    return static_cast<float>(isNegative ? -value : value);
+}
+
+}    // namespace
+
+OdasPositionParser::OdasPositionParser()
+{
+    reset();
+}
+
+/**
+ * @brief Consume bytes until the end of a message or of the data.
+ * @return number of bytes consumed, check isMessageComplete to know if a message ended there.
+ */
+std::size_t OdasPositionParser::parse(const char* data, std::size_t size)
+{
+    isMessageComplete_ = false;
+
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        char c = data[i];
+
+        if (isInString_)
+        {
+            if (isEscaped_)
+            {
+                isEscaped_ = false;
+            }
+            else if (c == '\\')
+            {
+                isEscaped_ = true;
+            }
+            else if (c == '"')
+            {
+                isInString_ = false;
+                if (isKey_)
+                {
+                    endKey();
+                }
+            }
+            else if (isKey_)
+            {
+                appendToken(c);
+            }
+            continue;
+        }
+
+        if (depth_ == 0)
+        {
+            // Ignore the separators between messages
+            if (c == '{')
+            {
+                sources_.count = 0;
+                beginContainer(true);
+            }
+            continue;
+        }
+
+        switch (c)
+        {
+            case '"':
+                isInString_ = true;
+                isKey_ = isExpectingKey_;
+                clearToken();
+                break;
+            case '{':
+            case '[':
+                beginContainer(c == '{');
+                break;
+            case '}':
+            case ']':
+                endNumber();
+                endContainer();
+                if (depth_ == 0)
+                {
+                    isMessageComplete_ = true;
+                    return i + 1;
+                }
+                break;
+            case ':':
+                isExpectingKey_ = false;
+                clearToken();
+                break;
+            case ',':
+                endNumber();
+                isExpectingKey_ = depth_ <= MAX_TRACKED_DEPTH && (objectLevels_ >> (depth_ - 1) & 1u) != 0;
+                field_ = isExpectingKey_ ? Field::NONE : field_;
+                break;
+            case ' ':
+            case '\t':
+            case '\r':
+            case '\n':
+                endNumber();
+                break;
+            default:
+                // Numbers and literals, only the numbers of the fields we want are kept
+                if (field_ != Field::NONE && field_ != Field::SOURCES)
+                {
+                    appendToken(c);
+                }
+                break;
+        }
+    }
+
+    return size;
+}
+
+bool OdasPositionParser::isMessageComplete() const
+{
+    return isMessageComplete_;
+}
+
+/**
+ * @brief Sources of the last complete message, valid until the next call to parse.
+ */
+const OdasSourceCoordinates& OdasPositionParser::getSources() const
+{
+    return sources_;
+}
+
+/**
+ * @brief Drop the partial message, e.g. when the connection was lost.
+ */
+void OdasPositionParser::reset()
+{
+    sources_.count = 0;
+    isMessageComplete_ = false;
+    depth_ = 0;
+    objectLevels_ = 0;
+    isInString_ = false;
+    isEscaped_ = false;
+    isKey_ = false;
+    isExpectingKey_ = false;
+    isInSourcesArray_ = false;
+    isInSourceObject_ = false;
+    field_ = Field::NONE;
+    clearToken();
+}
+
+void OdasPositionParser::beginContainer(bool isObject)
+{
+    ++depth_;
+
+    if (depth_ <= MAX_TRACKED_DEPTH)
+    {
+        uint32_t levelBit = 1u << (depth_ - 1);
+        objectLevels_ = isObject ? objectLevels_ | levelBit : objectLevels_ & ~levelBit;
+    }
+
+    if (depth_ == SOURCES_ARRAY_DEPTH)
+    {
+        isInSourcesArray_ = !isObject && field_ == Field::SOURCES;
+    }
+    else if (depth_ == SOURCE_OBJECT_DEPTH && isObject && isInSourcesArray_ &&
+             sources_.count < sources_.x.size())
+    {
+        std::size_t index = sources_.count++;
+        sources_.x[index] = 0.f;
+        sources_.y[index] = 0.f;
+        sources_.z[index] = 0.f;
+        sources_.activity[index] = 0.f;
+        isInSourceObject_ = true;
+    }
+
+    isExpectingKey_ = isObject;
+    field_ = Field::NONE;
+    clearToken();
+}
+
+void OdasPositionParser::endContainer()
+{
+    if (depth_ == SOURCE_OBJECT_DEPTH)
+    {
+        isInSourceObject_ = false;
+    }
+    else if (depth_ == SOURCES_ARRAY_DEPTH)
+    {
+        isInSourcesArray_ = false;
+    }
+
+    --depth_;
+    isExpectingKey_ = false;
+    field_ = Field::NONE;
+}
+
+void OdasPositionParser::endKey()
+{
+    field_ = Field::NONE;
+
+    if (depth_ == SOURCES_ARRAY_DEPTH - 1 && isKey(token_.data(), tokenLength_, "src"))
+    {
+        field_ = Field::SOURCES;
+    }
+    else if (depth_ == SOURCE_OBJECT_DEPTH && isInSourceObject_)
+    {
+        if (isKey(token_.data(), tokenLength_, "x"))
+        {
+            field_ = Field::X;
+        }
+        else if (isKey(token_.data(), tokenLength_, "y"))
+        {
+            field_ = Field::Y;
+        }
+        else if (isKey(token_.data(), tokenLength_, "z"))
+        {
+            field_ = Field::Z;
+        }
+        else if (isKey(token_.data(), tokenLength_, "activity"))
+        {
+            field_ = Field::ACTIVITY;
+        }
+    }
+
+    clearToken();
+}
+
+void OdasPositionParser::endNumber()
+{
+    float* value = getFieldValue();
+    if (value != nullptr && tokenLength_ > 0)
+    {
+        // The start of a longer number would give another value, the field keeps its default instead
+        if (!isTokenTruncated_)
+        {
+            *value = parseNumber(token_.data(), tokenLength_);
+        }
+        field_ = Field::NONE;
+    }
+
+    clearToken();
+}
+
+void OdasPositionParser::appendToken(char c)
+{
+    if (tokenLength_ < token_.size())
+    {
+        token_[tokenLength_++] = c;
+    }
+    else
+    {
+        isTokenTruncated_ = true;
+    }
+}
+
+void OdasPositionParser::clearToken()
+{
+    tokenLength_ = 0;
+    isTokenTruncated_ = false;
+}
+
+float* OdasPositionParser::getFieldValue()
+{
+    std::size_t index = sources_.count - 1;
+
+    switch (field_)
+    {
+        case Field::X:
+            return &sources_.x[index];
+        case Field::Y:
+            return &sources_.y[index];
+        case Field::Z:
+            return &sources_.z[index];
+        case Field::ACTIVITY:
+            return &sources_.activity[index];
+        default:
+            return nullptr;
+    }
+}
+
+}    // namespace Model
@@ -0,0 +1,83 @@
+#ifndef ODAS_POSITION_PARSER_H
+#define ODAS_POSITION_PARSER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "model/stream/audio/source_positions.h"
+
+namespace Model
+{
+/**
+ * @brief Cartesian coordinates of the sources of one odas message, stored by component so they can be converted
+ * to spherical angles in a batch.
+ */
+struct OdasSourceCoordinates
+{
+    std::array<float, MAX_SOURCE_POSITIONS> x;
+    std::array<float, MAX_SOURCE_POSITIONS> y;
+    std::array<float, MAX_SOURCE_POSITIONS> z;
+    std::array<float, MAX_SOURCE_POSITIONS> activity;
+    std::size_t count = 0;
+};
+
+/**
+ * @brief Streaming tokenizer for the JSON messages odas sends on its tracked sources socket:
+ * {"timeStamp": 42, "src": [{"id": 1, "tag": "dynamic", "x": 0.5, "y": 0.2, "z": 0.8, "activity": 0.9}, ...]}
+ * Bytes can be fed in pieces of any size, a message split across reads continues where the last read stopped and
+ * several messages in a read are returned one by one. Only src[].x/y/z/activity are extracted, nothing is buffered
+ * or allocated.
+ */
+class OdasPositionParser
+{
+   public:
+    OdasPositionParser();
+
+    std::size_t parse(const char* data, std::size_t size);
+    bool isMessageComplete() const;
+    const OdasSourceCoordinates& getSources() const;
+    void reset();
+
+   private:
+    enum class Field
+    {
+        NONE,
+        SOURCES,
+        X,
+        Y,
+        Z,
+        ACTIVITY
+    };
+
+    void beginContainer(bool isObject);
+    void endContainer();
+    void endKey();
+    void endNumber();
+    void appendToken(char c);
+    void clearToken();
+    float* getFieldValue();
+
+    OdasSourceCoordinates sources_;
+    bool isMessageComplete_;
+
+    int depth_;
+    uint32_t objectLevels_;    // Bit set for each nesting level that is an object, arrays otherwise
+    bool isInString_;
+    bool isEscaped_;
+    bool isKey_;
+    bool isExpectingKey_;
+    bool isInSourcesArray_;
+    bool isInSourceObject_;
+    Field field_;
+
+    // Current key and number, bigger ones than we care about are truncated and ignored: a truncated key matches no
+    // field and a truncated number is not parsed
+    std::array<char, 16> token_;
+    std::size_t tokenLength_;
+    bool isTokenTruncated_;
+};
+
+}    // namespace Model
+
+#endif    //! ODAS_POSITION_PARSER_H
@@ -1,118 +1,128 @@
 #include "odas_position_source.h"
 
-#include <QDebug>
-#include <QJsonArray>
-#include <QJsonDocument>
-#include <QMutexLocker>
-#include <QTcpServer>
-#include <QTcpSocket>
+#include <iostream>
+#include <stdexcept>
 
-#include "model/stream/audio/source_position.h"
+#include "model/stream/utils/math/angle_calculations.h"
+#include "model/stream/utils/time/media_clock.h"
 
 namespace
 {
+// Also the biggest message of the shared memory transport
 const int POSITION_SOURCE_BUFFER_SIZE = 10000;
 }
 
 namespace Model
 {
-OdasPositionSource::OdasPositionSource(int port)
-    : m_port(port)
+OdasPositionSource::OdasPositionSource(const OdasEndpoint& endpoint, std::shared_ptr<OdasSocketReactor> reactor)
+    : m_reactor(reactor)
+    , m_isOpen(false)
+    , m_buffer(POSITION_SOURCE_BUFFER_SIZE)
 {
+    if (!m_reactor)
+    {
+        throw std::invalid_argument("Error in OdasPositionSource - Null is not a valid reactor");
+    }
+
+    m_reactor->addListener(endpoint, m_buffer.size(), this);
 }
 
 OdasPositionSource::~OdasPositionSource()
 {
     close();
+    m_reactor->removeListener(this);
 }
 
 void OdasPositionSource::open()
 {
-    start();
+    if (!m_isOpen)
+    {
+        m_reactor->open();
+        m_isOpen = true;
+    }
 }
 
 void OdasPositionSource::close()
 {
-    requestInterruption();
+    if (m_isOpen)
+    {
+        m_reactor->close();
+        m_isOpen = false;
+    }
 }
 
-void OdasPositionSource::run()
+std::size_t OdasPositionSource::getReceiveBuffer(uint8_t*& outBuffer)
 {
-    QTcpSocket* socket = nullptr;
-
-    std::unique_ptr<QTcpServer> server = std::make_unique<QTcpServer>();
-    server->setMaxPendingConnections(1);
-    server->listen(QHostAddress::Any, m_port);
-
-    qDebug() << "Odas position source thread started";
+    // The parser keeps the state of a partial message, the buffer is always free once parsed
+    outBuffer = m_buffer.data();
+    return m_buffer.size();
+}
 
-    char buffer[POSITION_SOURCE_BUFFER_SIZE];
+/**
+ * @brief Odas sends one JSON object per update, a read can hold many of them or only a part of one.
+ */
+void OdasPositionSource::onReceived(std::size_t byteCount)
+{
+    const char* data = reinterpret_cast<const char*>(m_buffer.data());
 
-    while (!isInterruptionRequested())
+    while (byteCount > 0)
     {
-        if (socket == nullptr)
-        {
-            if (server->waitForNewConnection(1))
-            {
-                socket = server->nextPendingConnection();
-            }
-        }
-        else
+        std::size_t parsedCount = m_parser.parse(data, byteCount);
+        data += parsedCount;
+        byteCount -= parsedCount;
+
+        if (m_parser.isMessageComplete())
         {
-            if (socket->state() == QAbstractSocket::ConnectedState)
-            {
-                if (socket->bytesAvailable() > 0)
-                {
-                    int bytes = socket->bytesAvailable();
-                    int bytesRead = socket->read(buffer, bytes);
-
-                    std::vector<SourcePosition> sourcePositions;
-
-                    QByteArray byteArray = QByteArray::fromRawData(buffer, bytesRead);
-                    QJsonDocument json = QJsonDocument::fromJson(byteArray);
-                    if (!json.isNull())
-                    {
-                        QJsonValue odasSources = json["src"];
-                        if (odasSources != QJsonValue::Undefined)
-                        {
-                            QJsonArray odasSourcesArray = odasSources.toArray();
-                            for (auto it = odasSourcesArray.begin(); it < odasSourcesArray.end(); it++)
-                            {
-                                SourcePosition source = SourcePosition::deserialize(*it);
-                                sourcePositions.push_back(source);
-                            }
-                        }
-                    }
-
-                    updatePositions(sourcePositions);
-                }
-                else
-                {
-                    socket->waitForReadyRead(1);
-                }
-            }
-            else
-            {
-                // reset read
-                delete socket;
-                socket = nullptr;
-            }
+            updatePositions(m_parser.getSources());
         }
     }
+}
 
-    qDebug() << "Odas position source thread stopped";
+void OdasPositionSource::onConnected()
+{
+    m_parser.reset();
+    std::cout << "Odas position source connected" << std::endl;
 }
 
-std::vector<SourcePosition> OdasPositionSource::getPositions()
+void OdasPositionSource::onDisconnected()
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    return m_sourcePositions;
+    m_parser.reset();
+    std::cout << "Odas position source disconnected" << std::endl;
 }
 
-void OdasPositionSource::updatePositions(std::vector<SourcePosition>& positions)
+/**
+ * @brief Copy the last published positions without locking or allocating.
+ * @return positions with their publish timestamp and sequence number.
+ */
+SourcePositions OdasPositionSource::getPositions()
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_sourcePositions = positions;
+    return m_positionHistory.getLatest();
+}
+
+/**
+ * @brief Copy the positions that were current at a media timestamp, without locking or allocating.
+ * @param [IN] timestamp - time on the media timeline, e.g. of an audio chunk or an image.
+ */
+SourcePositions OdasPositionSource::getPositionsAt(uint64_t timestamp)
+{
+    return m_positionHistory.getAt(timestamp);
+}
+
+void OdasPositionSource::updatePositions(const OdasSourceCoordinates& sources)
+{
+    std::array<float, MAX_SOURCE_POSITIONS> azimuths;
+    std::array<float, MAX_SOURCE_POSITIONS> elevations;
+    math::getSphericalAnglesFromPositions(sources.x.data(), sources.y.data(), sources.z.data(), sources.count,
+                                          azimuths.data(), elevations.data());
+
+    SourcePositions positions;
+    for (std::size_t i = 0; i < sources.count; ++i)
+    {
+        positions.push(SourcePosition(azimuths[i], elevations[i], sources.activity[i]));
+    }
+
+    positions.timestamp = MediaClock::now();
+    m_positionHistory.push(positions);
 }
 
 }    // namespace Model
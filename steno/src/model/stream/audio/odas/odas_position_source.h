@@ -2,33 +2,41 @@
 #define ODAS_POSITION_SOURCE_H
 
 #include <memory>
-#include <mutex>
-
-#include <QThread>
+#include <vector>
 
 #include "model/stream/audio/i_position_source.h"
-
-class QMutex;
+#include "model/stream/audio/odas/odas_position_parser.h"
+#include "model/stream/audio/odas/odas_socket_reactor.h"
+#include "model/stream/audio/source_position_history.h"
 
 namespace Model
 {
-class OdasPositionSource : public QThread, public IPositionSource
+class OdasPositionSource : public IPositionSource, public IOdasSocketHandler
 {
    public:
-    OdasPositionSource(int port);
+    OdasPositionSource(const OdasEndpoint& endpoint, std::shared_ptr<OdasSocketReactor> reactor);
     ~OdasPositionSource() override;
 
     void open() override;
     void close() override;
-    std::vector<SourcePosition> getPositions() override;
+    SourcePositions getPositions() override;
+    SourcePositions getPositionsAt(uint64_t timestamp) override;
+
+    std::size_t getReceiveBuffer(uint8_t*& outBuffer) override;
+    void onReceived(std::size_t byteCount) override;
+    void onConnected() override;
+    void onDisconnected() override;
 
    private:
-    void run() override;
-    void updatePositions(std::vector<SourcePosition>& sourcePositions);
+    void updatePositions(const OdasSourceCoordinates& sources);
+
+    std::shared_ptr<OdasSocketReactor> m_reactor;
+    bool m_isOpen;
+    SourcePositionHistory m_positionHistory;
 
-    int m_port;
-    std::vector<SourcePosition> m_sourcePositions;
-    std::mutex m_mutex;
+    // Only used by the reactor thread
+    std::vector<uint8_t> m_buffer;
+    OdasPositionParser m_parser;
 };
 
 }    // namespace Model
@@ -0,0 +1,93 @@
+#ifndef ODAS_SHM_FORMAT_H
+#define ODAS_SHM_FORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Shared memory transport between odaslive (producer) and steno (consumer), version 1.
+ *
+ * Connection
+ *  - Steno listens on a unix stream socket, one per stream (audio and positions).
+ *  - When the producer connects, steno creates the ring in a sealed memfd and an eventfd. It sends both descriptors
+ *    with SCM_RIGHTS along with an OdasShmHandshake, in that order [memfd, eventfd].
+ *  - The producer maps the memfd (its size is in the handshake) and checks the magic and version of the header.
+ *  - The connection stays open for the lifetime of the stream, closing it disconnects. A new connection replaces the
+ *    previous one with a new ring.
+ *
+ * Ring
+ *  - An OdasShmRingHeader followed by slotCount slots. Each slot is an OdasShmSlotHeader followed by slotSize bytes
+ *    of payload, slots start every getOdasShmSlotStride(slotSize) bytes.
+ *  - The payload of a slot is exactly what the producer would send on the socket interface for one message: an
+ *    audio packet (header and samples) for the audio stream, a JSON message for the positions stream.
+ *  - writeIndex and readIndex count messages since the ring was created, they are never wrapped. The slot of a
+ *    message is index % slotCount.
+ *
+ * Producer, for each message
+ *  1. If writeIndex - readIndex (acquire) == slotCount, the ring is full: increment droppedCount and drop the message.
+ *  2. Write the payload and its size in the slot of writeIndex.
+ *  3. Store writeIndex + 1 (release).
+ *  4. Write 1 to the eventfd to wake the consumer.
+ *
+ * Consumer
+ *  - On an eventfd notification, read every message from readIndex to writeIndex (acquire) and store the new
+ *    readIndex (release) after each message.
+ *
+ * Every field is in the native byte order, indexes are accessed with atomic 64 bits loads and stores.
+ *
+ * tools/odas_shm_producer is a stand-in producer publishing synthetic audio and positions.
+ */
+namespace Model
+{
+const uint32_t ODAS_SHM_MAGIC = 0x4853444F;    // "ODSH"
+const uint32_t ODAS_SHM_VERSION = 1;
+const std::size_t ODAS_SHM_ALIGNMENT = 64;
+
+struct OdasShmHandshake
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t memorySize;
+};
+
+struct OdasShmRingHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t slotSize;
+    uint64_t droppedCount;    // Written by the producer only
+    uint8_t reserved0[40];
+
+    // Each index is on its own cache line, only the producer writes writeIndex and only the consumer readIndex
+    uint64_t writeIndex;
+    uint8_t reserved1[56];
+    uint64_t readIndex;
+    uint8_t reserved2[56];
+};
+
+struct OdasShmSlotHeader
+{
+    uint32_t size;    // Payload size in bytes, at most slotSize
+    uint32_t reserved;
+};
+
+static_assert(sizeof(OdasShmRingHeader) == 3 * ODAS_SHM_ALIGNMENT, "Unexpected OdasShmRingHeader layout");
+static_assert(offsetof(OdasShmRingHeader, writeIndex) == ODAS_SHM_ALIGNMENT, "Unexpected writeIndex offset");
+static_assert(offsetof(OdasShmRingHeader, readIndex) == 2 * ODAS_SHM_ALIGNMENT, "Unexpected readIndex offset");
+static_assert(sizeof(OdasShmSlotHeader) == 8, "Unexpected OdasShmSlotHeader layout");
+
+inline std::size_t getOdasShmSlotStride(std::size_t slotSize)
+{
+    std::size_t size = sizeof(OdasShmSlotHeader) + slotSize;
+    return (size + ODAS_SHM_ALIGNMENT - 1) / ODAS_SHM_ALIGNMENT * ODAS_SHM_ALIGNMENT;
+}
+
+inline std::size_t getOdasShmMemorySize(std::size_t slotSize, std::size_t slotCount)
+{
+    return sizeof(OdasShmRingHeader) + slotCount * getOdasShmSlotStride(slotSize);
+}
+
+}    // namespace Model
+
+#endif    //! ODAS_SHM_FORMAT_H
@@ -0,0 +1,590 @@
+#include "odas_socket_reactor.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include "model/stream/audio/odas/odas_shm_format.h"
+
+namespace Model
+{
+namespace
+{
+const int MAX_EPOLL_EVENTS = 8;
+const int EPOLL_TIMEOUT_MS = 50;    // Only bounds the time to notice a stop request
+
+// Messages the producer can get ahead of the reactor before dropping
+const std::size_t SHM_SLOT_COUNT = 32;
+
+enum class EventKind
+{
+    LISTEN = 0,
+    CLIENT = 1,
+    SHM_EVENT = 2
+};
+
+// Epoll event data holds the descriptor, the listener index and which descriptor of the listener it is
+uint64_t getEventData(int fd, std::size_t listenerIndex, EventKind kind)
+{
+    return (static_cast<uint64_t>(fd) << 32) | (static_cast<uint64_t>(listenerIndex) << 2) |
+           static_cast<uint64_t>(kind);
+}
+
+int getEventFd(uint64_t eventData)
+{
+    return static_cast<int>(eventData >> 32);
+}
+
+std::size_t getEventListenerIndex(uint64_t eventData)
+{
+    return static_cast<std::size_t>((eventData & 0xFFFFFFFF) >> 2);
+}
+
+EventKind getEventKind(uint64_t eventData)
+{
+    return static_cast<EventKind>(eventData & 3);
+}
+
+std::string getEndpointName(const OdasEndpoint& endpoint)
+{
+    if (endpoint.transport == OdasEndpoint::Transport::TCP)
+    {
+        return "port " + std::to_string(endpoint.port);
+    }
+    return "socket " + endpoint.socketPath;
+}
+
+/**
+ * @brief Lock the socket path for this process, the lock is released when the descriptor is closed or the process
+ * ends.
+ * @return descriptor of the lock file, -1 if another process holds the lock.
+ */
+int lockSocketPath(const std::string& socketPath)
+{
+    int lockFd = open((socketPath + ".lock").c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (lockFd >= 0 && flock(lockFd, LOCK_EX | LOCK_NB) < 0)
+    {
+        ::close(lockFd);
+        lockFd = -1;
+    }
+    return lockFd;
+}
+
+bool sendSharedMemory(int socketFd, int memoryFd, int eventFd, uint64_t memorySize)
+{
+    OdasShmHandshake handshake = {ODAS_SHM_MAGIC, ODAS_SHM_VERSION, memorySize};
+    iovec data = {&handshake, sizeof(handshake)};
+
+    int fds[2] = {memoryFd, eventFd};
+    char control[CMSG_SPACE(sizeof(fds))] = {};
+
+    msghdr message = {};
+    message.msg_iov = &data;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+
+    cmsghdr* controlMessage = CMSG_FIRSTHDR(&message);
+    controlMessage->cmsg_level = SOL_SOCKET;
+    controlMessage->cmsg_type = SCM_RIGHTS;
+    controlMessage->cmsg_len = CMSG_LEN(sizeof(fds));
+    std::memcpy(CMSG_DATA(controlMessage), fds, sizeof(fds));
+
+    // The socket was just accepted, its send buffer can't be full
+    return sendmsg(socketFd, &message, MSG_NOSIGNAL) == static_cast<ssize_t>(sizeof(handshake));
+}
+
+}    // namespace
+
+OdasSocketReactor::OdasSocketReactor()
+    : Thread()
+    , openCount_(0)
+{
+}
+
+OdasSocketReactor::~OdasSocketReactor()
+{
+    stop();
+    join();
+}
+
+/**
+ * @brief Listen on an endpoint and forward its connection to a handler, only possible while the reactor is closed.
+ * @param maxMessageSize - largest message of the stream, sizes the shared memory slots.
+ */
+void OdasSocketReactor::addListener(const OdasEndpoint& endpoint, std::size_t maxMessageSize,
+                                    IOdasSocketHandler* handler)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (handler == nullptr)
+    {
+        throw std::invalid_argument("Error in OdasSocketReactor - Null is not a valid handler");
+    }
+
+    if (endpoint.transport == OdasEndpoint::Transport::SHARED_MEMORY &&
+        (maxMessageSize == 0 || endpoint.socketPath.size() >= sizeof(sockaddr_un::sun_path)))
+    {
+        throw std::invalid_argument("Error in OdasSocketReactor - Invalid shared memory endpoint");
+    }
+
+    if (openCount_ > 0)
+    {
+        throw std::logic_error("Error in OdasSocketReactor - Listeners can't be added while the reactor is open");
+    }
+
+    listeners_.push_back({endpoint, maxMessageSize, handler, -1, -1, -1, -1, nullptr, 0});
+}
+
+void OdasSocketReactor::removeListener(IOdasSocketHandler* handler)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (openCount_ > 0)
+    {
+        throw std::logic_error("Error in OdasSocketReactor - Listeners can't be removed while the reactor is open");
+    }
+
+    listeners_.erase(std::remove_if(listeners_.begin(), listeners_.end(),
+                                    [handler](const Listener& listener) { return listener.handler == handler; }),
+                     listeners_.end());
+}
+
+/**
+ * @brief Start the reactor thread on the first open, every open must be matched by a close.
+ */
+void OdasSocketReactor::open()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (openCount_++ == 0)
+    {
+        start();
+    }
+}
+
+/**
+ * @brief Stop the reactor thread on the last close, sockets are closed with it.
+ */
+void OdasSocketReactor::close()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (openCount_ > 0 && --openCount_ == 0)
+    {
+        stop();
+        join();
+    }
+}
+
+void OdasSocketReactor::run()
+{
+    int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0)
+    {
+        throw std::runtime_error("Error in OdasSocketReactor - epoll_create1 failed : " +
+                                 std::string(std::strerror(errno)));
+    }
+
+    for (std::size_t i = 0; i < listeners_.size(); ++i)
+    {
+        Listener& listener = listeners_[i];
+        if (openListener(listener))
+        {
+            epoll_event event = {};
+            event.events = EPOLLIN | EPOLLET;
+            event.data.u64 = getEventData(listener.listenFd, i, EventKind::LISTEN);
+            epoll_ctl(epollFd, EPOLL_CTL_ADD, listener.listenFd, &event);
+        }
+    }
+
+    std::cout << "Odas socket reactor started" << std::endl;
+
+    epoll_event events[MAX_EPOLL_EVENTS];
+    while (!isAbortRequested())
+    {
+        int eventCount = epoll_wait(epollFd, events, MAX_EPOLL_EVENTS, EPOLL_TIMEOUT_MS);
+        if (eventCount < 0 && errno != EINTR)
+        {
+            std::cout << "Error in OdasSocketReactor - epoll_wait failed : " << std::strerror(errno) << std::endl;
+            break;
+        }
+
+        for (int i = 0; i < eventCount; ++i)
+        {
+            uint64_t eventData = events[i].data.u64;
+            Listener& listener = listeners_[getEventListenerIndex(eventData)];
+
+            // The descriptor checks skip events of a connection replaced earlier in this batch
+            switch (getEventKind(eventData))
+            {
+                case EventKind::LISTEN:
+                    acceptConnections(epollFd, listener);
+                    break;
+                case EventKind::CLIENT:
+                    if (listener.clientFd >= 0 && listener.clientFd == getEventFd(eventData))
+                    {
+                        // Read what is left before handling a hang up, the last packets are still valid
+                        receive(listener);
+                        if (listener.clientFd >= 0 && (events[i].events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0)
+                        {
+                            disconnect(listener);
+                        }
+                    }
+                    break;
+                case EventKind::SHM_EVENT:
+                    if (listener.eventFd >= 0 && listener.eventFd == getEventFd(eventData))
+                    {
+                        receiveSharedMemory(listener);
+                    }
+                    break;
+            }
+        }
+    }
+
+    for (Listener& listener : listeners_)
+    {
+        closeListener(listener);
+    }
+    ::close(epollFd);
+
+    std::cout << "Odas socket reactor stopped" << std::endl;
+}
+
+bool OdasSocketReactor::openListener(Listener& listener)
+{
+    const OdasEndpoint& endpoint = listener.endpoint;
+    bool isTcp = endpoint.transport == OdasEndpoint::Transport::TCP;
+
+    listener.listenFd = socket(isTcp ? AF_INET : AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listener.listenFd < 0)
+    {
+        std::cout << "Error in OdasSocketReactor - socket failed : " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    int result = 0;
+    if (isTcp)
+    {
+        // Odaslive can be restarted right away, don't wait for the previous connection to time out
+        int reuseAddress = 1;
+        setsockopt(listener.listenFd, SOL_SOCKET, SO_REUSEADDR, &reuseAddress, sizeof(reuseAddress));
+
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+        address.sin_port = htons(static_cast<uint16_t>(endpoint.port));
+        result = bind(listener.listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    }
+    else
+    {
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, endpoint.socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+        // A socket file left by a previous run would make bind fail, it is only removed when no other instance
+        // holds the lock of the path
+        listener.lockFd = lockSocketPath(endpoint.socketPath);
+        if (listener.lockFd < 0)
+        {
+            std::cout << "Error in OdasSocketReactor - " << getEndpointName(endpoint)
+                      << " is already used by another process" << std::endl;
+            ::close(listener.listenFd);
+            listener.listenFd = -1;
+            return false;
+        }
+        unlink(endpoint.socketPath.c_str());
+
+        result = bind(listener.listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    }
+
+    if (result < 0 || listen(listener.listenFd, 1) < 0)
+    {
+        std::cout << "Error in OdasSocketReactor - can't listen on " << getEndpointName(endpoint) << " : "
+                  << std::strerror(errno) << std::endl;
+        ::close(listener.listenFd);
+        listener.listenFd = -1;
+        return false;
+    }
+
+    return true;
+}
+
+void OdasSocketReactor::acceptConnections(int epollFd, Listener& listener)
+{
+    std::size_t listenerIndex = &listener - listeners_.data();
+
+    while (true)
+    {
+        int clientFd = accept4(listener.listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (clientFd < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+            {
+                continue;
+            }
+            break;    // EAGAIN, every pending connection was accepted
+        }
+
+        // Odaslive was restarted, the new connection replaces the old one
+        if (listener.clientFd >= 0)
+        {
+            disconnect(listener);
+        }
+
+        epoll_event event = {};
+        event.events = EPOLLIN | EPOLLRDHUP | EPOLLET;
+        event.data.u64 = getEventData(clientFd, listenerIndex, EventKind::CLIENT);
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, clientFd, &event);
+
+        listener.clientFd = clientFd;
+
+        bool isSharedMemory = listener.endpoint.transport == OdasEndpoint::Transport::SHARED_MEMORY;
+        if (isSharedMemory && !openSharedMemory(epollFd, listener))
+        {
+            ::close(listener.clientFd);
+            listener.clientFd = -1;
+            continue;
+        }
+
+        listener.handler->onConnected();
+
+        // Data may have arrived before the socket was added to the epoll set
+        receive(listener);
+    }
+}
+
+/**
+ * @brief Create the ring of a new shared memory connection and hand it to the producer.
+ */
+bool OdasSocketReactor::openSharedMemory(int epollFd, Listener& listener)
+{
+    std::size_t memorySize = getOdasShmMemorySize(listener.maxMessageSize, SHM_SLOT_COUNT);
+
+    int memoryFd = memfd_create("odas-shm-ring", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (memoryFd < 0 || ftruncate(memoryFd, static_cast<off_t>(memorySize)) < 0)
+    {
+        std::cout << "Error in OdasSocketReactor - can't create the shared memory of "
+                  << getEndpointName(listener.endpoint) << " : " << std::strerror(errno) << std::endl;
+        if (memoryFd >= 0)
+        {
+            ::close(memoryFd);
+        }
+        return false;
+    }
+
+    // The producer can't resize the memory under the reactor
+    fcntl(memoryFd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL);
+
+    void* ring = mmap(nullptr, memorySize, PROT_READ | PROT_WRITE, MAP_SHARED, memoryFd, 0);
+    int eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (ring == MAP_FAILED || eventFd < 0)
+    {
+        std::cout << "Error in OdasSocketReactor - can't map the shared memory of "
+                  << getEndpointName(listener.endpoint) << " : " << std::strerror(errno) << std::endl;
+        if (ring != MAP_FAILED)
+        {
+            munmap(ring, memorySize);
+        }
+        if (eventFd >= 0)
+        {
+            ::close(eventFd);
+        }
+        ::close(memoryFd);
+        return false;
+    }
+
+    // The memory is zero filled, only the layout needs to be written
+    OdasShmRingHeader* header = static_cast<OdasShmRingHeader*>(ring);
+    header->magic = ODAS_SHM_MAGIC;
+    header->version = ODAS_SHM_VERSION;
+    header->slotCount = static_cast<uint32_t>(SHM_SLOT_COUNT);
+    header->slotSize = static_cast<uint32_t>(listener.maxMessageSize);
+
+    bool isSent = sendSharedMemory(listener.clientFd, memoryFd, eventFd, memorySize);
+
+    // The mapping and the producer keep the memory alive
+    ::close(memoryFd);
+
+    if (!isSent)
+    {
+        std::cout << "Error in OdasSocketReactor - can't send the shared memory on "
+                  << getEndpointName(listener.endpoint) << " : " << std::strerror(errno) << std::endl;
+        munmap(ring, memorySize);
+        ::close(eventFd);
+        return false;
+    }
+
+    epoll_event event = {};
+    event.events = EPOLLIN | EPOLLET;
+    event.data.u64 = getEventData(eventFd, &listener - listeners_.data(), EventKind::SHM_EVENT);
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, eventFd, &event);
+
+    listener.eventFd = eventFd;
+    listener.ring = static_cast<uint8_t*>(ring);
+    listener.ringSize = memorySize;
+
+    return true;
+}
+
+void OdasSocketReactor::receive(Listener& listener)
+{
+    bool isSharedMemory = listener.endpoint.transport == OdasEndpoint::Transport::SHARED_MEMORY;
+
+    while (listener.clientFd >= 0)
+    {
+        // The socket of a shared memory connection carries no data, it is only read to notice a hang up
+        uint8_t discardBuffer[64];
+        uint8_t* buffer = discardBuffer;
+        std::size_t capacity = sizeof(discardBuffer);
+        if (!isSharedMemory)
+        {
+            capacity = listener.handler->getReceiveBuffer(buffer);
+            if (capacity == 0)
+            {
+                break;
+            }
+        }
+
+        ssize_t byteCount = recv(listener.clientFd, buffer, capacity, 0);
+        if (byteCount > 0)
+        {
+            if (!isSharedMemory)
+            {
+                listener.handler->onReceived(static_cast<std::size_t>(byteCount));
+            }
+        }
+        else if (byteCount == 0)
+        {
+            disconnect(listener);
+        }
+        else if (errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            break;
+        }
+        else if (errno != EINTR)
+        {
+            std::cout << "Error in OdasSocketReactor - recv failed on " << getEndpointName(listener.endpoint) << " : "
+                      << std::strerror(errno) << std::endl;
+            disconnect(listener);
+        }
+    }
+}
+
+/**
+ * @brief Deliver every message published in the ring since the last notification.
+ */
+void OdasSocketReactor::receiveSharedMemory(Listener& listener)
+{
+    // Reset the eventfd counter, notifications coming after this read are seen by the next epoll_wait
+    uint64_t notificationCount = 0;
+    while (read(listener.eventFd, &notificationCount, sizeof(notificationCount)) < 0 && errno == EINTR)
+    {
+    }
+
+    OdasShmRingHeader* header = reinterpret_cast<OdasShmRingHeader*>(listener.ring);
+    std::size_t slotStride = getOdasShmSlotStride(header->slotSize);
+    uint8_t* slots = listener.ring + sizeof(OdasShmRingHeader);
+
+    uint64_t readIndex = header->readIndex;
+    uint64_t writeIndex = __atomic_load_n(&header->writeIndex, __ATOMIC_ACQUIRE);
+
+    if (writeIndex - readIndex > header->slotCount)
+    {
+        std::cout << "Error in OdasSocketReactor - the producer on " << getEndpointName(listener.endpoint)
+                  << " overwrote unread messages" << std::endl;
+        disconnect(listener);
+        return;
+    }
+
+    for (; readIndex < writeIndex && listener.ring != nullptr; ++readIndex)
+    {
+        const uint8_t* slot = slots + (readIndex % header->slotCount) * slotStride;
+        const OdasShmSlotHeader* slotHeader = reinterpret_cast<const OdasShmSlotHeader*>(slot);
+        std::size_t size = std::min<std::size_t>(slotHeader->size, header->slotSize);
+
+        deliver(listener, slot + sizeof(OdasShmSlotHeader), size);
+        __atomic_store_n(&header->readIndex, readIndex + 1, __ATOMIC_RELEASE);
+    }
+}
+
+void OdasSocketReactor::deliver(Listener& listener, const uint8_t* data, std::size_t size)
+{
+    while (size > 0)
+    {
+        uint8_t* buffer = nullptr;
+        std::size_t capacity = std::min(size, listener.handler->getReceiveBuffer(buffer));
+        if (capacity == 0)
+        {
+            break;
+        }
+
+        std::memcpy(buffer, data, capacity);
+        listener.handler->onReceived(capacity);
+        data += capacity;
+        size -= capacity;
+    }
+}
+
+void OdasSocketReactor::disconnect(Listener& listener)
+{
+    // Closing a descriptor also removes it from the epoll set
+    ::close(listener.clientFd);
+    listener.clientFd = -1;
+
+    if (listener.eventFd >= 0)
+    {
+        ::close(listener.eventFd);
+        listener.eventFd = -1;
+    }
+
+    if (listener.ring != nullptr)
+    {
+        munmap(listener.ring, listener.ringSize);
+        listener.ring = nullptr;
+        listener.ringSize = 0;
+    }
+
+    listener.handler->onDisconnected();
+}
+
+void OdasSocketReactor::closeListener(Listener& listener)
+{
+    if (listener.clientFd >= 0)
+    {
+        disconnect(listener);
+    }
+
+    if (listener.listenFd >= 0)
+    {
+        ::close(listener.listenFd);
+        listener.listenFd = -1;
+
+        if (listener.endpoint.transport == OdasEndpoint::Transport::SHARED_MEMORY)
+        {
+            unlink(listener.endpoint.socketPath.c_str());
+        }
+    }
+
+    // The lock file stays, removing it would let another instance lock a new file while this one is still locked
+    if (listener.lockFd >= 0)
+    {
+        ::close(listener.lockFd);
+        listener.lockFd = -1;
+    }
+}
+
+}    // namespace Model
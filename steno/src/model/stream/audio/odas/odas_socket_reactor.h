@@ -0,0 +1,113 @@
+#ifndef ODAS_SOCKET_REACTOR_H
+#define ODAS_SOCKET_REACTOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "model/stream/utils/threads/thread.h"
+
+namespace Model
+{
+/**
+ * @brief Receives the data of one ODAS connection. Called from the reactor thread only.
+ */
+class IOdasSocketHandler
+{
+   public:
+    virtual ~IOdasSocketHandler() = default;
+
+    /**
+     * @brief Where the next received bytes must be written. Sockets are edge-triggered, the buffer can't be empty
+     * or the remaining bytes would only be read once more data arrives.
+     * @return capacity of the buffer.
+     */
+    virtual std::size_t getReceiveBuffer(uint8_t*& outBuffer) = 0;
+    virtual void onReceived(std::size_t byteCount) = 0;
+    virtual void onConnected() = 0;
+    virtual void onDisconnected() = 0;
+};
+
+/**
+ * @brief Where odaslive sends a stream. TCP is the default, the shared memory transport needs an odaslive with the
+ * interface described in odas_shm_format.h.
+ */
+struct OdasEndpoint
+{
+    enum class Transport
+    {
+        TCP,
+        SHARED_MEMORY
+    };
+
+    static OdasEndpoint tcp(int port)
+    {
+        return {Transport::TCP, port, std::string()};
+    }
+
+    static OdasEndpoint sharedMemory(const std::string& socketPath)
+    {
+        return {Transport::SHARED_MEMORY, 0, socketPath};
+    }
+
+    Transport transport;
+    int port;                  // TCP listening port
+    std::string socketPath;    // Unix socket where the shared memory is handed to the producer
+};
+
+/**
+ * @brief Single thread owning the ODAS listening sockets. Sockets are non-blocking and edge-triggered in an epoll
+ * set, bytes are received directly in the buffers of the handlers. When odaslive restarts, the new connection
+ * replaces the old one. Shared memory streams are read from their ring when the producer signals their eventfd,
+ * each message is copied once in the buffers of the handler.
+ */
+class OdasSocketReactor : protected Thread
+{
+   public:
+    OdasSocketReactor();
+    ~OdasSocketReactor() override;
+
+    void addListener(const OdasEndpoint& endpoint, std::size_t maxMessageSize, IOdasSocketHandler* handler);
+    void removeListener(IOdasSocketHandler* handler);
+
+    void open();
+    void close();
+
+   protected:
+    void run() override;
+
+   private:
+    struct Listener
+    {
+        OdasEndpoint endpoint;
+        std::size_t maxMessageSize;
+        IOdasSocketHandler* handler;
+        int listenFd;
+        int clientFd;
+        int lockFd;    // Lock of the socket path of a shared memory listener
+
+        // Shared memory connection
+        int eventFd;
+        uint8_t* ring;
+        std::size_t ringSize;
+    };
+
+    bool openListener(Listener& listener);
+    void acceptConnections(int epollFd, Listener& listener);
+    bool openSharedMemory(int epollFd, Listener& listener);
+    void receive(Listener& listener);
+    void receiveSharedMemory(Listener& listener);
+    void deliver(Listener& listener, const uint8_t* data, std::size_t size);
+    void disconnect(Listener& listener);
+    void closeListener(Listener& listener);
+
+    std::mutex mutex_;
+    std::vector<Listener> listeners_;
+    int openCount_;
+};
+
+}    // namespace Model
+
+#endif    //! ODAS_SOCKET_REACTOR_H
@@ -1,39 +1,68 @@
 #include "pulseaudio_sink.h"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
-
-#include <pulse/error.h>
+#include <stdexcept>
 
 namespace
 {
-const int QUEUE_SIZE = 10;
+// The jitter buffer can hold this many times the target latency before dropping the oldest audio
+const int MAX_DEPTH_LATENCY_MULTIPLIER = 4;
+
+// Latency measures are smoothed, they move by a chunk each time one is written or played
+const double LATENCY_SMOOTHING = 0.05;
+const std::chrono::milliseconds LATENCY_CONTROL_INTERVAL(1000);
+
+// Past this error the latency is corrected at once, below it the stream rate is adjusted
+const int64_t HARD_CORRECTION_THRESHOLD_US = 50000;
+const int RATE_PPM_PER_MS = 50;
+const int MAX_RATE_PPM = 2000;    // 0.2%, a pitch change no one can hear
+
+// Chunks are converted once by the mixer, they always hold native endian samples
+pa_sample_format_t getSampleFormat(Model::SampleFormat sampleFormat)
+{
+    switch (sampleFormat)
+    {
+        case Model::SampleFormat::S32:
+            return PA_SAMPLE_S32NE;
+        case Model::SampleFormat::F32:
+            return PA_SAMPLE_FLOAT32NE;
+        case Model::SampleFormat::S16:
+        default:
+            return PA_SAMPLE_S16NE;
+    }
 }
 
+}    // namespace
+
 namespace Model
 {
-PulseAudioSink::PulseAudioSink(std::shared_ptr<AudioConfig> audioConfig)
+/**
+ * @param [IN] audioConfig - format of the chunks and device to play them on.
+ * @param [IN] targetLatencyMs - time from a write to its playout, shared between the jitter buffer and PulseAudio.
+ */
+PulseAudioSink::PulseAudioSink(std::shared_ptr<AudioConfig> audioConfig, int targetLatencyMs)
     : m_deviceName(audioConfig->deviceName)
+    , m_format(AudioFormat::fromConfig(*audioConfig))
+    , m_ss{getSampleFormat(m_format.sampleFormat), static_cast<uint32_t>(m_format.sampleRate),
+           static_cast<uint8_t>(m_format.channels)}
+    , m_targetLatencyUs(targetLatencyMs * 1000)
+    , m_mainloop(nullptr)
+    , m_context(nullptr)
     , m_stream(nullptr)
-    , outputAudioChunk_(QUEUE_SIZE)
+    , m_jitterBuffer(m_format.sampleRate, m_format.getFrameBytes(), m_targetLatencyUs * MAX_DEPTH_LATENCY_MULTIPLIER)
+    , m_isPrimed(false)
+    , m_smoothedLatencyUs(0)
+    , m_streamRate(m_ss.rate)
+    , m_latencyUs(0)
+    , m_rateAdjustmentPpm(0)
+    , m_underflowCount(0)
 {
-    // default format is 16 bits little endian
-    pa_sample_format sampleFormat = PA_SAMPLE_S16LE;
-    switch (audioConfig->formatBytes)
+    if (targetLatencyMs <= 0)
     {
-        case 8:
-            sampleFormat = PA_SAMPLE_U8;
-            break;
-        case 16:
-            sampleFormat = audioConfig->isLittleEndian ? PA_SAMPLE_S16LE : PA_SAMPLE_S16BE;
-            break;
-        case 32:
-            sampleFormat = audioConfig->isLittleEndian ? PA_SAMPLE_S32LE : PA_SAMPLE_S32BE;
-            break;
-        default:
-            break;
+        throw std::invalid_argument("Error in PulseAudioSink - target latency must be greater than 0");
     }
-
-    m_ss = {sampleFormat, static_cast<unsigned int>(audioConfig->rate), static_cast<uint8_t>(audioConfig->channels)};
 }
 
 PulseAudioSink::~PulseAudioSink()
@@ -43,70 +72,277 @@ PulseAudioSink::~PulseAudioSink()
 
 void PulseAudioSink::open()
 {
-    if (m_stream != nullptr)
+    if (m_mainloop != nullptr)
     {
         throw std::runtime_error("pulseaudio stream already initialized");
     }
 
-    // dev of nullptr tells pulsaudio to use the default device
-    const char* dev = nullptr;
-    if (!m_deviceName.empty())
+    m_mainloop = pa_threaded_mainloop_new();
+    m_context = pa_context_new(pa_threaded_mainloop_get_api(m_mainloop), "steno");
+    pa_context_set_state_callback(m_context, &PulseAudioSink::onContextStateChanged, this);
+
+    pa_threaded_mainloop_lock(m_mainloop);
+
+    try
     {
-        dev = m_deviceName.c_str();
+        if (pa_context_connect(m_context, nullptr, PA_CONTEXT_NOFLAGS, nullptr) < 0 ||
+            pa_threaded_mainloop_start(m_mainloop) < 0)
+        {
+            throw std::runtime_error("cannot connect to pulseaudio: " +
+                                     std::string(pa_strerror(pa_context_errno(m_context))));
+        }
+
+        waitForReady();
+    }
+    catch (const std::exception&)
+    {
+        pa_threaded_mainloop_unlock(m_mainloop);
+        close();
+        throw;
     }
 
-    int error;
-    m_stream = pa_simple_new(nullptr, "record", PA_STREAM_PLAYBACK, dev, "record", &m_ss, nullptr, nullptr, &error);
+    pa_threaded_mainloop_unlock(m_mainloop);
+}
 
-    if (m_stream == nullptr)
+void PulseAudioSink::close()
+{
+    if (m_mainloop == nullptr)
+    {
+        return;
+    }
+
+    pa_threaded_mainloop_stop(m_mainloop);
+
+    if (m_stream != nullptr)
     {
-        throw std::runtime_error("cannot initialize pulseaudio stream: " + std::string(pa_strerror(error)));
+        pa_stream_disconnect(m_stream);
+        pa_stream_unref(m_stream);
+        m_stream = nullptr;
     }
 
-    start();
+    pa_context_disconnect(m_context);
+    pa_context_unref(m_context);
+    m_context = nullptr;
+
+    pa_threaded_mainloop_free(m_mainloop);
+    m_mainloop = nullptr;
+    m_isPrimed = false;
+
+    AudioSinkStats stats = getStats();
+    std::cout << "PulseAudio sink closed, " << stats.underflowCount << " underflows, "
+              << stats.jitterBuffer.underrunCount << " jitter buffer underruns, " << stats.jitterBuffer.lateChunkCount
+              << " late chunks, " << stats.jitterBuffer.droppedFrameCount << " frames dropped, "
+              << stats.jitterBuffer.insertedFrameCount << " frames inserted" << std::endl;
 }
 
-void PulseAudioSink::close()
+/**
+ * @brief Queue a chunk for playout, playback starts once the jitter buffer holds its part of the target latency.
+ */
+int PulseAudioSink::write(const AudioChunk& audioChunk)
 {
-    stop();
-    join();
+    m_jitterBuffer.push(audioChunk);
 
-    if (m_stream == nullptr)
+    if (!m_isPrimed && m_mainloop != nullptr && m_jitterBuffer.getDepthUs() >= m_targetLatencyUs / 2)
     {
-        return;
+        // PulseAudio already asked for data, it won't ask again until it gets some
+        pa_threaded_mainloop_lock(m_mainloop);
+        m_isPrimed = true;
+        m_lastControlTime = std::chrono::steady_clock::now();
+        fillStream(pa_stream_writable_size(m_stream));
+        pa_threaded_mainloop_unlock(m_mainloop);
     }
 
-    pa_simple_flush(m_stream, nullptr);
+    return audioChunk.size;
+}
+
+AudioFormat PulseAudioSink::getNativeFormat() const
+{
+    return m_format;
+}
+
+/**
+ * @brief Latency measured from the PulseAudio timing info, the target until the stream plays.
+ */
+int64_t PulseAudioSink::getLatencyUs() const
+{
+    int64_t latencyUs = m_latencyUs;
+    return latencyUs > 0 ? latencyUs : m_targetLatencyUs;
+}
+
+AudioSinkStats PulseAudioSink::getStats() const
+{
+    AudioSinkStats stats;
+    stats.bufferDepthUs = m_jitterBuffer.getDepthUs();
+    stats.latencyUs = m_latencyUs;
+    stats.rateAdjustmentPpm = m_rateAdjustmentPpm;
+    stats.underflowCount = m_underflowCount;
+    stats.jitterBuffer = m_jitterBuffer.getStats();
+    return stats;
+}
+
+void PulseAudioSink::onContextStateChanged(pa_context* /*context*/, void* userdata)
+{
+    PulseAudioSink* sink = static_cast<PulseAudioSink*>(userdata);
+    pa_threaded_mainloop_signal(sink->m_mainloop, 0);
+}
+
+void PulseAudioSink::onStreamStateChanged(pa_stream* /*stream*/, void* userdata)
+{
+    PulseAudioSink* sink = static_cast<PulseAudioSink*>(userdata);
+    pa_threaded_mainloop_signal(sink->m_mainloop, 0);
+}
 
-    pa_simple_free(m_stream);
-    m_stream = nullptr;
+void PulseAudioSink::onStreamWriteRequested(pa_stream* /*stream*/, size_t byteCount, void* userdata)
+{
+    static_cast<PulseAudioSink*>(userdata)->fillStream(byteCount);
 }
 
-void PulseAudioSink::run()
+void PulseAudioSink::onStreamUnderflow(pa_stream* /*stream*/, void* userdata)
 {
-    AudioChunk audioChunk;
+    ++static_cast<PulseAudioSink*>(userdata)->m_underflowCount;
+}
 
-    while (!isAbortRequested())
+/**
+ * @brief Connect the playback stream once the context is ready and wait for it, the mainloop lock must be held.
+ */
+void PulseAudioSink::waitForReady()
+{
+    pa_context_state_t contextState;
+    while ((contextState = pa_context_get_state(m_context)) != PA_CONTEXT_READY)
     {
-        while (!outputAudioChunk_.try_dequeue(audioChunk) && !isAbortRequested())
+        if (contextState == PA_CONTEXT_FAILED || contextState == PA_CONTEXT_TERMINATED)
         {
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            throw std::runtime_error("cannot connect to pulseaudio: " +
+                                     std::string(pa_strerror(pa_context_errno(m_context))));
         }
+        pa_threaded_mainloop_wait(m_mainloop);
+    }
+
+    m_stream = pa_stream_new(m_context, "steno", &m_ss, nullptr);
+    if (m_stream == nullptr)
+    {
+        throw std::runtime_error("cannot initialize pulseaudio stream: " +
+                                 std::string(pa_strerror(pa_context_errno(m_context))));
+    }
+
+    pa_stream_set_state_callback(m_stream, &PulseAudioSink::onStreamStateChanged, this);
+    pa_stream_set_write_callback(m_stream, &PulseAudioSink::onStreamWriteRequested, this);
+    pa_stream_set_underflow_callback(m_stream, &PulseAudioSink::onStreamUnderflow, this);
+
+    // PulseAudio holds half of the target latency, the jitter buffer the other half
+    pa_buffer_attr bufferAttributes;
+    bufferAttributes.maxlength = static_cast<uint32_t>(-1);
+    bufferAttributes.tlength = static_cast<uint32_t>(pa_usec_to_bytes(m_targetLatencyUs / 2, &m_ss));
+    bufferAttributes.prebuf = static_cast<uint32_t>(-1);
+    bufferAttributes.minreq = static_cast<uint32_t>(-1);
+    bufferAttributes.fragsize = static_cast<uint32_t>(-1);
 
-        int error;
-        int bytesWritten = pa_simple_write(m_stream, audioChunk.audioData.get(), audioChunk.size, &error);
-        if (bytesWritten < 0)
+    pa_stream_flags_t flags = static_cast<pa_stream_flags_t>(PA_STREAM_INTERPOLATE_TIMING |
+                                                             PA_STREAM_AUTO_TIMING_UPDATE | PA_STREAM_ADJUST_LATENCY |
+                                                             PA_STREAM_VARIABLE_RATE);
+
+    // dev of nullptr tells pulsaudio to use the default device
+    const char* dev = m_deviceName.empty() ? nullptr : m_deviceName.c_str();
+    if (pa_stream_connect_playback(m_stream, dev, &bufferAttributes, flags, nullptr, nullptr) < 0)
+    {
+        throw std::runtime_error("cannot initialize pulseaudio stream: " +
+                                 std::string(pa_strerror(pa_context_errno(m_context))));
+    }
+
+    pa_stream_state_t streamState;
+    while ((streamState = pa_stream_get_state(m_stream)) != PA_STREAM_READY)
+    {
+        if (streamState == PA_STREAM_FAILED || streamState == PA_STREAM_TERMINATED)
         {
-            throw std::runtime_error("pulseaudio write failed: " + std::string(pa_strerror(error)));
+            throw std::runtime_error("cannot initialize pulseaudio stream: " +
+                                     std::string(pa_strerror(pa_context_errno(m_context))));
         }
+        pa_threaded_mainloop_wait(m_mainloop);
     }
 }
 
-int PulseAudioSink::write(const AudioChunk& audioChunk)
+/**
+ * @brief Answer a write request of PulseAudio from the jitter buffer, the mainloop lock must be held.
+ */
+void PulseAudioSink::fillStream(std::size_t byteCount)
 {
-    while (!outputAudioChunk_.try_enqueue(audioChunk) && !isAbortRequested()) {}
+    if (!m_isPrimed)
+    {
+        return;
+    }
 
-    return audioChunk.size;
+    std::size_t frameSize = pa_frame_size(&m_ss);
+    while (byteCount >= frameSize)
+    {
+        // The jitter buffer writes directly in the memory of the stream
+        void* data = nullptr;
+        std::size_t size = byteCount - byteCount % frameSize;
+        if (pa_stream_begin_write(m_stream, &data, &size) < 0 || data == nullptr || size < frameSize)
+        {
+            break;
+        }
+
+        size -= size % frameSize;
+        m_jitterBuffer.read(static_cast<uint8_t*>(data), size);
+        pa_stream_write(m_stream, data, size, nullptr, 0, PA_SEEK_RELATIVE);
+        byteCount -= std::min(byteCount, size);
+    }
+
+    updateLatencyControl();
+}
+
+/**
+ * @brief Measure the latency from write to playout and steer it to the target, the mainloop lock must be held.
+ */
+void PulseAudioSink::updateLatencyControl()
+{
+    pa_usec_t streamLatencyUs = 0;
+    int isNegative = 0;
+    if (pa_stream_get_latency(m_stream, &streamLatencyUs, &isNegative) < 0)
+    {
+        return;    // No timing information yet
+    }
+
+    int64_t latencyUs = m_jitterBuffer.getDepthUs() + (isNegative ? 0 : static_cast<int64_t>(streamLatencyUs));
+    m_smoothedLatencyUs += (latencyUs - m_smoothedLatencyUs) * LATENCY_SMOOTHING;
+    m_latencyUs = static_cast<int64_t>(m_smoothedLatencyUs);
+
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (now - m_lastControlTime < LATENCY_CONTROL_INTERVAL)
+    {
+        return;
+    }
+    m_lastControlTime = now;
+
+    int64_t errorUs = static_cast<int64_t>(m_smoothedLatencyUs) - m_targetLatencyUs;
+    int rateAdjustmentPpm = 0;
+
+    if (std::abs(errorUs) > HARD_CORRECTION_THRESHOLD_US)
+    {
+        // Too far to catch up by resampling in a reasonable time
+        m_jitterBuffer.adjustDepth(-errorUs);
+        m_smoothedLatencyUs -= errorUs;
+        std::cout << "PulseAudio sink latency corrected by " << -errorUs / 1000 << " ms" << std::endl;
+    }
+    else
+    {
+        // A higher stream rate plays the buffered audio faster and reduces the latency
+        rateAdjustmentPpm = static_cast<int>(
+            std::max<int64_t>(-MAX_RATE_PPM, std::min<int64_t>(MAX_RATE_PPM, errorUs * RATE_PPM_PER_MS / 1000)));
+    }
+
+    uint32_t streamRate =
+        static_cast<uint32_t>(std::lround(m_ss.rate * (1.0 + rateAdjustmentPpm / 1000000.0)));
+    if (streamRate != m_streamRate)
+    {
+        pa_operation* operation = pa_stream_update_sample_rate(m_stream, streamRate, nullptr, nullptr);
+        if (operation != nullptr)
+        {
+            pa_operation_unref(operation);
+            m_streamRate = streamRate;
+            m_rateAdjustmentPpm = rateAdjustmentPpm;
+        }
+    }
 }
 
 }    // namespace Model
@@ -1,35 +1,77 @@
 #ifndef I_PULSEAUDIO_SINK_H
 #define I_PULSEAUDIO_SINK_H
 
+#include <atomic>
+#include <chrono>
 #include <string>
 
-#include <pulse/simple.h>
+#include <pulse/pulseaudio.h>
 
 #include "model/stream/audio/audio_config.h"
+#include "model/stream/audio/audio_jitter_buffer.h"
 #include "model/stream/audio/i_audio_sink.h"
-#include "model/stream/utils/threads/thread.h"
-#include "model/stream/utils/threads/readerwriterqueue.h"
 
 namespace Model
 {
-class PulseAudioSink : public IAudioSink, protected Thread
+struct AudioSinkStats
+{
+    int64_t bufferDepthUs = 0;     // Audio waiting in the jitter buffer
+    int64_t latencyUs = 0;         // Jitter buffer and PulseAudio latency, from write to playout
+    int rateAdjustmentPpm = 0;     // Drift compensation applied to the stream sample rate
+    uint64_t underflowCount = 0;    // PulseAudio ran out of audio to play
+    AudioJitterBufferStats jitterBuffer;
+};
+
+/**
+ * @brief Plays audio on a PulseAudio stream with the asynchronous API. Chunks go through a jitter buffer that is
+ * read from the PulseAudio write requests directly in the stream memory. The latency from write to playout is kept
+ * at a target by adjusting the stream sample rate by a few hundred ppm, large errors are corrected at once by
+ * dropping or inserting frames.
+ */
+class PulseAudioSink : public IAudioSink
 {
    public:
-    PulseAudioSink(std::shared_ptr<AudioConfig> audioConfig);
+    PulseAudioSink(std::shared_ptr<AudioConfig> audioConfig, int targetLatencyMs);
     ~PulseAudioSink() override;
 
     void open() override;
     void close() override;
     int write(const AudioChunk& audioChunk) override;
+    AudioFormat getNativeFormat() const override;
+    int64_t getLatencyUs() const override;
 
-    void run() override;
+    AudioSinkStats getStats() const;
 
    private:
+    static void onContextStateChanged(pa_context* context, void* userdata);
+    static void onStreamStateChanged(pa_stream* stream, void* userdata);
+    static void onStreamWriteRequested(pa_stream* stream, size_t byteCount, void* userdata);
+    static void onStreamUnderflow(pa_stream* stream, void* userdata);
+
+    void waitForReady();
+    void fillStream(std::size_t byteCount);
+    void updateLatencyControl();
+
     std::string m_deviceName;
-    pa_simple* m_stream;
+    AudioFormat m_format;
     pa_sample_spec m_ss{};
+    int64_t m_targetLatencyUs;
+
+    pa_threaded_mainloop* m_mainloop;
+    pa_context* m_context;
+    pa_stream* m_stream;
+
+    AudioJitterBuffer m_jitterBuffer;
+    std::atomic<bool> m_isPrimed;
+
+    // Latency control, only used from the PulseAudio thread
+    double m_smoothedLatencyUs;
+    std::chrono::steady_clock::time_point m_lastControlTime;
+    uint32_t m_streamRate;
 
-    moodycamel::ReaderWriterQueue<AudioChunk> outputAudioChunk_;
+    std::atomic<int64_t> m_latencyUs;
+    std::atomic<int> m_rateAdjustmentPpm;
+    std::atomic<uint64_t> m_underflowCount;
 };
 
 }    // namespace Model
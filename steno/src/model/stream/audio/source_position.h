@@ -1,19 +1,17 @@
 #ifndef SOURCE_POSITION_H
 #define SOURCE_POSITION_H
 
-#include <QJsonValue>
-
 namespace Model
 {
 struct SourcePosition
 {
-    SourcePosition(float azimuth, float elevation);
+    SourcePosition() = default;
+    SourcePosition(float azimuth, float elevation, float activity = 1.f);
     ~SourcePosition() = default;
 
-    static SourcePosition deserialize(const QJsonValue& jsonSource);
-
     float azimuth;
     float elevation;
+    float activity;    // Probability from 0 to 1 that the source is active, as tracked by odas
 };
 }    // namespace Model
 
@@ -0,0 +1,107 @@
+#include "source_position_history.h"
+
+namespace Model
+{
+SourcePositionHistory::SourcePositionHistory()
+    : pushCount_(0)
+{
+    for (std::atomic<uint64_t>& timestamp : timestamps_)
+    {
+        timestamp.store(0, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Add the positions of an update, timestamps must not go back in time.
+ */
+void SourcePositionHistory::push(const SourcePositions& positions)
+{
+    uint64_t index = pushCount_.load(std::memory_order_relaxed);
+    std::size_t slot = index % frames_.size();
+
+    Frame frame;
+    frame.index = index;
+    frame.positions = positions;
+    frame.positions.sequence = index + 1;
+
+    frames_[slot].store(frame);
+    timestamps_[slot].store(positions.timestamp, std::memory_order_relaxed);
+    pushCount_.store(index + 1, std::memory_order_release);
+}
+
+/**
+ * @return positions of the last update, empty with a sequence of 0 if there was none.
+ */
+SourcePositions SourcePositionHistory::getLatest() const
+{
+    SourcePositions positions;
+
+    uint64_t pushCount;
+    do
+    {
+        pushCount = pushCount_.load(std::memory_order_acquire);
+    } while (pushCount > 0 && !loadFrame(pushCount - 1, positions));
+
+    return positions;
+}
+
+/**
+ * @brief Get the positions that were current at a time: the last update at or before it. Times before the oldest
+ * update kept get the oldest one, times after the last update get the last one.
+ * @param [IN] timestamp - time on the media timeline, like the timestamps of the updates.
+ */
+SourcePositions SourcePositionHistory::getAt(uint64_t timestamp) const
+{
+    SourcePositions positions;
+
+    while (true)
+    {
+        uint64_t pushCount = pushCount_.load(std::memory_order_acquire);
+        if (pushCount == 0)
+        {
+            return positions;
+        }
+
+        // Keep a slot of margin at the old end, the writer could be overwriting it
+        uint64_t first = pushCount > frames_.size() ? pushCount - frames_.size() + 1 : 0;
+        uint64_t last = pushCount - 1;
+
+        // Find the last update with a timestamp at or before the requested time
+        uint64_t low = first;
+        uint64_t high = last;
+        while (low < high)
+        {
+            uint64_t middle = low + (high - low + 1) / 2;
+            if (timestamps_[middle % frames_.size()].load(std::memory_order_relaxed) <= timestamp)
+            {
+                low = middle;
+            }
+            else
+            {
+                high = middle - 1;
+            }
+        }
+
+        // The slot was overwritten during the search if the writer went around the ring, search again
+        if (loadFrame(low, positions))
+        {
+            return positions;
+        }
+    }
+}
+
+bool SourcePositionHistory::loadFrame(uint64_t index, SourcePositions& outPositions) const
+{
+    Frame frame;
+    frames_[index % frames_.size()].load(frame);
+
+    if (frame.index != index)
+    {
+        return false;
+    }
+
+    outPositions = frame.positions;
+    return true;
+}
+
+}    // namespace Model
@@ -0,0 +1,46 @@
+#ifndef SOURCE_POSITION_HISTORY_H
+#define SOURCE_POSITION_HISTORY_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "model/stream/audio/source_positions.h"
+#include "model/stream/utils/threads/seqlock.h"
+
+namespace Model
+{
+const int SOURCE_POSITION_HISTORY_SIZE = 64;
+
+/**
+ * @brief Last position updates indexed by their timestamp, so audio chunks and images can be matched to the
+ * positions at their own time. Single writer, multiple readers: each slot is a seqlock, readers never block the
+ * writer and never allocate. A lookup by time is a binary search over the timestamps of the slots.
+ */
+class SourcePositionHistory
+{
+   public:
+    SourcePositionHistory();
+
+    void push(const SourcePositions& positions);
+
+    SourcePositions getLatest() const;
+    SourcePositions getAt(uint64_t timestamp) const;
+
+   private:
+    struct Frame
+    {
+        uint64_t index;
+        SourcePositions positions;
+    };
+
+    bool loadFrame(uint64_t index, SourcePositions& outPositions) const;
+
+    std::array<SeqLock<Frame>, SOURCE_POSITION_HISTORY_SIZE> frames_;
+    std::array<std::atomic<uint64_t>, SOURCE_POSITION_HISTORY_SIZE> timestamps_;
+    std::atomic<uint64_t> pushCount_;
+};
+
+}    // namespace Model
+
+#endif    //! SOURCE_POSITION_HISTORY_H
@@ -0,0 +1,76 @@
+#ifndef SOURCE_POSITIONS_H
+#define SOURCE_POSITIONS_H
+
+#include <array>
+#include <cstdint>
+
+#include "model/stream/audio/source_position.h"
+
+namespace Model
+{
+const int MAX_SOURCE_POSITIONS = 16;
+
+/**
+ * @brief Fixed capacity snapshot of the audio source positions, it can be copied without allocating.
+ */
+struct SourcePositions
+{
+    SourcePositions()
+        : count(0)
+        , timestamp(0)
+        , sequence(0)
+    {
+    }
+
+    std::size_t size() const
+    {
+        return count;
+    }
+
+    bool empty() const
+    {
+        return count == 0;
+    }
+
+    bool isFull() const
+    {
+        return count == positions.size();
+    }
+
+    const SourcePosition& operator[](std::size_t index) const
+    {
+        return positions[index];
+    }
+
+    const SourcePosition* begin() const
+    {
+        return positions.data();
+    }
+
+    const SourcePosition* end() const
+    {
+        return positions.data() + count;
+    }
+
+    bool push(const SourcePosition& position)
+    {
+        if (isFull()) return false;
+
+        positions[count++] = position;
+        return true;
+    }
+
+    void clear()
+    {
+        count = 0;
+    }
+
+    std::array<SourcePosition, MAX_SOURCE_POSITIONS> positions;
+    std::size_t count;
+    uint64_t timestamp;    // Publish time on the media timeline, in microseconds
+    uint64_t sequence;     // Incremented on each publish, can be used to skip work when nothing changed
+};
+
+}    // namespace Model
+
+#endif    // SOURCE_POSITIONS_H
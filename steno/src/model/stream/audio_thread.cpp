@@ -0,0 +1,133 @@
+#include "audio_thread.h"
+
+#include <iostream>
+
+#include "model/classifier/classifier.h"
+#include "model/stream/utils/time/media_clock.h"
+
+namespace
+{
+// Wake up regularly without audio to check if the thread must stop
+const int AUDIO_WAIT_TIMEOUT_US = 100000;
+}
+
+namespace Model
+{
+AudioThread::AudioThread(std::unique_ptr<IAudioSource> audioSource, std::unique_ptr<IAudioSink> audioSink,
+                         std::shared_ptr<IPositionSource> positionSource,
+                         std::shared_ptr<SeqLock<ImagePositions>> imagePositions,
+                         std::shared_ptr<MediaSynchronizer> mediaSynchronizer,
+                         std::unique_ptr<AudioSuppresser> audioSuppresser,
+                         std::unique_ptr<AudioMixer> audioMixer,
+                         float classifierRangeThreshold)
+    : Thread()
+    , audioSource_(std::move(audioSource))
+    , audioSink_(std::move(audioSink))
+    , positionSource_(std::move(positionSource))
+    , imagePositions_(std::move(imagePositions))
+    , mediaSynchronizer_(std::move(mediaSynchronizer))
+    , audioSuppresser_(std::move(audioSuppresser))
+    , audioMixer_(std::move(audioMixer))
+    , classifierRangeThreshold_(classifierRangeThreshold)
+    , classifiedImagePositionsVersion_(0)
+    , classifiedSourcePositionsSequence_(0)
+    , isClassified_(false)
+{
+    if (!audioSource_ || !audioSink_ || !positionSource_ || !imagePositions_ || !mediaSynchronizer_ ||
+        !audioSuppresser_ || !audioMixer_)
+    {
+        throw std::invalid_argument("Error in AudioThread - Null is not a valid argument");
+    }
+
+    classifiedImagePositions_.reserve(MAX_IMAGE_POSITIONS);
+    sourcesToKeep_.reserve(MAX_SOURCE_POSITIONS);
+}
+
+/**
+ * @brief Managing the odas audio from its reception to its playout.
+ */
+void AudioThread::run()
+{
+    m_state = ThreadStatus::RUNNING;
+    notify();
+
+    audioSource_->open();
+    audioSink_->open();
+    positionSource_->open();
+
+    std::cout << "AudioThread loop started" << std::endl;
+
+    try
+    {
+        while (!isAbortRequested())
+        {
+            AudioChunk audioChunk;
+            if (audioSource_->waitAudioChunk(audioChunk, AUDIO_WAIT_TIMEOUT_US))
+            {
+                processAudioChunk(audioChunk);
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cout << "Error in audio thread : " << e.what() << std::endl;
+        m_state = ThreadStatus::CRASHED;
+    }
+
+    audioSource_->close();
+    audioSink_->close();
+    positionSource_->close();
+
+    std::cout << "AudioThread loop finished" << std::endl;
+
+    if (m_state != ThreadStatus::CRASHED)
+    {
+        m_state = ThreadStatus::STOPPED;
+    }
+
+    notify();
+}
+
+void AudioThread::processAudioChunk(AudioChunk& audioChunk)
+{
+    ImagePositions imagePositions;
+    uint64_t imagePositionsVersion = imagePositions_->load(imagePositions);
+
+    // Positions at the time of the chunk, not the last received ones, queued chunks each get their own
+    SourcePositions sourcePositions = positionSource_->getPositionsAt(audioChunk.timestamp);
+
+    if (!imagePositions.empty())
+    {
+        // Sources to keep only need to be classified again if the image or audio positions changed
+        if (!isClassified_ || imagePositionsVersion != classifiedImagePositionsVersion_ ||
+            sourcePositions.sequence != classifiedSourcePositionsSequence_)
+        {
+            classifiedImagePositions_.assign(imagePositions.begin(), imagePositions.end());
+            Classifier::getSourcesToKeep(sourcePositions, classifiedImagePositions_, classifierRangeThreshold_,
+                                         sourcesToKeep_);
+            classifiedImagePositionsVersion_ = imagePositionsVersion;
+            classifiedSourcePositionsSequence_ = sourcePositions.sequence;
+            isClassified_ = true;
+        }
+
+        audioSuppresser_->suppressNoise(sourcesToKeep_, audioChunk);
+    }
+    else
+    {
+        // Fade back in the sources suppressed while there were virtual cameras
+        audioSuppresser_->keepAllSources(audioChunk);
+        isClassified_ = false;
+    }
+
+    // Only the sources left audible by the suppression are mixed in the output layout
+    AudioChunk mixedAudioChunk;
+    audioSuppresser_->getAudibleSources(audibleSources_);
+    if (audioMixer_->mix(audioChunk, sourcePositions, audibleSources_, mixedAudioChunk))
+    {
+        audioSink_->write(mixedAudioChunk);
+        mediaSynchronizer_->updateAudioTimestamp(mixedAudioChunk.timestamp,
+                                                 MediaClock::now() + audioSink_->getLatencyUs());
+    }
+}
+
+}    // namespace Model
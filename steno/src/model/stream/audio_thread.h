@@ -0,0 +1,64 @@
+#ifndef AUDIO_THREAD_H
+#define AUDIO_THREAD_H
+
+#include <memory>
+#include <vector>
+
+#include "model/audio_mixer/audio_mixer.h"
+#include "model/audio_suppresser/audio_suppresser.h"
+#include "model/stream/audio/i_audio_sink.h"
+#include "model/stream/audio/i_audio_source.h"
+#include "model/stream/audio/i_position_source.h"
+#include "model/stream/media_synchronizer.h"
+#include "model/stream/utils/alloc/monotonic_arena.h"
+#include "model/stream/utils/models/spherical_angle_rect.h"
+#include "model/stream/utils/threads/seqlock.h"
+#include "model/stream/utils/threads/thread.h"
+#include "model/stream/video/virtualcamera/image_positions.h"
+#include "model/utils/observer/subject.h"
+
+namespace Model
+{
+/**
+ * @brief Processes each audio chunk as soon as odas sends it: suppression of the sources outside of the virtual
+ * cameras, mixing and playout. The displayed virtual cameras are read from the snapshot the video thread publishes,
+ * so a late frame never delays the audio.
+ */
+class AudioThread : public Thread, public Subject
+{
+   public:
+    AudioThread(std::unique_ptr<IAudioSource> audioSource, std::unique_ptr<IAudioSink> audioSink,
+                std::shared_ptr<IPositionSource> positionSource,
+                std::shared_ptr<SeqLock<ImagePositions>> imagePositions,
+                std::shared_ptr<MediaSynchronizer> mediaSynchronizer,
+                std::unique_ptr<AudioSuppresser> audioSuppresser,
+                std::unique_ptr<AudioMixer> audioMixer,
+                float classifierRangeThreshold);
+
+   protected:
+    void run() override;
+
+   private:
+    void processAudioChunk(AudioChunk& audioChunk);
+
+    std::unique_ptr<IAudioSource> audioSource_;
+    std::unique_ptr<IAudioSink> audioSink_;
+    std::shared_ptr<IPositionSource> positionSource_;
+    std::shared_ptr<SeqLock<ImagePositions>> imagePositions_;
+    std::shared_ptr<MediaSynchronizer> mediaSynchronizer_;
+    std::unique_ptr<AudioSuppresser> audioSuppresser_;
+    std::unique_ptr<AudioMixer> audioMixer_;
+    float classifierRangeThreshold_;
+
+    // Classification is only done again when the image or audio positions changed, the vectors are reserved once
+    ArenaVector<SphericalAngleRect> classifiedImagePositions_;
+    uint64_t classifiedImagePositionsVersion_;
+    uint64_t classifiedSourcePositionsSequence_;
+    bool isClassified_;
+    ArenaVector<int> sourcesToKeep_;
+    std::vector<int> audibleSources_;
+};
+
+}    // namespace Model
+
+#endif    //! AUDIO_THREAD_H
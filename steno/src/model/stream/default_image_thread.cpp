@@ -28,8 +28,8 @@ void DefaultImageThread::run()
     ImageFormat imgFormat = static_cast<ImageFormat>(m_videoConfig->value(VideoConfig::IMAGE_FORMAT).toInt());
     ImageFileReader imageFileReader(dir.absolutePath().toStdString(), imgFormat);
     imageFileReader.open();
-    Image image;
-    imageFileReader.readImage(image);
+    FrameRef frame;
+    imageFileReader.readImage(frame);
     imageFileReader.close();
 
     m_videoOutput->open();
@@ -37,7 +37,7 @@ void DefaultImageThread::run()
     {
         try
         {
-            m_videoOutput->writeImage(image);
+            m_videoOutput->writeImage(frame);
             sleep(100);
         }
         catch (const std::exception& e)
@@ -0,0 +1,172 @@
+#include "frame_pacer.h"
+
+#include <time.h>
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+
+namespace
+{
+const int64_t NS_PER_SECOND = 1000000000;
+
+// Past this many missed deadlines, catching up would only run frames back to back, they are skipped instead
+const uint64_t MAX_CATCH_UP_FRAMES = 2;
+}    // namespace
+
+namespace Model
+{
+/**
+ * @param [IN] targetFps - frames per second, the first deadline is the next frame period from now.
+ */
+FrameClock::FrameClock(int targetFps)
+    : originNs_(now())
+    , targetFps_(targetFps)
+{
+    if (targetFps <= 0)
+    {
+        throw std::invalid_argument("Error in FrameClock - Fps must be positive");
+    }
+}
+
+/**
+ * @brief Deadline of a frame in nanoseconds on the monotonic clock, whole seconds are added first so it never
+ * accumulates rounding errors.
+ */
+int64_t FrameClock::getDeadlineNs(uint64_t frameIndex) const
+{
+    int64_t seconds = static_cast<int64_t>(frameIndex / targetFps_);
+    int64_t remainingFrames = static_cast<int64_t>(frameIndex % targetFps_);
+    return originNs_ + seconds * NS_PER_SECOND + remainingFrames * NS_PER_SECOND / targetFps_;
+}
+
+/**
+ * @brief Index of the last frame deadline at or before a time.
+ */
+uint64_t FrameClock::getFrameIndexAt(int64_t timeNs) const
+{
+    int64_t elapsedNs = std::max<int64_t>(timeNs - originNs_, 0);
+    uint64_t seconds = static_cast<uint64_t>(elapsedNs / NS_PER_SECOND);
+    int64_t remainingNs = elapsedNs % NS_PER_SECOND;
+    return seconds * targetFps_ + static_cast<uint64_t>(remainingNs * targetFps_ / NS_PER_SECOND);
+}
+
+int FrameClock::getTargetFps() const
+{
+    return targetFps_;
+}
+
+/**
+ * @brief Time in nanoseconds on the clock the deadlines are slept on.
+ */
+int64_t FrameClock::now()
+{
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return static_cast<int64_t>(time.tv_sec) * NS_PER_SECOND + time.tv_nsec;
+}
+
+FramePacer::FramePacer(std::shared_ptr<FrameClock> frameClock, LatePolicy latePolicy)
+    : frameClock_(frameClock)
+    , latePolicy_(latePolicy)
+    , isStarted_(false)
+    , frameIndex_(0)
+    , frameStartNs_(0)
+    , lastFrameTimeNs_(0)
+{
+    if (!frameClock_)
+    {
+        throw std::invalid_argument("Error in FramePacer - Null is not a valid frame clock");
+    }
+}
+
+void FramePacer::startFrame()
+{
+    int64_t nowNs = FrameClock::now();
+
+    if (isStarted_)
+    {
+        lastFrameTimeNs_ = nowNs - frameStartNs_;
+    }
+    else
+    {
+        // The first frame ends on the next deadline of the clock, in phase with the other loops
+        frameIndex_ = frameClock_->getFrameIndexAt(nowNs) + 1;
+        lastFrameTimeNs_ = NS_PER_SECOND / frameClock_->getTargetFps();
+        isStarted_ = true;
+    }
+
+    frameStartNs_ = nowNs;
+}
+
+/**
+ * @brief Sleep until the deadline of the frame, or apply the late policy if it already passed.
+ */
+void FramePacer::endFrame()
+{
+    int64_t deadlineNs = frameClock_->getDeadlineNs(frameIndex_);
+    int64_t nowNs = FrameClock::now();
+
+    if (nowNs < deadlineNs)
+    {
+        sleepUntil(deadlineNs);
+        nowNs = FrameClock::now();
+    }
+    else
+    {
+        ++stats_.lateFrameCount;
+    }
+
+    int64_t latenessNs = nowNs - deadlineNs;
+    ++stats_.frameCount;
+    stats_.totalLatenessNs += latenessNs;
+    stats_.maxLatenessNs = std::max(stats_.maxLatenessNs, latenessNs);
+
+    ++frameIndex_;
+
+    uint64_t currentFrameIndex = frameClock_->getFrameIndexAt(nowNs);
+    if (currentFrameIndex >= frameIndex_)
+    {
+        // The next deadline already passed
+        uint64_t missedFrameCount = currentFrameIndex - frameIndex_ + 1;
+        if (latePolicy_ == LatePolicy::SKIP || missedFrameCount > MAX_CATCH_UP_FRAMES)
+        {
+            stats_.skippedFrameCount += missedFrameCount;
+            frameIndex_ = currentFrameIndex + 1;
+        }
+    }
+}
+
+/**
+ * @brief Time from the start of the previous frame to the start of this one.
+ */
+int FramePacer::getLastFrameTimeMs() const
+{
+    return static_cast<int>((lastFrameTimeNs_ + 500000) / 1000000);
+}
+
+/**
+ * @brief Time elapsed since startFrame, before endFrame it is the time spent processing the frame.
+ */
+uint64_t FramePacer::getCurrentFrameTimeUs() const
+{
+    return static_cast<uint64_t>(FrameClock::now() - frameStartNs_) / 1000;
+}
+
+FramePacingStats FramePacer::getStats() const
+{
+    return stats_;
+}
+
+void FramePacer::sleepUntil(int64_t deadlineNs) const
+{
+    timespec deadline;
+    deadline.tv_sec = static_cast<time_t>(deadlineNs / NS_PER_SECOND);
+    deadline.tv_nsec = static_cast<long>(deadlineNs % NS_PER_SECOND);
+
+    // An absolute deadline is not pushed back by signals or by the time spent before sleeping
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR)
+    {
+    }
+}
+
+}    // namespace Model
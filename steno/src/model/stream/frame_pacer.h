@@ -0,0 +1,75 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <cstdint>
+#include <memory>
+
+namespace Model
+{
+/**
+ * @brief Frame deadlines on the monotonic clock, exact to the nanosecond over any number of frames. Loops pacing on
+ * the same frame clock stay in phase.
+ */
+class FrameClock
+{
+   public:
+    explicit FrameClock(int targetFps);
+
+    int64_t getDeadlineNs(uint64_t frameIndex) const;
+    uint64_t getFrameIndexAt(int64_t timeNs) const;
+    int getTargetFps() const;
+
+    static int64_t now();
+
+   private:
+    int64_t originNs_;
+    int targetFps_;
+};
+
+struct FramePacingStats
+{
+    uint64_t frameCount = 0;
+    uint64_t lateFrameCount = 0;       // Frames that ended past their deadline
+    uint64_t skippedFrameCount = 0;    // Deadlines given up to get back on time
+    int64_t totalLatenessNs = 0;       // Wake up or end past the deadline, summed over every frame
+    int64_t maxLatenessNs = 0;
+};
+
+/**
+ * @brief Paces a loop on the deadlines of a frame clock, each frame ends by sleeping until its deadline. A frame that
+ * ends late either starts the next one right away to catch up on the missed deadlines, or skips them.
+ */
+class FramePacer
+{
+   public:
+    enum class LatePolicy
+    {
+        CATCH_UP,    // Keep every frame, the next ones are not paced until they are on time again
+        SKIP         // Keep the cadence, the next frame ends on the next deadline to come
+    };
+
+    FramePacer(std::shared_ptr<FrameClock> frameClock, LatePolicy latePolicy);
+
+    void startFrame();
+    void endFrame();
+    int getLastFrameTimeMs() const;
+    uint64_t getCurrentFrameTimeUs() const;
+    FramePacingStats getStats() const;
+
+   private:
+    void sleepUntil(int64_t deadlineNs) const;
+
+    std::shared_ptr<FrameClock> frameClock_;
+    LatePolicy latePolicy_;
+
+    bool isStarted_;
+    uint64_t frameIndex_;
+    int64_t frameStartNs_;
+    int64_t lastFrameTimeNs_;
+
+    FramePacingStats stats_;
+};
+
+}    // namespace Model
+
+#endif    //! FRAME_PACER_H
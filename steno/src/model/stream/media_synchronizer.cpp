@@ -1,107 +1,160 @@
 #include "media_synchronizer.h"
 
-#include <iostream>
-#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "model/stream/utils/time/media_clock.h"
 
 namespace
 {
-const float ACCEPTABLE_DELAY_FRAMETIME_MULTIPLIER = 1.2f;
+// Audio is not played anymore (e.g. odas stopped) if the last chunk was played this long ago
+const unsigned long long AUDIO_TIMEOUT_US = 200000;
 }
 
 namespace Model
 {
-
-MediaSynchronizer::MediaSynchronizer(int frameTimeUs)
-    : acceptableDelayUs_(frameTimeUs * ACCEPTABLE_DELAY_FRAMETIME_MULTIPLIER)
-{
-}
-
-void MediaSynchronizer::queueAudio(AudioChunk audioChunk)
+/**
+ * @param [IN] imageCapacity - images held while ahead of the audio, must be less than the producer buffers.
+ * @param [IN] lipSyncOffsetUs - added to the audio time images are matched with, positive shows the video earlier.
+ */
+MediaSynchronizer::MediaSynchronizer(std::size_t imageCapacity, int64_t lipSyncOffsetUs)
+    : lipSyncOffsetUs_(lipSyncOffsetUs)
+    , images_(imageCapacity)
+    , imageHead_(0)
+    , imageCount_(0)
 {
-    audioQueue_.push(audioChunk);
+    if (imageCapacity == 0)
+    {
+        throw std::invalid_argument("Error in MediaSynchronizer - the image capacity must be at least 1");
+    }
 }
 
-void MediaSynchronizer::queueImage(Image image)
+/**
+ * @brief Called by the audio thread for each chunk it plays.
+ * @param [IN] audioTimestamp - media time of the chunk.
+ * @param [IN] playoutTime - media time at which the chunk will be heard, after the latency of the sink.
+ */
+void MediaSynchronizer::updateAudioTimestamp(unsigned long long audioTimestamp, unsigned long long playoutTime)
 {
-    imageQueue_.push(image);
+    AudioPlayout audioPlayout;
+    audioPlayout.timestamp = audioTimestamp;
+    audioPlayout.playoutTime = playoutTime;
+    audioPlayout_.store(audioPlayout);
 }
 
-bool MediaSynchronizer::synchronize(SynchronizedMedia& outMedia)
+/**
+ * @brief Insert an image by timestamp, the oldest is dropped if the ring is full.
+ */
+void MediaSynchronizer::queueImage(const FrameRef& frame)
 {
-    outMedia.hasAudio = false;
-    outMedia.hasImage = false;
-
-    AudioChunk audio;
-    if (!audioQueue_.empty())
+    if (imageCount_ == images_.size())
     {
-        audio = audioQueue_.front();
-        outMedia.hasAudio = true;
+        popImages(1);
+        ++stats_.overflowImageCount;
     }
 
-    Image image;
-    if (!imageQueue_.empty())
+    // Images mostly come in order, an older one is moved back to its place
+    std::size_t index = imageCount_++;
+    getFrame(index) = frame;
+    while (index > 0 && getFrame(index - 1)->timeStamp > getFrame(index)->timeStamp)
     {
-        image = imageQueue_.front();
-        outMedia.hasImage = true;
+        std::swap(getFrame(index - 1), getFrame(index));
+        --index;
     }
+}
 
-    if (outMedia.hasImage && outMedia.hasAudio)
+/**
+ * @brief Get the image to present with the audio heard now, the images it passed are dropped.
+ * @return false if there is no image or they are all ahead of the audio, the last image must be kept on screen.
+ */
+bool MediaSynchronizer::synchronize(FrameRef& outFrame)
+{
+    if (imageCount_ == 0)
     {
-        long long timeDiff = static_cast<long long>(audio.timestamp - image.timeStamp);
-        if (std::abs(timeDiff) > acceptableDelayUs_)
-        {
-            if (timeDiff < 0)
-            {
-                // video ahead of audio, we send the last frame
-                outMedia.hasImage = false;
-            }
-            else
-            {
-                // audio ahead of video, we trash the video
-                while(std::abs(timeDiff) > acceptableDelayUs_)
-                {
-                    imageQueue_.pop();
-
-                    if (imageQueue_.empty())
-                    {
-                        outMedia.hasImage = false;
-                        break;
-                    }
-
-                    image = imageQueue_.front();
-                    timeDiff = static_cast<long long>(audio.timestamp - image.timeStamp);
-                }
-            }
-        }
+        return false;
     }
 
-    outMedia.audioChunk = audio;
-    outMedia.image = image;
+    unsigned long long audioTimestamp;
+    if (!getPresentedAudioTimestamp(audioTimestamp))
+    {
+        outFrame = getFrame(0);
+        popImages(1);
+        ++stats_.presentedImageCount;
+        return true;
+    }
 
-    if (outMedia.hasImage)
+    int64_t presentationTime = static_cast<int64_t>(audioTimestamp) + lipSyncOffsetUs_;
+    if (static_cast<int64_t>(getFrame(0)->timeStamp) > presentationTime)
     {
-        imageQueue_.pop();
+        ++stats_.heldFrameCount;
+        return false;
     }
 
-    if (outMedia.hasAudio)
+    // Last image at or before the audio
+    std::size_t index = 0;
+    while (index + 1 < imageCount_ && static_cast<int64_t>(getFrame(index + 1)->timeStamp) <= presentationTime)
     {
-        audioQueue_.pop();
+        ++index;
     }
 
+    outFrame = getFrame(index);
+    popImages(index + 1);
+
+    int64_t driftUs = presentationTime - static_cast<int64_t>(outFrame->timeStamp);
+    stats_.presentedImageCount += 1;
+    stats_.droppedImageCount += index;
+    stats_.lastDriftUs = driftUs;
+    stats_.maxDriftUs = std::max(stats_.maxDriftUs, driftUs);
+    stats_.totalDriftUs += driftUs;
+
     return true;
 }
 
-bool MediaSynchronizer::popAudio(AudioChunk& outAudioChunk)
+/**
+ * @brief Statistics of the video thread, not synchronized with synchronize.
+ */
+MediaSynchronizerStats MediaSynchronizer::getStats() const
+{
+    return stats_;
+}
+
+/**
+ * @brief Media time of the audio heard now, extrapolated from the last chunk written to the sink.
+ * @return false if no audio is played.
+ */
+bool MediaSynchronizer::getPresentedAudioTimestamp(unsigned long long& outAudioTimestamp) const
 {
-    if (audioQueue_.empty())
+    AudioPlayout audioPlayout;
+    audioPlayout_.load(audioPlayout);
+
+    unsigned long long now = MediaClock::now();
+    if (audioPlayout.playoutTime == 0 || now > audioPlayout.playoutTime + AUDIO_TIMEOUT_US)
     {
         return false;
     }
 
-    outAudioChunk = audioQueue_.front();
-    audioQueue_.pop();
-
+    outAudioTimestamp = audioPlayout.timestamp + now - audioPlayout.playoutTime;
     return true;
 }
 
+FrameRef& MediaSynchronizer::getFrame(std::size_t index)
+{
+    return images_[(imageHead_ + index) % images_.size()];
+}
+
+/**
+ * @brief Remove the oldest frames, they are released.
+ */
+void MediaSynchronizer::popImages(std::size_t count)
+{
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        getFrame(i).reset();
+    }
+
+    imageHead_ = (imageHead_ + count) % images_.size();
+    imageCount_ -= count;
+}
+
 }    // namespace Model
@@ -1,30 +1,66 @@
 #ifndef MEDIA_SYNCHRONIZER_H
 #define MEDIA_SYNCHRONIZER_H
 
-#include <iostream>
-#include <queue>
+#include <cstdint>
 #include <vector>
 
-#include "model/stream/synchronized_media.h"
+#include "model/stream/utils/images/frame_ref.h"
+#include "model/stream/utils/threads/seqlock.h"
 
 namespace Model
 {
+struct MediaSynchronizerStats
+{
+    uint64_t presentedImageCount = 0;
+    uint64_t droppedImageCount = 0;     // Passed by the audio before they could be presented
+    uint64_t overflowImageCount = 0;    // Dropped because the ring was full, the video is too far ahead
+    uint64_t heldFrameCount = 0;        // Calls that kept the last image on screen, every image was ahead
+    int64_t lastDriftUs = 0;            // Audio time minus the time of the presented image, offset included
+    int64_t maxDriftUs = 0;
+    int64_t totalDriftUs = 0;
+};
 
+/**
+ * @brief Holds or drops the images of the video thread to follow the audio played by the audio thread. Both are
+ * stamped on the media timeline, the image shown is the last one captured at or before the audio heard, whatever
+ * the number of audio chunks or images per frame. The audio thread only publishes its last chunk and when it will
+ * be played, images are passed in order when no audio is played. The ring holds references to the frames, a frame
+ * goes back to its producer as soon as it is presented or dropped.
+ */
 class MediaSynchronizer
 {
 public:
-    MediaSynchronizer(int frameTimeUs);
+    MediaSynchronizer(std::size_t imageCapacity, int64_t lipSyncOffsetUs);
     ~MediaSynchronizer() = default;
 
-    void queueAudio(AudioChunk audioChunk);
-    void queueImage(Image image);
-    bool synchronize(SynchronizedMedia& outMedia);
-    bool popAudio(AudioChunk& outAudioChunk);
+    void updateAudioTimestamp(unsigned long long audioTimestamp, unsigned long long playoutTime);
+    void queueImage(const FrameRef& frame);
+    bool synchronize(FrameRef& outFrame);
+
+    MediaSynchronizerStats getStats() const;
     
 private:
-    int acceptableDelayUs_;
-    std::queue<AudioChunk> audioQueue_;
-    std::queue<Image> imageQueue_;
+    struct AudioPlayout
+    {
+        unsigned long long timestamp = 0;
+        unsigned long long playoutTime = 0;
+    };
+
+    bool getPresentedAudioTimestamp(unsigned long long& outAudioTimestamp) const;
+    FrameRef& getFrame(std::size_t index);
+    void popImages(std::size_t count);
+
+    int64_t lipSyncOffsetUs_;
+
+    // Frames sorted by timestamp, from the oldest at imageHead_
+    std::vector<FrameRef> images_;
+    std::size_t imageHead_;
+    std::size_t imageCount_;
+
+    MediaSynchronizerStats stats_;
+
+    // Written by the audio thread
+    SeqLock<AudioPlayout> audioPlayout_;
 };
 
 }    // namespace Model
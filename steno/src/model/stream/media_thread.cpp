@@ -3,59 +3,57 @@
 #include <cstring>
 #include <iostream>
 
-#include "model/audio_suppresser/audio_suppresser.h"
-#include "model/classifier/classifier.h"
-#include "model/stream/audio/audio_config.h"
-#include "model/stream/frame_rate_stabilizer.h"
 #include "model/stream/utils/alloc/heap_object_factory.h"
 #include "model/stream/utils/images/image_drawing.h"
-#include "model/stream/utils/models/circular_buffer.h"
 #include "model/stream/utils/models/point.h"
 #include "model/stream/video/dewarping/dewarping_helper.h"
 #include "model/stream/video/dewarping/models/dewarping_config.h"
 #include "model/stream/video/video_config.h"
 #include "model/stream/video/virtualcamera/display_image_builder.h"
 
+namespace
+{
+// Only holds the virtual cameras read each frame
+const std::size_t FRAME_ARENA_SIZE = 4 * 1024;
+}    // namespace
+
 namespace Model
 {
-MediaThread::MediaThread(std::unique_ptr<IAudioSource> audioSource, std::unique_ptr<IAudioSink> audioSink,
-                         std::shared_ptr<IPositionSource> positionSource, std::unique_ptr<IVideoInput> videoInput,
-                         std::unique_ptr<IVideoOutput> videoOutput,
+MediaThread::MediaThread(std::unique_ptr<IVideoInput> videoInput, std::unique_ptr<IVideoOutput> videoOutput,
                          std::shared_ptr<IVirtualCameraSource> virtualCameraSource,
-                         std::unique_ptr<MediaSynchronizer> mediaSynchronizer,
-                         int framePerSeconds,
-                         float classifierRangeThreshold)
+                         std::shared_ptr<SeqLock<ImagePositions>> imagePositions,
+                         std::shared_ptr<MediaSynchronizer> mediaSynchronizer,
+                         std::shared_ptr<QualityGovernor> qualityGovernor,
+                         std::shared_ptr<FrameClock> frameClock)
     : Thread()
-    , audioSource_(std::move(audioSource))
-    , audioSink_(std::move(audioSink))
-    , positionSource_(std::move(positionSource))
     , videoInput_(std::move(videoInput))
     , videoOutput_(std::move(videoOutput))
     , virtualCameraSource_(virtualCameraSource)
+    , imagePositions_(std::move(imagePositions))
     , mediaSynchronizer_(std::move(mediaSynchronizer))
-    , framePerSeconds_(framePerSeconds)
-    , classifierRangeThreshold_(classifierRangeThreshold)
+    , qualityGovernor_(qualityGovernor)
+    , frameClock_(frameClock)
+    , frameArena_(FRAME_ARENA_SIZE)
 {
-    if (!audioSource_ || !audioSink_ || !positionSource_ || !videoInput_ || !videoOutput_ || !virtualCameraSource_)
+    if (!videoInput_ || !videoOutput_ || !virtualCameraSource_ || !imagePositions_ || !mediaSynchronizer_ ||
+        !qualityGovernor_ || !frameClock_)
     {
         throw std::invalid_argument("Error in MediaThread - Null is not a valid argument");
     }
 }
 
 /**
- * @brief Managing odas threads for audio and localization + camera and images processing.
+ * @brief Managing camera and images processing.
  */
 void MediaThread::run()
 {
-    FrameRateStabilizer frameStabilizer(framePerSeconds_);
+    // The output keeps its cadence, a late frame is not followed by frames back to back
+    FramePacer framePacer(frameClock_, FramePacer::LatePolicy::SKIP);
     
     m_state = ThreadStatus::RUNNING;
     notify();
 
-    // Start audio and video resources
-    audioSource_->open();
-    audioSink_->open();
-    positionSource_->open();
+    // Start video resources
     videoInput_->open();
     videoOutput_->open();
 
@@ -65,73 +63,24 @@ void MediaThread::run()
     {
         while (!isAbortRequested())
         {
-            frameStabilizer.startFrame();
+            framePacer.startFrame();
 
-            Image image;
-            if (videoInput_->readImage(image))
+            // Any number of images can be ready, the synchronizer picks the one to present
+            FrameRef frame;
+            while (videoInput_->readImage(frame))
             {
-                mediaSynchronizer_->queueImage(image);
+                mediaSynchronizer_->queueImage(frame);
             }
 
-            // Since the loop time is not always 1/fps, a delay can accumulate overtime.
-            // This results in 2 audio chunks available in the audio source. We need to
-            // process them both to stay in real time (otherwise an audio delay would 
-            // appear in the stream)
-            std::vector<AudioChunk> audioChunks;
-            AudioChunk audioChunk;
-            while (audioSource_->readAudioChunk(audioChunk))
-            {
-                // Get audio sources and image spatial positions
-                std::vector<SourcePosition> sourcePositions = positionSource_->getPositions();
-                std::vector<VirtualCamera> virtualCameras = virtualCameraSource_->getVirtualCameras();
-
-                if (virtualCameras.size() > 0)
-                {
-                    std::vector<SphericalAngleRect> imagePositions;
-                    imagePositions.reserve(virtualCameras.size());
-                    for (const auto& vc : virtualCameras)
-                    {
-                        imagePositions.push_back(vc);
-                    }
-
-                    std::vector<int> sourcesToKeep =
-                                Classifier::getSourcesToKeep(sourcePositions, imagePositions, classifierRangeThreshold_);
-
-                    AudioSuppresser::suppressNoise(sourcesToKeep, audioChunk);
-                }
-
-                audioChunks.push_back(audioChunk);
-                mediaSynchronizer_->queueAudio(audioChunk);
-            }
+            publishImagePositions();
 
-            SynchronizedMedia outputMedia;
-            if (mediaSynchronizer_->synchronize(outputMedia))
+            FrameRef outputFrame;
+            if (mediaSynchronizer_->synchronize(outputFrame))
             {
-                AudioChunk outputAudio = outputMedia.audioChunk;
-                Image outputImage = outputMedia.image;
-
-                if (outputMedia.hasAudio)
-                {
-                    audioSink_->write(outputAudio);
-
-                    // If 2 audio chunks were queued in the synchronizer, 2 need to come out
-                    AudioChunk secondAudioChunk;
-                    if (audioChunks.size() > 1)
-                    {
-                        if (mediaSynchronizer_->popAudio(secondAudioChunk))
-                        {
-                            audioSink_->write(secondAudioChunk);
-                        }
-                    }
-                }
-
-                if (outputMedia.hasImage)
-                {
-                    videoOutput_->writeImage(outputImage);
-                }
+                videoOutput_->writeImage(outputFrame);
             }
-            
-            frameStabilizer.endFrame();
+
+            framePacer.endFrame();
         }
     }
     catch (const std::exception& e)
@@ -140,14 +89,19 @@ void MediaThread::run()
         m_state = ThreadStatus::CRASHED;
     }
 
-    // Clean audio and video resources
-    audioSource_->close();
-    audioSink_->close();
-    positionSource_->close();
+    // Clean video resources
     videoInput_->close();
     videoOutput_->close();
 
-    std::cout << "MediaThread loop finished" << std::endl;
+    FramePacingStats pacingStats = framePacer.getStats();
+    std::cout << "MediaThread loop finished, " << pacingStats.lateFrameCount << " late frames, "
+              << pacingStats.skippedFrameCount << " skipped frames, max lateness "
+              << pacingStats.maxLatenessNs / 1000 << " us" << std::endl;
+
+    MediaSynchronizerStats syncStats = mediaSynchronizer_->getStats();
+    std::cout << "Media synchronizer presented " << syncStats.presentedImageCount << " images, dropped "
+              << syncStats.droppedImageCount + syncStats.overflowImageCount << ", max drift "
+              << syncStats.maxDriftUs / 1000 << " ms" << std::endl;
     
     if (m_state != ThreadStatus::CRASHED)
     {
@@ -157,4 +111,25 @@ void MediaThread::run()
     notify();
 }
 
+/**
+ * @brief Publish the positions of the displayed virtual cameras for the audio suppression. Keep the same virtual
+ * cameras as the ones displayed when the quality governor of the dewarping limits their count.
+ */
+void MediaThread::publishImagePositions()
+{
+    frameArena_.reset();
+
+    ArenaVector<VirtualCamera> virtualCameras(frameArena_);
+    virtualCameraSource_->getVirtualCameras(virtualCameras);
+    std::size_t maxVcCount = static_cast<std::size_t>(qualityGovernor_->getMaxVirtualCameraCount());
+
+    ImagePositions imagePositions;
+    for (std::size_t i = 0; i < virtualCameras.size() && i < maxVcCount; ++i)
+    {
+        imagePositions.push(virtualCameras[i]);
+    }
+
+    imagePositions_->store(imagePositions);
+}
+
 }    // namespace Model
@@ -0,0 +1,159 @@
+#include "quality_governor.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace Model
+{
+namespace
+{
+// Step down when this many frames miss their deadline within the miss window
+const int MISS_WINDOW_FRAMES = 30;
+const int MISSES_TO_STEP_DOWN = 3;
+
+// Step up only after a long window without any miss where every frame left this much of the budget unused
+const int HEADROOM_WINDOW_FRAMES = 150;
+const float HEADROOM_RATIO = 0.7f;
+
+const int MAX_LEVEL = static_cast<int>(QualityLevel::REDUCED_VIRTUAL_CAMERA_COUNT);
+
+const int DETECTION_INTERVAL_MS = 0;
+const int REDUCED_DETECTION_INTERVAL_MS = 500;
+const float REDUCED_VIRTUAL_CAMERA_RESOLUTION_SCALE = 0.75f;
+const int REDUCED_MAX_VIRTUAL_CAMERA_COUNT = 2;
+
+std::string getQualityLevelString(int level)
+{
+    switch (static_cast<QualityLevel>(level))
+    {
+        case QualityLevel::FULL:
+            return "full quality";
+        case QualityLevel::REDUCED_DETECTION_RATE:
+            return "reduced detection rate";
+        case QualityLevel::REDUCED_VIRTUAL_CAMERA_RESOLUTION:
+            return "reduced virtual camera resolution";
+        case QualityLevel::NEAREST_FILTERING:
+            return "nearest filtering";
+        case QualityLevel::REDUCED_VIRTUAL_CAMERA_COUNT:
+            return "reduced virtual camera count";
+    }
+
+    return "unknown";
+}
+
+}    // namespace
+
+QualityGovernor::QualityGovernor(int targetFps)
+    : frameCount_(0)
+    , missedFrameCount_(0)
+    , maxFrameTimeUs_(0)
+    , level_(static_cast<int>(QualityLevel::FULL))
+{
+    if (targetFps <= 0)
+    {
+        throw std::invalid_argument("Error in QualityGovernor - target fps must be greater than 0");
+    }
+
+    frameBudgetUs_ = 1000000 / targetFps;
+}
+
+/**
+ * @brief Report the time spent processing a frame, waiting for the next frame or for the consumers of the stage
+ * must not be included.
+ * @param frameTimeUs - processing time in microseconds.
+ */
+void QualityGovernor::reportFrameTime(uint64_t frameTimeUs)
+{
+    ++frameCount_;
+    maxFrameTimeUs_ = std::max(maxFrameTimeUs_, frameTimeUs);
+
+    if (frameTimeUs > frameBudgetUs_)
+    {
+        ++missedFrameCount_;
+    }
+
+    int level = level_;
+
+    if (missedFrameCount_ >= MISSES_TO_STEP_DOWN)
+    {
+        if (level < MAX_LEVEL)
+        {
+            setLevel(level + 1);
+        }
+        resetWindow();
+    }
+    else if (missedFrameCount_ > 0 && frameCount_ >= MISS_WINDOW_FRAMES)
+    {
+        // A few isolated misses, don't step down but they cancel the headroom window
+        resetWindow();
+    }
+    else if (frameCount_ >= HEADROOM_WINDOW_FRAMES)
+    {
+        if (level > 0 && maxFrameTimeUs_ < frameBudgetUs_ * HEADROOM_RATIO)
+        {
+            setLevel(level - 1);
+        }
+        resetWindow();
+    }
+}
+
+/**
+ * @brief Report a frame the stage could not deliver, it counts as a frame that missed its deadline.
+ */
+void QualityGovernor::reportDroppedFrame()
+{
+    reportFrameTime(std::numeric_limits<uint64_t>::max());
+}
+
+QualityLevel QualityGovernor::getLevel() const
+{
+    return static_cast<QualityLevel>(level_.load());
+}
+
+/**
+ * @brief Minimum time between the start of two detections.
+ */
+int QualityGovernor::getDetectionIntervalMs() const
+{
+    return getLevel() >= QualityLevel::REDUCED_DETECTION_RATE ? REDUCED_DETECTION_INTERVAL_MS : DETECTION_INTERVAL_MS;
+}
+
+/**
+ * @brief Scale applied to the dewarped virtual camera dimensions, the result is scaled back for display.
+ */
+float QualityGovernor::getVirtualCameraResolutionScale() const
+{
+    return getLevel() >= QualityLevel::REDUCED_VIRTUAL_CAMERA_RESOLUTION ? REDUCED_VIRTUAL_CAMERA_RESOLUTION_SCALE
+                                                                         : 1.f;
+}
+
+/**
+ * @brief Whether virtual cameras are dewarped with bilinear filtering or with the nearest pixel.
+ */
+bool QualityGovernor::isFilteringEnabled() const
+{
+    return getLevel() < QualityLevel::NEAREST_FILTERING;
+}
+
+int QualityGovernor::getMaxVirtualCameraCount() const
+{
+    return getLevel() >= QualityLevel::REDUCED_VIRTUAL_CAMERA_COUNT ? REDUCED_MAX_VIRTUAL_CAMERA_COUNT
+                                                                    : std::numeric_limits<int>::max();
+}
+
+void QualityGovernor::setLevel(int level)
+{
+    level_ = level;
+    std::cout << "Quality governor level " << level << " : " << getQualityLevelString(level) << std::endl;
+}
+
+void QualityGovernor::resetWindow()
+{
+    frameCount_ = 0;
+    missedFrameCount_ = 0;
+    maxFrameTimeUs_ = 0;
+}
+}    // namespace Model
@@ -0,0 +1,57 @@
+#ifndef QUALITY_GOVERNOR_H
+#define QUALITY_GOVERNOR_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace Model
+{
+/**
+ * @brief Degradation ladder, each level keeps the reductions of the previous ones.
+ */
+enum class QualityLevel
+{
+    FULL = 0,
+    REDUCED_DETECTION_RATE = 1,
+    REDUCED_VIRTUAL_CAMERA_RESOLUTION = 2,
+    NEAREST_FILTERING = 3,
+    REDUCED_VIRTUAL_CAMERA_COUNT = 4
+};
+
+/**
+ * @brief Watches the processing time of each frame of a stage against the frame budget (1 / fps) and trades image
+ * quality for a stable frame rate. Misses step the level down quickly, headroom steps it back up slowly
+ * (hysteresis). A governor belongs to one stage: frame times are only reported by the thread of that stage, the
+ * knobs can be read from any thread.
+ */
+class QualityGovernor
+{
+   public:
+    explicit QualityGovernor(int targetFps);
+
+    void reportFrameTime(uint64_t frameTimeUs);
+    void reportDroppedFrame();
+
+    QualityLevel getLevel() const;
+    int getDetectionIntervalMs() const;
+    float getVirtualCameraResolutionScale() const;
+    bool isFilteringEnabled() const;
+    int getMaxVirtualCameraCount() const;
+
+   private:
+    void setLevel(int level);
+    void resetWindow();
+
+    uint64_t frameBudgetUs_;
+
+    // Only used by the thread of the stage
+    int frameCount_;
+    int missedFrameCount_;
+    uint64_t maxFrameTimeUs_;
+
+    std::atomic<int> level_;
+};
+
+}    // namespace Model
+
+#endif    //! QUALITY_GOVERNOR_H
@@ -1,18 +1,24 @@
 #include "stream.h"
 
 #include "model/app_config.h"
+#include "model/audio_mixer/audio_mixer.h"
+#include "model/audio_suppresser/audio_suppresser.h"
 #include "model/stream/audio/audio_config.h"
+#include "model/stream/audio/file/async_file_audio_sink.h"
 #include "model/stream/audio/file/raw_file_audio_sink.h"
 #include "model/stream/audio/odas/odas_audio_source.h"
 #include "model/stream/audio/odas/odas_client.h"
 #include "model/stream/audio/odas/odas_position_source.h"
+#include "model/stream/audio/odas/odas_socket_reactor.h"
 #include "model/stream/audio/pulseaudio/pulseaudio_sink.h"
 #include "model/stream/stream_config.h"
 #include "model/stream/utils/images/images.h"
 #include "model/stream/utils/models/dim2.h"
+#include "model/stream/utils/models/rectangle.h"
 #include "model/stream/utils/models/spherical_angle_rect.h"
 #include "model/stream/utils/threads/lock_triple_buffer.h"
 #include "model/stream/utils/threads/readerwriterqueue.h"
+#include "model/stream/utils/time/media_clock.h"
 #include "model/stream/video/detection/darknet_config.h"
 #include "model/stream/video/dewarping/models/dewarping_config.h"
 #include "model/stream/video/impl/implementation_factory.h"
@@ -20,22 +26,54 @@
 #include "model/stream/video/output/virtual_camera_output.h"
 #include "model/stream/video/video_config.h"
 
+#include <cmath>
+#include <iostream>
 #include <string>
 #include <vector>
 
 #include <QCoreApplication>
+#include <QStandardPaths>
 
 namespace
 {
+// Display frames allocated at most, a frame is reused once the synchronizer, the mailbox and the output released it
 const int IMAGE_BUFFER_COUNT = 10;
-const int AUDIO_BUFFER_COUNT = 2;
+
+// Images held until the audio catches up, the dewarping thread keeps the other frames for itself and the mailbox
+const int SYNCHRONIZED_IMAGE_COUNT = IMAGE_BUFFER_COUNT - 4;
+
+// Labels of the allocations in the memory stats
+const char* FISHEYE_IMAGES_SUBSYSTEM = "fisheye images";
+const char* DETECTION_SUBSYSTEM = "detection images and mappings";
+const char* VIRTUAL_CAMERAS_SUBSYSTEM = "virtual camera buffers";
+const char* CAMERA_CAPTURES_SUBSYSTEM = "camera captures";
+
+// Audio is processed as soon as it is received, independently of the frame rate
+const int AUDIO_CHUNK_DURATION_MS = 10;
+const int AUDIO_BUFFER_COUNT = 8;
+
+// Mixed chunks are held by the sink jitter buffer until played, up to a few times its target latency
+const int MIXED_AUDIO_BUFFER_COUNT = 32;
 
 // TODO: config
 const int ODAS_AUDIO_PORT = 10030;
 const int ODAS_POSITION_PORT = 10020;
+const char* ODAS_AUDIO_SHM_SOCKET = "steno-odas-audio.sock";
+const char* ODAS_POSITION_SHM_SOCKET = "steno-odas-positions.sock";
 
 // TODO: config
 float CLASSIFIER_RANGE_THRESHOLD = 0.26f; // ~15 degrees
+
+// Time for a source to fade in or out when the speaker changes, short enough to not cut the first syllable
+const int AUDIO_SUPPRESSION_RAMP_MS = 5;
+
+// Output latency of configs saved before it was configurable, covers the network jitter of the odas stream
+const int DEFAULT_AUDIO_OUTPUT_TARGET_LATENCY_MS = 60;
+
+// Recordings of the mix in the output folder, the buffer absorbs the disk flushes
+const char* AUDIO_RECORDING_WAV_FILE = "steno-audio.wav";
+const char* AUDIO_RECORDING_RAW_FILE = "steno-audio.raw";
+const int AUDIO_RECORDING_BUFFER_MS = 2000;
 }
 
 namespace Model
@@ -43,6 +81,7 @@ namespace Model
 Stream::Stream(std::shared_ptr<Config> config)
     : m_state(IStream::State::Stopped)
     , m_mediaThread(nullptr)
+    , m_audioThread(nullptr)
     , m_config(config)
     , m_implementationFactory(false)
 {
@@ -66,7 +105,6 @@ Stream::Stream(std::shared_ptr<Config> config)
     {
         throw std::invalid_argument("Error in Stream - Fps cannot be 0");
     }
-    int audioChunkDurationMs = 1000 / fps;
 
     int sleepBetweenLayersForwardUs = darknetConfig->value(DarknetConfig::SLEEP_BETWEEN_LAYERS_FORWARD_US).toInt();
     std::string configFile =
@@ -76,37 +114,132 @@ Stream::Stream(std::shared_ptr<Config> config)
     std::string metaFile = (QCoreApplication::applicationDirPath() + "/../configs/yolo/cfg/coco.data").toStdString();
 
     m_imageBuffer = std::make_shared<LockTripleBuffer<RGBImage>>(RGBImage(resolution));
+    // Governs the dewarping stage, which reports its frame times. Detection and output only read its knobs
+    m_qualityGovernor = std::make_shared<QualityGovernor>(fps);
+
+    // The dewarping loop follows the camera captures, the output loop is paced on the frame clock
+    std::shared_ptr<FrameClock> frameClock = std::make_shared<FrameClock>(fps);
+
+    std::shared_ptr<MemoryAccounting> memoryAccounting = m_implementationFactory.getMemoryAccounting();
 
-    m_objectFactory = m_implementationFactory.getDetectionObjectFactory();
+    m_objectFactory = m_implementationFactory.getDetectionObjectFactory(FISHEYE_IMAGES_SUBSYSTEM);
     m_objectFactory->allocateObjectLockTripleBuffer(*m_imageBuffer);
 
     std::unique_ptr<DetectionThread> detectionThread = std::make_unique<DetectionThread>(
         m_imageBuffer,
         m_implementationFactory.getDetector(configFile, weightsFile, metaFile, sleepBetweenLayersForwardUs),
         m_implementationFactory.getDetectionFisheyeDewarper(aspectRatio),
-        m_implementationFactory.getDetectionObjectFactory(), m_implementationFactory.getDetectionSynchronizer(),
-        dewarpingConfig);
+        m_implementationFactory.getDetectionObjectFactory(DETECTION_SUBSYSTEM),
+        m_implementationFactory.getDetectionSynchronizer(),
+        dewarpingConfig, m_qualityGovernor);
 
-    std::shared_ptr<IPositionSource> odasPositionSource = std::make_shared<OdasPositionSource>(ODAS_POSITION_PORT);
+    // Both odas connections are served by the same socket thread, TCP unless odaslive supports shared memory
+    bool isOdasSharedMemory =
+        m_config->appConfig()->value(AppConfig::Key::ODAS_TRANSPORT).toString() == ODAS_TRANSPORT_SHARED_MEMORY;
+
+    // The sockets are in the runtime folder of the user unless configured otherwise, configs saved before it existed
+    // don't have the folder
+    QString odasSocketFolder = m_config->appConfig()->value(AppConfig::Key::ODAS_SOCKET_FOLDER).toString();
+    if (odasSocketFolder.isEmpty())
+    {
+        odasSocketFolder = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+    }
+    std::string odasSocketPrefix = odasSocketFolder.toStdString() + "/";
+
+    OdasEndpoint odasAudioEndpoint = isOdasSharedMemory
+                                         ? OdasEndpoint::sharedMemory(odasSocketPrefix + ODAS_AUDIO_SHM_SOCKET)
+                                         : OdasEndpoint::tcp(ODAS_AUDIO_PORT);
+    OdasEndpoint odasPositionEndpoint = isOdasSharedMemory
+                                            ? OdasEndpoint::sharedMemory(odasSocketPrefix + ODAS_POSITION_SHM_SOCKET)
+                                            : OdasEndpoint::tcp(ODAS_POSITION_PORT);
+
+    std::shared_ptr<OdasSocketReactor> odasReactor = std::make_shared<OdasSocketReactor>();
+    std::shared_ptr<MediaClock> mediaClock = std::make_shared<MediaClock>();
+    std::shared_ptr<IPositionSource> odasPositionSource =
+        std::make_shared<OdasPositionSource>(odasPositionEndpoint, odasReactor);
 
     std::shared_ptr<VirtualCameraManager> virtualCameraManager = std::make_shared<VirtualCameraManager>(aspectRatio, minElevation, maxElevation);
 
+    // Captures stay in their buffer through detection and dewarping, in pipeline buffers unless configured otherwise
+    QString captureMemoryName = m_config->appConfig()->value(AppConfig::Key::CAMERA_CAPTURE_MEMORY).toString();
+    CaptureMemory captureMemory = CaptureMemory::MMAP;
+    if (captureMemoryName == CAMERA_CAPTURE_MEMORY_USERPTR)
+    {
+        captureMemory = CaptureMemory::USERPTR;
+    }
+    else if (captureMemoryName == CAMERA_CAPTURE_MEMORY_DMABUF)
+    {
+        captureMemory = CaptureMemory::DMABUF;
+    }
+
+    // Only the bounding box of the fisheye circle is decoded from MJPEG captures, the dewarping never reads outside
+    int fisheyeRadius = static_cast<int>(std::ceil(dewarpingConfig->outRadius));
+    Rectangle fisheyeRegion(videoInputConfig->resolution.width / 2 - fisheyeRadius,
+                            videoInputConfig->resolution.height / 2 - fisheyeRadius, 2 * fisheyeRadius,
+                            2 * fisheyeRadius);
+
     std::unique_ptr<IVideoInput> dewarpedVideoInput = std::make_unique<DewarpedVideoInput>(
-        m_implementationFactory.getCameraReader(videoInputConfig), m_implementationFactory.getFisheyeDewarper(),
-        m_implementationFactory.getObjectFactory(), m_implementationFactory.getSynchronizer(),
+        m_implementationFactory.getCameraReader(videoInputConfig, captureMemory, fisheyeRegion,
+                                                CAMERA_CAPTURES_SUBSYSTEM),
+        m_implementationFactory.getFisheyeDewarper(),
+        m_implementationFactory.getObjectFactory(VIRTUAL_CAMERAS_SUBSYSTEM), m_implementationFactory.getSynchronizer(),
         virtualCameraManager, std::move(detectionThread), m_imageBuffer,
-        m_implementationFactory.getImageConverter(), odasPositionSource, dewarpingConfig, videoInputConfig, videoOutputConfig,
-        IMAGE_BUFFER_COUNT, CLASSIFIER_RANGE_THRESHOLD);
+        m_implementationFactory.getImageConverter(), odasPositionSource, m_implementationFactory.getTaskScheduler(),
+        m_qualityGovernor, memoryAccounting, dewarpingConfig, videoInputConfig, videoOutputConfig,
+        IMAGE_BUFFER_COUNT, CLASSIFIER_RANGE_THRESHOLD, DewarpedVideoInput::OutputMode::LATEST_FRAME);
+
+    // The video thread publishes the displayed virtual cameras and follows the audio timestamps
+    std::shared_ptr<SeqLock<ImagePositions>> imagePositions = std::make_shared<SeqLock<ImagePositions>>();
+    // Configs saved before the lip sync offset existed have none, the audio and video are matched as captured
+    int64_t lipSyncOffsetUs = static_cast<int64_t>(streamConfig->lipSyncOffsetMs) * 1000;
+    std::shared_ptr<MediaSynchronizer> mediaSynchronizer =
+        std::make_shared<MediaSynchronizer>(SYNCHRONIZED_IMAGE_COUNT, lipSyncOffsetUs);
 
     m_mediaThread = std::make_unique<MediaThread>(
-        std::make_unique<OdasAudioSource>(ODAS_AUDIO_PORT, audioChunkDurationMs, AUDIO_BUFFER_COUNT, audioInputConfig),
-        std::make_unique<PulseAudioSink>(audioOutputConfig),
-        odasPositionSource,
         std::move(dewarpedVideoInput),
         std::make_unique<VirtualCameraOutput>(videoOutputConfig),
         virtualCameraManager,
-        std::make_unique<MediaSynchronizer>(audioChunkDurationMs * 1000),
-        fps, CLASSIFIER_RANGE_THRESHOLD);
+        imagePositions,
+        mediaSynchronizer,
+        m_qualityGovernor,
+        frameClock);
+
+    // The mix is played on PulseAudio unless configured to be recorded, configs saved before the setting existed
+    // play it. The mixer converts once to the format the sink plays natively
+    QString audioOutput = m_config->appConfig()->value(AppConfig::Key::AUDIO_OUTPUT).toString();
+    std::unique_ptr<IAudioSink> audioSink;
+    if (audioOutput == AUDIO_OUTPUT_WAV_FILE || audioOutput == AUDIO_OUTPUT_RAW_FILE)
+    {
+        bool isWavFile = audioOutput == AUDIO_OUTPUT_WAV_FILE;
+        QString outputFolder = m_config->appConfig()->value(AppConfig::Key::OUTPUT_FOLDER).toString();
+        std::string recordingFile =
+            outputFolder.toStdString() + "/" + (isWavFile ? AUDIO_RECORDING_WAV_FILE : AUDIO_RECORDING_RAW_FILE);
+        audioSink = std::make_unique<AsyncFileAudioSink>(
+            recordingFile, isWavFile ? AsyncFileAudioSink::FileFormat::WAV : AsyncFileAudioSink::FileFormat::RAW,
+            AudioFormat::fromConfig(*audioOutputConfig), AUDIO_RECORDING_BUFFER_MS);
+    }
+    else
+    {
+        int audioOutputTargetLatencyMs = audioOutputConfig->targetLatencyMs > 0
+                                             ? audioOutputConfig->targetLatencyMs
+                                             : DEFAULT_AUDIO_OUTPUT_TARGET_LATENCY_MS;
+        audioSink = std::make_unique<PulseAudioSink>(audioOutputConfig, audioOutputTargetLatencyMs);
+    }
+    std::unique_ptr<AudioMixer> audioMixer =
+        std::make_unique<AudioMixer>(audioInputConfig->rate, audioSink->getNativeFormat(), MIXED_AUDIO_BUFFER_COUNT,
+                                     memoryAccounting);
+
+    m_audioThread = std::make_unique<AudioThread>(
+        std::make_unique<OdasAudioSource>(odasAudioEndpoint, AUDIO_CHUNK_DURATION_MS, AUDIO_BUFFER_COUNT,
+                                          audioInputConfig, mediaClock, odasReactor, memoryAccounting),
+        std::move(audioSink),
+        odasPositionSource,
+        imagePositions,
+        mediaSynchronizer,
+        std::make_unique<AudioSuppresser>(audioInputConfig->rate, AUDIO_SUPPRESSION_RAMP_MS),
+        std::move(audioMixer),
+        CLASSIFIER_RANGE_THRESHOLD);
+    m_audioThread->attach(this);
 
     m_odasClient = std::make_unique<OdasClient>(m_config->appConfig());
     m_odasClient->attach(this);
@@ -125,6 +258,7 @@ void Stream::start()
     if (m_state == IStream::State::Stopped)
     {
         m_mediaThread->start();
+        m_audioThread->start();
         m_odasClient->start();
         updateState(IStream::State::Started);
     }
@@ -149,6 +283,27 @@ void Stream::stop()
         m_mediaThread->join();
     }
 
+    if (m_audioThread->getState() != Thread::ThreadStatus::CRASHED)
+    {
+        m_audioThread->stop();
+        m_audioThread->join();
+    }
+
+    BlockPoolStats poolStats = m_implementationFactory.getBlockPool()->getStats();
+    std::cout << "Block pool: " << poolStats.allocationCount << " allocations, " << poolStats.reuseCount
+              << " reused, peak " << poolStats.peakLiveBytes / 1024 << " KB, " << poolStats.hugePageBytes / 1024
+              << " KB on huge pages, " << poolStats.madvisedBytes / 1024 << " KB advised" << std::endl;
+
+    MemoryStats memory = memoryStats();
+    std::cout << "Memory: " << memory.currentBytes / 1024 << " KB allocated, peak " << memory.peakBytes / 1024 << " KB"
+              << std::endl;
+    for (const SubsystemMemoryStats& subsystem : memory.subsystems)
+    {
+        std::cout << "    " << subsystem.subsystem << ": " << subsystem.currentBytes / 1024 << " KB in "
+                  << subsystem.currentCount << " allocations, peak " << subsystem.peakBytes / 1024 << " KB, "
+                  << subsystem.allocationCount << " allocations in total" << std::endl;
+    }
+
     updateState(IStream::State::Stopped);
 }
 
@@ -159,6 +314,7 @@ void Stream::join()
 {
     m_odasClient->join();
     m_mediaThread->join();
+    m_audioThread->join();
 }
 
 void Stream::updateState(const IStream::State& state)
@@ -174,7 +330,9 @@ void Stream::updateObserver()
 {
     const Thread::ThreadStatus odasClientState = m_odasClient->getState();
     const Thread::ThreadStatus mediaState = m_mediaThread->getState();
-    if (odasClientState == Thread::ThreadStatus::CRASHED || mediaState == Thread::ThreadStatus::CRASHED)
+    const Thread::ThreadStatus audioState = m_audioThread->getState();
+    if (odasClientState == Thread::ThreadStatus::CRASHED || mediaState == Thread::ThreadStatus::CRASHED ||
+        audioState == Thread::ThreadStatus::CRASHED)
     {
         stop();
     }
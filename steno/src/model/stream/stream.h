@@ -5,7 +5,9 @@
 
 #include "model/config/config.h"
 #include "model/stream/audio/odas/odas_client.h"
+#include "model/stream/audio_thread.h"
 #include "model/stream/media_thread.h"
+#include "model/stream/quality_governor.h"
 #include "model/stream/utils/alloc/i_object_factory.h"
 #include "model/stream/video/detection/detection_thread.h"
 #include "model/stream/video/impl/implementation_factory.h"
@@ -33,15 +35,27 @@ class Stream : public IStream, public IObserver
 
     void updateObserver() override;
 
+    QualityLevel qualityLevel() const
+    {
+        return m_qualityGovernor->getLevel();
+    }
+
+    MemoryStats memoryStats()
+    {
+        return m_implementationFactory.getMemoryAccounting()->getSnapshot();
+    }
+
    private:
     void updateState(const IStream::State& state);
 
     IStream::State m_state;
 
     std::unique_ptr<MediaThread> m_mediaThread;
+    std::unique_ptr<AudioThread> m_audioThread;
     std::unique_ptr<OdasClient> m_odasClient;
     std::unique_ptr<IObjectFactory> m_objectFactory;
     std::shared_ptr<LockTripleBuffer<RGBImage>> m_imageBuffer;
+    std::shared_ptr<QualityGovernor> m_qualityGovernor;
     std::shared_ptr<Config> m_config;
     ImplementationFactory m_implementationFactory;
 };
@@ -15,7 +15,8 @@ class StreamConfig : public BaseConfig
         ASPECT_RATIO_WIDTH,
         ASPECT_RATIO_HEIGHT,
         MIN_ELEVATION,
-        MAX_ELEVATION
+        MAX_ELEVATION,
+        LIP_SYNC_OFFSET_MS
     };
     Q_ENUM(Key)
 
@@ -31,12 +32,14 @@ class StreamConfig : public BaseConfig
         aspectRatioHeight = value(Key::ASPECT_RATIO_HEIGHT).toFloat();
         minElevation = math::deg2rad(value(Key::MIN_ELEVATION).toFloat());
         maxElevation = math::deg2rad(value(Key::MAX_ELEVATION).toFloat());
+        lipSyncOffsetMs = value(Key::LIP_SYNC_OFFSET_MS).toInt();
     }
 
     float aspectRatioWidth;
     float aspectRatioHeight;
     float minElevation;
     float maxElevation;
+    int lipSyncOffsetMs;    // Positive values show the video ahead of the audio
 };
 }    // namespace Model
 
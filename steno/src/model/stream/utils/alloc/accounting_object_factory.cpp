@@ -0,0 +1,95 @@
+#include "accounting_object_factory.h"
+
+#include <stdexcept>
+
+namespace Model
+{
+/**
+ * @param [IN] objectFactory - factory doing the allocations.
+ * @param [IN] memoryAccounting - where the allocations are recorded, can be shared by many factories.
+ * @param [IN] subsystem - label of the allocations in the memory stats.
+ */
+AccountingObjectFactory::AccountingObjectFactory(std::unique_ptr<IObjectFactory> objectFactory,
+                                                 std::shared_ptr<MemoryAccounting> memoryAccounting,
+                                                 const std::string& subsystem)
+    : objectFactory_(std::move(objectFactory))
+    , memoryAccounting_(memoryAccounting)
+    , subsystem_(subsystem)
+{
+    if (!objectFactory_ || !memoryAccounting_)
+    {
+        throw std::invalid_argument("Error in AccountingObjectFactory - Null is not a valid argument");
+    }
+}
+
+void AccountingObjectFactory::allocateObject(Image& image) const
+{
+    allocate(image);
+}
+
+void AccountingObjectFactory::deallocateObject(Image& image) const
+{
+    deallocate(image);
+}
+
+void AccountingObjectFactory::allocateObject(ImageFloat& image) const
+{
+    allocate(image);
+}
+
+void AccountingObjectFactory::deallocateObject(ImageFloat& image) const
+{
+    deallocate(image);
+}
+
+void AccountingObjectFactory::allocateObject(DewarpingMapping& mapping) const
+{
+    allocate(mapping);
+}
+
+void AccountingObjectFactory::deallocateObject(DewarpingMapping& mapping) const
+{
+    deallocate(mapping);
+}
+
+void AccountingObjectFactory::allocateObject(FilteredDewarpingMapping& mapping) const
+{
+    allocate(mapping);
+}
+
+void AccountingObjectFactory::deallocateObject(FilteredDewarpingMapping& mapping) const
+{
+    deallocate(mapping);
+}
+
+void AccountingObjectFactory::releaseUnusedMemory() const
+{
+    objectFactory_->releaseUnusedMemory();
+}
+
+/**
+ * @brief Objects hold size elements of their data type, the bytes are the same whatever the factory.
+ */
+template <typename T>
+void AccountingObjectFactory::allocate(T& object) const
+{
+    objectFactory_->allocateObject(object);
+    memoryAccounting_->recordAllocation(subsystem_, object.size * sizeof(*object.hostData));
+}
+
+/**
+ * @brief Objects never allocated, or already deallocated, are not recorded.
+ */
+template <typename T>
+void AccountingObjectFactory::deallocate(T& object) const
+{
+    bool isAllocated = object.hostData != nullptr || object.deviceData != nullptr;
+    objectFactory_->deallocateObject(object);
+
+    if (isAllocated)
+    {
+        memoryAccounting_->recordDeallocation(subsystem_, object.size * sizeof(*object.hostData));
+    }
+}
+
+}    // namespace Model
@@ -0,0 +1,49 @@
+#ifndef ACCOUNTING_OBJECT_FACTORY_H
+#define ACCOUNTING_OBJECT_FACTORY_H
+
+#include <memory>
+#include <string>
+
+#include "model/stream/utils/alloc/i_object_factory.h"
+#include "model/stream/utils/alloc/memory_accounting.h"
+
+namespace Model
+{
+/**
+ * @brief Records the objects allocated through another factory under a subsystem label.
+ */
+class AccountingObjectFactory : public IObjectFactory
+{
+   public:
+    AccountingObjectFactory(std::unique_ptr<IObjectFactory> objectFactory,
+                            std::shared_ptr<MemoryAccounting> memoryAccounting, const std::string& subsystem);
+
+    void allocateObject(Image& image) const override;
+    void deallocateObject(Image& image) const override;
+
+    void allocateObject(ImageFloat& image) const override;
+    void deallocateObject(ImageFloat& image) const override;
+
+    void allocateObject(DewarpingMapping& mapping) const override;
+    void deallocateObject(DewarpingMapping& mapping) const override;
+
+    void allocateObject(FilteredDewarpingMapping& mapping) const override;
+    void deallocateObject(FilteredDewarpingMapping& mapping) const override;
+
+    void releaseUnusedMemory() const override;
+
+   private:
+    template <typename T>
+    void allocate(T& object) const;
+
+    template <typename T>
+    void deallocate(T& object) const;
+
+    std::unique_ptr<IObjectFactory> objectFactory_;
+    std::shared_ptr<MemoryAccounting> memoryAccounting_;
+    std::string subsystem_;
+};
+
+}    // namespace Model
+
+#endif    //! ACCOUNTING_OBJECT_FACTORY_H
@@ -0,0 +1,274 @@
+#include "block_pool.h"
+
+#include <sys/mman.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+
+namespace
+{
+const std::size_t BLOCK_ALIGNMENT = 64;
+const std::size_t MIN_SIZE_CLASS = 64;
+
+// Blocks of a huge page or more are mapped, the smaller ones share the pages of the heap
+const std::size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+std::size_t roundUp(std::size_t size, std::size_t multiple)
+{
+    return (size + multiple - 1) / multiple * multiple;
+}
+}    // namespace
+
+namespace Model
+{
+/**
+ * @param [IN] useHugePages - map large blocks on huge pages, or on pages advised for transparent huge pages if the
+ * system has no huge pages reserved.
+ */
+BlockPool::BlockPool(bool useHugePages)
+    : useHugePages_(useHugePages)
+    , liveBlockCount_(0)
+{
+}
+
+BlockPool::~BlockPool()
+{
+    trim();
+
+    if (liveBlockCount_ > 0)
+    {
+        std::cout << "BlockPool destroyed with " << liveBlockCount_ << " blocks still allocated" << std::endl;
+    }
+}
+
+/**
+ * @brief Get a block of at least size bytes, aligned on a cache line.
+ */
+void* BlockPool::allocate(std::size_t size)
+{
+    std::size_t sizeClass = getSizeClass(size);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::size_t slot = 0;
+
+    std::vector<std::size_t>& pooled = pooledSlots_[sizeClass];
+    if (!pooled.empty())
+    {
+        slot = pooled.back();
+        pooled.pop_back();
+        stats_.pooledBytes -= sizeClass;
+        ++stats_.reuseCount;
+    }
+    else
+    {
+        BlockKind kind = BlockKind::HEAP;
+        void* block = allocateBlock(sizeClass, kind);
+        addKindBytes(kind, sizeClass, true);
+        slot = addSlot({block, sizeClass, kind});
+    }
+
+    liveSlots_[slot] = true;
+    ++liveBlockCount_;
+    ++stats_.allocationCount;
+    stats_.liveBytes += sizeClass;
+    stats_.peakLiveBytes = std::max(stats_.peakLiveBytes, stats_.liveBytes);
+
+    return blocks_[slot].block;
+}
+
+/**
+ * @brief Keep a block for the next allocation of its size class.
+ */
+void BlockPool::deallocate(void* block)
+{
+    if (block == nullptr)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = blockSlots_.find(block);
+    if (it == blockSlots_.end() || !liveSlots_[it->second])
+    {
+        throw std::invalid_argument("Error in BlockPool - the block was not allocated by this pool");
+    }
+
+    std::size_t slot = it->second;
+    std::size_t sizeClass = blocks_[slot].sizeClass;
+    liveSlots_[slot] = false;
+    --liveBlockCount_;
+
+    pooledSlots_[sizeClass].push_back(slot);
+    stats_.liveBytes -= sizeClass;
+    stats_.pooledBytes += sizeClass;
+}
+
+/**
+ * @brief Return the released blocks to the system.
+ */
+void BlockPool::trim()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    for (auto& pooled : pooledSlots_)
+    {
+        for (std::size_t slot : pooled.second)
+        {
+            BlockInfo& info = blocks_[slot];
+            freeBlock(info);
+            addKindBytes(info.kind, info.sizeClass, false);
+
+            blockSlots_.erase(info.block);
+            info.block = nullptr;
+            freeSlots_.push_back(slot);
+        }
+    }
+
+    pooledSlots_.clear();
+    stats_.pooledBytes = 0;
+}
+
+BlockPoolStats BlockPool::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+/**
+ * @brief Four classes per power of two below a huge page, whole huge pages above, at most 25% is wasted below.
+ */
+std::size_t BlockPool::getSizeClass(std::size_t size)
+{
+    if (size <= MIN_SIZE_CLASS)
+    {
+        return MIN_SIZE_CLASS;
+    }
+
+    if (size >= HUGE_PAGE_SIZE)
+    {
+        return roundUp(size, HUGE_PAGE_SIZE);
+    }
+
+    std::size_t powerOfTwo = MIN_SIZE_CLASS;
+    while (powerOfTwo * 2 < size)
+    {
+        powerOfTwo *= 2;
+    }
+
+    return roundUp(size, powerOfTwo / 4);
+}
+
+void* BlockPool::allocateBlock(std::size_t sizeClass, BlockKind& outKind)
+{
+    if (sizeClass < HUGE_PAGE_SIZE)
+    {
+        void* block = nullptr;
+        if (posix_memalign(&block, BLOCK_ALIGNMENT, sizeClass) != 0)
+        {
+            throw std::bad_alloc();
+        }
+
+        outKind = BlockKind::HEAP;
+        return block;
+    }
+
+    if (useHugePages_)
+    {
+        void* block = mmap(nullptr, sizeClass, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (block != MAP_FAILED)
+        {
+            outKind = BlockKind::HUGE_PAGES;
+            return block;
+        }
+    }
+
+    // Transparent huge pages only back the 2 MB aligned ranges of a mapping, the extra pages around it are unmapped
+    std::size_t mappedSize = sizeClass + HUGE_PAGE_SIZE;
+    void* mapping = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED)
+    {
+        throw std::bad_alloc();
+    }
+
+    uintptr_t mappingStart = reinterpret_cast<uintptr_t>(mapping);
+    uintptr_t blockStart = roundUp(mappingStart, HUGE_PAGE_SIZE);
+    std::size_t headSize = blockStart - mappingStart;
+    std::size_t tailSize = mappedSize - headSize - sizeClass;
+
+    if (headSize > 0)
+    {
+        munmap(mapping, headSize);
+    }
+    if (tailSize > 0)
+    {
+        munmap(reinterpret_cast<void*>(blockStart + sizeClass), tailSize);
+    }
+
+    void* block = reinterpret_cast<void*>(blockStart);
+    outKind = BlockKind::HEAP;
+    if (useHugePages_ && madvise(block, sizeClass, MADV_HUGEPAGE) == 0)
+    {
+        outKind = BlockKind::MADVISED;
+    }
+
+    return block;
+}
+
+void BlockPool::freeBlock(const BlockInfo& info)
+{
+    if (info.sizeClass < HUGE_PAGE_SIZE)
+    {
+        free(info.block);
+    }
+    else
+    {
+        munmap(info.block, info.sizeClass);
+    }
+}
+
+/**
+ * @return slot of a block taken from the system, the slots of trimmed blocks are used first.
+ */
+std::size_t BlockPool::addSlot(const BlockInfo& info)
+{
+    std::size_t slot = blocks_.size();
+    if (!freeSlots_.empty())
+    {
+        slot = freeSlots_.back();
+        freeSlots_.pop_back();
+        blocks_[slot] = info;
+    }
+    else
+    {
+        blocks_.push_back(info);
+        liveSlots_.push_back(false);
+    }
+
+    blockSlots_[info.block] = slot;
+    return slot;
+}
+
+void BlockPool::addKindBytes(BlockKind kind, std::size_t sizeClass, bool isAdded)
+{
+    std::size_t* kindBytes = nullptr;
+    if (kind == BlockKind::HUGE_PAGES)
+    {
+        kindBytes = &stats_.hugePageBytes;
+    }
+    else if (kind == BlockKind::MADVISED)
+    {
+        kindBytes = &stats_.madvisedBytes;
+    }
+
+    if (kindBytes != nullptr)
+    {
+        *kindBytes = isAdded ? *kindBytes + sizeClass : *kindBytes - sizeClass;
+    }
+}
+
+}    // namespace Model
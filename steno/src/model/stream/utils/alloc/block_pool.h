@@ -0,0 +1,87 @@
+#ifndef BLOCK_POOL_H
+#define BLOCK_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Model
+{
+struct BlockPoolStats
+{
+    uint64_t allocationCount = 0;
+    uint64_t reuseCount = 0;           // Allocations served by a released block of the same size class
+    std::size_t liveBytes = 0;         // Size classes of the blocks in use
+    std::size_t peakLiveBytes = 0;
+    std::size_t pooledBytes = 0;       // Released blocks kept for reuse
+    std::size_t hugePageBytes = 0;     // Mapped on explicit huge pages, part of the live and pooled bytes
+    std::size_t madvisedBytes = 0;     // Mapped on pages advised for transparent huge pages
+};
+
+/**
+ * @brief Thread safe pool of 64 bytes aligned blocks. Sizes are rounded up to a size class (four per power of two),
+ * a released block is kept and handed out again for the same class. Large blocks are mapped in multiples of 2 MB,
+ * on huge pages if available, otherwise on aligned pages advised for transparent huge pages, so gathers on images and
+ * mappings do not miss the TLB every 4 KB.
+ */
+class BlockPool
+{
+   public:
+    explicit BlockPool(bool useHugePages);
+    ~BlockPool();
+
+    BlockPool(const BlockPool&) = delete;
+    BlockPool& operator=(const BlockPool&) = delete;
+
+    void* allocate(std::size_t size);
+    void deallocate(void* block);
+    void trim();
+
+    BlockPoolStats getStats() const;
+
+   private:
+    enum class BlockKind
+    {
+        HEAP,
+        HUGE_PAGES,
+        MADVISED
+    };
+
+    struct BlockInfo
+    {
+        void* block;
+        std::size_t sizeClass;
+        BlockKind kind;
+    };
+
+    static std::size_t getSizeClass(std::size_t size);
+    void* allocateBlock(std::size_t sizeClass, BlockKind& outKind);
+    void freeBlock(const BlockInfo& info);
+    std::size_t addSlot(const BlockInfo& info);
+    void addKindBytes(BlockKind kind, std::size_t sizeClass, bool isAdded);
+
+    bool useHugePages_;
+
+    mutable std::mutex mutex_;
+
+    // Blocks taken from the system, indexed by slot. A block keeps its slot until it is trimmed, handing it out again
+    // only sets its live bit
+    std::vector<BlockInfo> blocks_;
+    std::vector<bool> liveSlots_;
+    std::vector<std::size_t> freeSlots_;
+    std::size_t liveBlockCount_;
+
+    // Slot of each block, only added to when a block is taken from the system
+    std::unordered_map<void*, std::size_t> blockSlots_;
+
+    // Slots of the released blocks of each size class
+    std::unordered_map<std::size_t, std::vector<std::size_t>> pooledSlots_;
+
+    BlockPoolStats stats_;
+};
+
+}    // namespace Model
+
+#endif    //! BLOCK_POOL_H
@@ -0,0 +1,99 @@
+#include "frame_pool.h"
+
+#include <stdexcept>
+
+namespace Model
+{
+/**
+ * @param [IN] frameFormat - dimensions and format of the frames, its buffers are ignored.
+ * @param [IN] maxFrameCount - frames allocated at most, bounds the frames in flight between the producer and the
+ * consumers.
+ */
+FramePool::FramePool(std::shared_ptr<IObjectFactory> objectFactory, const Image& frameFormat,
+                     std::size_t maxFrameCount)
+    : objectFactory_(objectFactory)
+    , frameFormat_(frameFormat)
+    , maxFrameCount_(maxFrameCount)
+{
+    if (!objectFactory_)
+    {
+        throw std::invalid_argument("Error in FramePool - Null is not a valid object factory");
+    }
+
+    if (maxFrameCount_ == 0)
+    {
+        throw std::invalid_argument("Error in FramePool - need at least one frame");
+    }
+
+    frameFormat_.hostData = nullptr;
+    frameFormat_.deviceData = nullptr;
+
+    // Recycling never allocates, it can happen in any destructor
+    frames_.reserve(maxFrameCount_);
+    freeFrames_.reserve(maxFrameCount_);
+}
+
+/**
+ * @brief Every frame is free, the ones still referenced keep the pool alive.
+ */
+FramePool::~FramePool()
+{
+    for (std::unique_ptr<FrameBuffer>& frame : frames_)
+    {
+        objectFactory_->deallocateObject(frame->image);
+    }
+}
+
+/**
+ * @brief Get a free frame, allocating it if the pool has not reached its maximum.
+ * @return false if every frame is held.
+ */
+bool FramePool::tryAcquire(FrameRef& outFrame)
+{
+    FrameBuffer* buffer = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (!freeFrames_.empty())
+        {
+            buffer = freeFrames_.back();
+            freeFrames_.pop_back();
+        }
+        else if (frames_.size() < maxFrameCount_)
+        {
+            std::unique_ptr<FrameBuffer> frame = std::make_unique<FrameBuffer>(frameFormat_);
+            objectFactory_->allocateObject(frame->image);
+            buffer = frame.get();
+            frames_.push_back(std::move(frame));
+        }
+        else
+        {
+            ++stats_.exhaustedCount;
+            return false;
+        }
+
+        ++stats_.acquiredCount;
+    }
+
+    outFrame = FrameRef(buffer, shared_from_this());
+    return true;
+}
+
+void FramePool::recycle(FrameBuffer* buffer)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    freeFrames_.push_back(buffer);
+}
+
+FramePoolStats FramePool::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    FramePoolStats stats = stats_;
+    stats.frameCount = frames_.size();
+    stats.freeFrameCount = freeFrames_.size();
+    return stats;
+}
+
+}    // namespace Model
@@ -0,0 +1,54 @@
+#ifndef FRAME_POOL_H
+#define FRAME_POOL_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "model/stream/utils/alloc/i_object_factory.h"
+#include "model/stream/utils/images/frame_ref.h"
+
+namespace Model
+{
+struct FramePoolStats
+{
+    std::size_t frameCount = 0;        // Buffers allocated, at most the maximum frame count
+    std::size_t freeFrameCount = 0;
+    uint64_t acquiredCount = 0;
+    uint64_t exhaustedCount = 0;       // Acquisitions that failed, every frame was held by the consumers
+};
+
+/**
+ * @brief Frames of one format, a buffer is allocated only when every other one is held, up to a maximum, and is
+ * back in the pool when its last reference is released. Must be created with std::make_shared, frames keep their
+ * pool alive.
+ */
+class FramePool : public IFrameRecycler, public std::enable_shared_from_this<FramePool>
+{
+   public:
+    FramePool(std::shared_ptr<IObjectFactory> objectFactory, const Image& frameFormat, std::size_t maxFrameCount);
+    ~FramePool() override;
+
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    bool tryAcquire(FrameRef& outFrame);
+    void recycle(FrameBuffer* buffer) override;
+
+    FramePoolStats getStats() const;
+
+   private:
+    std::shared_ptr<IObjectFactory> objectFactory_;
+    Image frameFormat_;
+    std::size_t maxFrameCount_;
+
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<FrameBuffer>> frames_;
+    std::vector<FrameBuffer*> freeFrames_;
+    FramePoolStats stats_;
+};
+
+}    // namespace Model
+
+#endif    //! FRAME_POOL_H
@@ -24,6 +24,11 @@ class IObjectFactory
     virtual void allocateObject(FilteredDewarpingMapping& mapping) const = 0;
     virtual void deallocateObject(FilteredDewarpingMapping& mapping) const = 0;
 
+    // Give the memory of the deallocated objects back to the system, for factories that keep it for reuse
+    virtual void releaseUnusedMemory() const
+    {
+    }
+
     template <typename T>
     void allocateObjectDualBuffer(DualBuffer<T>& buffer) const
     {
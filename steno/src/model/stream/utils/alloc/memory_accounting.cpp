@@ -0,0 +1,63 @@
+#include "memory_accounting.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace Model
+{
+MemoryAccounting::MemoryAccounting()
+    : currentBytes_(0)
+    , peakBytes_(0)
+{
+}
+
+void MemoryAccounting::recordAllocation(const std::string& subsystem, std::size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    SubsystemMemoryStats& stats = subsystems_[subsystem];
+    stats.subsystem = subsystem;
+    stats.currentBytes += bytes;
+    stats.peakBytes = std::max(stats.peakBytes, stats.currentBytes);
+    ++stats.currentCount;
+    ++stats.allocationCount;
+
+    currentBytes_ += bytes;
+    peakBytes_ = std::max(peakBytes_, currentBytes_);
+}
+
+void MemoryAccounting::recordDeallocation(const std::string& subsystem, std::size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = subsystems_.find(subsystem);
+    if (it == subsystems_.end() || it->second.currentCount == 0 || it->second.currentBytes < bytes)
+    {
+        throw std::invalid_argument("Error in MemoryAccounting - " + subsystem + " released more than it allocated");
+    }
+
+    it->second.currentBytes -= bytes;
+    --it->second.currentCount;
+    currentBytes_ -= bytes;
+}
+
+/**
+ * @brief Subsystems sorted by label, the ones that released everything are kept for their peak.
+ */
+MemoryStats MemoryAccounting::getSnapshot() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    MemoryStats snapshot;
+    snapshot.subsystems.reserve(subsystems_.size());
+    for (const auto& entry : subsystems_)
+    {
+        snapshot.subsystems.push_back(entry.second);
+    }
+    snapshot.currentBytes = currentBytes_;
+    snapshot.peakBytes = peakBytes_;
+
+    return snapshot;
+}
+
+}    // namespace Model
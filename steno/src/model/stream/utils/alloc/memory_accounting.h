@@ -0,0 +1,53 @@
+#ifndef MEMORY_ACCOUNTING_H
+#define MEMORY_ACCOUNTING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Model
+{
+struct SubsystemMemoryStats
+{
+    std::string subsystem;
+    std::size_t currentBytes = 0;
+    std::size_t peakBytes = 0;
+    uint64_t currentCount = 0;       // Allocations not released yet
+    uint64_t allocationCount = 0;    // Allocations since the start
+};
+
+struct MemoryStats
+{
+    std::vector<SubsystemMemoryStats> subsystems;
+    std::size_t currentBytes = 0;
+    std::size_t peakBytes = 0;    // High water mark of the sum, not the sum of the subsystem peaks
+};
+
+/**
+ * @brief Bytes allocated by each subsystem of the stream (images, mappings, virtual camera buffers, audio rings),
+ * with their high water marks. Allocations are recorded with a subsystem label, either by an AccountingObjectFactory
+ * or by the owner of a buffer allocated otherwise. Thread safe.
+ */
+class MemoryAccounting
+{
+   public:
+    MemoryAccounting();
+
+    void recordAllocation(const std::string& subsystem, std::size_t bytes);
+    void recordDeallocation(const std::string& subsystem, std::size_t bytes);
+
+    MemoryStats getSnapshot() const;
+
+   private:
+    mutable std::mutex mutex_;
+    std::map<std::string, SubsystemMemoryStats> subsystems_;
+    std::size_t currentBytes_;
+    std::size_t peakBytes_;
+};
+
+}    // namespace Model
+
+#endif    //! MEMORY_ACCOUNTING_H
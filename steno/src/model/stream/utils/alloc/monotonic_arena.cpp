@@ -0,0 +1,112 @@
+#include "monotonic_arena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+
+namespace Model
+{
+/**
+ * @param [IN] capacity - bytes available to a frame before allocations fall back on the heap.
+ */
+MonotonicArena::MonotonicArena(std::size_t capacity)
+    : buffer_(new unsigned char[capacity])
+    , capacity_(capacity)
+    , usedBytes_(0)
+    , overflowBytes_(0)
+    , liveAllocationCount_(0)
+{
+    if (capacity == 0)
+    {
+        throw std::invalid_argument("Error in MonotonicArena - Capacity must be positive");
+    }
+
+    stats_.capacity = capacity;
+}
+
+void* MonotonicArena::allocate(std::size_t size, std::size_t alignment)
+{
+    uintptr_t bufferStart = reinterpret_cast<uintptr_t>(buffer_.get());
+    uintptr_t blockStart = (bufferStart + usedBytes_ + alignment - 1) / alignment * alignment;
+    std::size_t blockEnd = blockStart - bufferStart + size;
+
+    void* block = nullptr;
+    if (blockEnd <= capacity_)
+    {
+        block = reinterpret_cast<void*>(blockStart);
+        usedBytes_ = blockEnd;
+    }
+    else
+    {
+        block = ::operator new(size);
+        overflowBytes_ += size;
+        ++stats_.overflowCount;
+    }
+
+    ++liveAllocationCount_;
+    stats_.peakUsedBytes = std::max(stats_.peakUsedBytes, usedBytes_ + overflowBytes_);
+
+    return block;
+}
+
+/**
+ * @brief Memory of the arena is only reclaimed by reset(), heap fallbacks are freed right away.
+ */
+void MonotonicArena::deallocate(void* block)
+{
+    if (block == nullptr)
+    {
+        return;
+    }
+
+    if (!isInBuffer(block))
+    {
+        ::operator delete(block);
+    }
+
+    --liveAllocationCount_;
+}
+
+/**
+ * @brief Release every allocation of the frame, the containers using the arena must be destroyed before. If the frame
+ * overflowed, the arena is enlarged to hold it entirely next time.
+ */
+void MonotonicArena::reset()
+{
+    if (liveAllocationCount_ != 0)
+    {
+        throw std::runtime_error("Error in MonotonicArena - Reset while allocations of the frame are still in use");
+    }
+
+    if (overflowBytes_ > 0)
+    {
+        std::size_t requiredBytes = usedBytes_ + overflowBytes_;
+        std::size_t capacity = capacity_;
+        while (capacity < requiredBytes)
+        {
+            capacity *= 2;
+        }
+
+        buffer_.reset(new unsigned char[capacity]);
+        capacity_ = capacity;
+        stats_.capacity = capacity;
+        ++stats_.growCount;
+    }
+
+    usedBytes_ = 0;
+    overflowBytes_ = 0;
+}
+
+ArenaStats MonotonicArena::getStats() const
+{
+    return stats_;
+}
+
+bool MonotonicArena::isInBuffer(const void* block) const
+{
+    const unsigned char* data = static_cast<const unsigned char*>(block);
+    return data >= buffer_.get() && data < buffer_.get() + capacity_;
+}
+
+}    // namespace Model
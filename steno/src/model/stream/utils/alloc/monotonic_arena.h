@@ -0,0 +1,129 @@
+#ifndef MONOTONIC_ARENA_H
+#define MONOTONIC_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Model
+{
+struct ArenaStats
+{
+    std::size_t capacity = 0;
+    std::size_t peakUsedBytes = 0;    // Most bytes allocated in a frame, heap fallbacks included
+    uint64_t overflowCount = 0;       // Allocations that did not fit in the arena and were taken from the heap
+    uint64_t growCount = 0;           // Resets that enlarged the arena after a frame overflowed
+};
+
+/**
+ * @brief Bump allocator for the transient data of a frame, released all at once by reset() when the frame is done.
+ * An allocation that does not fit is taken from the heap and the arena grows on the next reset, so after the first
+ * frames the loop using it performs no heap allocation. Used by a single thread.
+ */
+class MonotonicArena
+{
+   public:
+    explicit MonotonicArena(std::size_t capacity);
+
+    MonotonicArena(const MonotonicArena&) = delete;
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+    void* allocate(std::size_t size, std::size_t alignment);
+    void deallocate(void* block);
+    void reset();
+
+    ArenaStats getStats() const;
+
+   private:
+    bool isInBuffer(const void* block) const;
+
+    std::unique_ptr<unsigned char[]> buffer_;
+    std::size_t capacity_;
+    std::size_t usedBytes_;
+    std::size_t overflowBytes_;
+    int liveAllocationCount_;
+
+    ArenaStats stats_;
+};
+
+/**
+ * @brief Standard allocator drawing from a MonotonicArena, or from the heap when constructed without arena. Like a
+ * polymorphic allocator, a copied container does not follow the arena of the original, it allocates on the heap.
+ */
+template <typename T>
+class ArenaAllocator
+{
+   public:
+    using value_type = T;
+
+    ArenaAllocator() noexcept
+        : arena_(nullptr)
+    {
+    }
+
+    ArenaAllocator(MonotonicArena& arena) noexcept
+        : arena_(&arena)
+    {
+    }
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept
+        : arena_(other.getArena())
+    {
+    }
+
+    T* allocate(std::size_t count)
+    {
+        if (arena_ == nullptr)
+        {
+            return static_cast<T*>(::operator new(count * sizeof(T)));
+        }
+
+        return static_cast<T*>(arena_->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* data, std::size_t) noexcept
+    {
+        if (arena_ == nullptr)
+        {
+            ::operator delete(data);
+        }
+        else
+        {
+            arena_->deallocate(data);
+        }
+    }
+
+    ArenaAllocator select_on_container_copy_construction() const noexcept
+    {
+        return ArenaAllocator();
+    }
+
+    MonotonicArena* getArena() const noexcept
+    {
+        return arena_;
+    }
+
+   private:
+    MonotonicArena* arena_;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) noexcept
+{
+    return lhs.getArena() == rhs.getArena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) noexcept
+{
+    return !(lhs == rhs);
+}
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+}    // namespace Model
+
+#endif    //! MONOTONIC_ARENA_H
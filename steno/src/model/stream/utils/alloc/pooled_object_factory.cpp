@@ -0,0 +1,87 @@
+#include "pooled_object_factory.h"
+
+#include <stdexcept>
+#include <type_traits>
+
+namespace Model
+{
+PooledObjectFactory::PooledObjectFactory(std::shared_ptr<BlockPool> blockPool)
+    : blockPool_(blockPool)
+{
+    if (!blockPool_)
+    {
+        throw std::invalid_argument("Error in PooledObjectFactory - Null is not a valid block pool");
+    }
+}
+
+void PooledObjectFactory::allocateObject(Image& image) const
+{
+    allocate(image.hostData, image.size);
+}
+
+void PooledObjectFactory::deallocateObject(Image& image) const
+{
+    deallocate(image.hostData);
+}
+
+void PooledObjectFactory::allocateObject(ImageFloat& image) const
+{
+    allocate(image.hostData, image.size);
+}
+
+void PooledObjectFactory::deallocateObject(ImageFloat& image) const
+{
+    deallocate(image.hostData);
+}
+
+void PooledObjectFactory::allocateObject(DewarpingMapping& mapping) const
+{
+    allocate(mapping.hostData, mapping.size);
+}
+
+void PooledObjectFactory::deallocateObject(DewarpingMapping& mapping) const
+{
+    deallocate(mapping.hostData);
+}
+
+void PooledObjectFactory::allocateObject(FilteredDewarpingMapping& mapping) const
+{
+    allocate(mapping.hostData, mapping.size);
+}
+
+void PooledObjectFactory::deallocateObject(FilteredDewarpingMapping& mapping) const
+{
+    deallocate(mapping.hostData);
+}
+
+/**
+ * @brief Trim the pool, the blocks released by every factory sharing it are freed.
+ */
+void PooledObjectFactory::releaseUnusedMemory() const
+{
+    blockPool_->trim();
+}
+
+BlockPoolStats PooledObjectFactory::getStats() const
+{
+    return blockPool_->getStats();
+}
+
+/**
+ * @brief Blocks are raw memory, like new T[size] the elements are not initialized.
+ */
+template <typename T>
+void PooledObjectFactory::allocate(T*& ptr, std::size_t size) const
+{
+    static_assert(std::is_trivially_destructible<T>::value, "Pooled objects are never destroyed");
+    ptr = static_cast<T*>(blockPool_->allocate(size * sizeof(T)));
+}
+
+template <typename T>
+void PooledObjectFactory::deallocate(T*& ptr) const
+{
+    blockPool_->deallocate(ptr);
+    ptr = nullptr;
+}
+
+}    // namespace Model
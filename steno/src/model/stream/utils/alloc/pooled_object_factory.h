@@ -0,0 +1,48 @@
+#ifndef POOLED_OBJECT_FACTORY_H
+#define POOLED_OBJECT_FACTORY_H
+
+#include <memory>
+
+#include "model/stream/utils/alloc/block_pool.h"
+#include "model/stream/utils/alloc/i_object_factory.h"
+
+namespace Model
+{
+/**
+ * @brief Allocates the objects in blocks of a pool, which can be shared by many factories. Buffers released by one
+ * part of the pipeline are reused by the next allocation of the same size.
+ */
+class PooledObjectFactory : public IObjectFactory
+{
+   public:
+    explicit PooledObjectFactory(std::shared_ptr<BlockPool> blockPool);
+
+    void allocateObject(Image& image) const override;
+    void deallocateObject(Image& image) const override;
+
+    void allocateObject(ImageFloat& image) const override;
+    void deallocateObject(ImageFloat& image) const override;
+
+    void allocateObject(DewarpingMapping& mapping) const override;
+    void deallocateObject(DewarpingMapping& mapping) const override;
+
+    void allocateObject(FilteredDewarpingMapping& mapping) const override;
+    void deallocateObject(FilteredDewarpingMapping& mapping) const override;
+
+    void releaseUnusedMemory() const override;
+
+    BlockPoolStats getStats() const;
+
+   private:
+    template <typename T>
+    void allocate(T*& ptr, std::size_t size) const;
+
+    template <typename T>
+    void deallocate(T*& ptr) const;
+
+    std::shared_ptr<BlockPool> blockPool_;
+};
+
+}    // namespace Model
+
+#endif    //! POOLED_OBJECT_FACTORY_H
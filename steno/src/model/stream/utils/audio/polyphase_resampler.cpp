@@ -0,0 +1,277 @@
+#include "polyphase_resampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include "model/stream/utils/audio/sample_conversion.h"
+#include "model/stream/utils/math/math_constants.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define POLYPHASE_RESAMPLER_AVX2
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define POLYPHASE_RESAMPLER_NEON
+#endif
+
+namespace Model
+{
+namespace audio
+{
+namespace
+{
+// Sinc zero crossings on each side of the center, sets the transition band width
+const int FILTER_ZERO_CROSSINGS = 16;
+
+// Cutoff relative to the lowest Nyquist frequency, leaves room for the transition band
+const double FILTER_CUTOFF_RATIO = 0.92;
+
+// About 80 dB of stop band attenuation
+const double KAISER_BETA = 8.0;
+
+// Taps are padded to a whole number of vectors
+const std::size_t TAP_ALIGNMENT = 8;
+
+uint64_t getGreatestCommonDivisor(uint64_t a, uint64_t b)
+{
+    while (b != 0)
+    {
+        uint64_t remainder = a % b;
+        a = b;
+        b = remainder;
+    }
+    return a;
+}
+
+double getBesselI0(double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 50 && term > sum * 1e-12; ++k)
+    {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+float dotProductScalar(const float* a, const float* b, std::size_t count)
+{
+    float sum = 0.f;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+#ifdef POLYPHASE_RESAMPLER_AVX2
+bool hasAvx2()
+{
+    static const bool isSupported = __builtin_cpu_supports("avx2");
+    return isSupported;
+}
+
+__attribute__((target("avx2"))) float dotProductAvx2(const float* a, const float* b, std::size_t count)
+{
+    __m256 sum = _mm256_setzero_ps();
+    for (std::size_t i = 0; i < count; i += 8)
+    {
+        sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    }
+
+    __m128 half = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+    half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+    half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+    return _mm_cvtss_f32(half);
+}
+#endif
+
+#ifdef POLYPHASE_RESAMPLER_NEON
+float dotProductNeon(const float* a, const float* b, std::size_t count)
+{
+    float32x4_t sum = vdupq_n_f32(0.f);
+    for (std::size_t i = 0; i < count; i += 4)
+    {
+        sum = vmlaq_f32(sum, vld1q_f32(a + i), vld1q_f32(b + i));
+    }
+    return vaddvq_f32(sum);
+}
+#endif
+
+/**
+ * @brief Dot product of tap count values, a multiple of TAP_ALIGNMENT.
+ */
+float dotProduct(const float* a, const float* b, std::size_t count)
+{
+#if defined(POLYPHASE_RESAMPLER_AVX2)
+    if (hasAvx2())
+    {
+        return dotProductAvx2(a, b, count);
+    }
+#elif defined(POLYPHASE_RESAMPLER_NEON)
+    return dotProductNeon(a, b, count);
+#endif
+    return dotProductScalar(a, b, count);
+}
+
+}    // namespace
+
+/**
+ * @param [IN] inputRate - sample rate of the input in Hz.
+ * @param [IN] outputRate - sample rate of the output in Hz.
+ * @param [IN] channels - number of interleaved channels.
+ */
+PolyphaseResampler::PolyphaseResampler(int inputRate, int outputRate, int channels)
+    : channels_(channels)
+    , historyStride_(0)
+    , outputStride_(0)
+    , time_(0)
+{
+    if (inputRate <= 0 || outputRate <= 0 || channels <= 0)
+    {
+        throw std::invalid_argument("Error in PolyphaseResampler - rates and channels must be greater than 0");
+    }
+
+    uint64_t divisor = getGreatestCommonDivisor(inputRate, outputRate);
+    upFactor_ = outputRate / divisor;
+    downFactor_ = inputRate / divisor;
+
+    // Enough taps per phase for the zero crossings of the sinc at the upsampled rate
+    uint64_t prototypeSize = 2 * FILTER_ZERO_CROSSINGS * std::max(upFactor_, downFactor_);
+    tapCount_ = static_cast<std::size_t>((prototypeSize + upFactor_ - 1) / upFactor_);
+    tapCount_ = (tapCount_ + TAP_ALIGNMENT - 1) / TAP_ALIGNMENT * TAP_ALIGNMENT;
+
+    designFilter();
+}
+
+/**
+ * @return largest number of frames process can output for an input.
+ */
+std::size_t PolyphaseResampler::getMaxOutputFrameCount(std::size_t inputFrameCount) const
+{
+    return static_cast<std::size_t>((inputFrameCount * upFactor_ + downFactor_ - 1) / downFactor_) + 1;
+}
+
+/**
+ * @brief Resample the next frames of the stream.
+ * @param [IN] input - interleaved frames.
+ * @param [IN] inputFrameCount - number of input frames.
+ * @param [OUT] output - interleaved frames, room for getMaxOutputFrameCount(inputFrameCount) frames.
+ * @return number of output frames.
+ */
+std::size_t PolyphaseResampler::process(const float* input, std::size_t inputFrameCount, float* output)
+{
+    std::size_t historySize = tapCount_ - 1;
+    if (historySize + inputFrameCount > historyStride_ || getMaxOutputFrameCount(inputFrameCount) > outputStride_)
+    {
+        allocateBuffers(inputFrameCount);
+    }
+
+    // New input goes after the history of each channel
+    deinterleave(input, channels_, inputFrameCount, inputPointers_.data());
+
+    // Output n is at n * M in the upsampled input, phase (n * M) % L of input frame (n * M) / L
+    std::size_t outputFrameCount = 0;
+    uint64_t endTime = inputFrameCount * upFactor_;
+    for (; time_ < endTime; time_ += downFactor_, ++outputFrameCount)
+    {
+        std::size_t frame = static_cast<std::size_t>(time_ / upFactor_);
+        const float* phase = coefficients_.data() + (time_ % upFactor_) * tapCount_;
+
+        for (int channel = 0; channel < channels_; ++channel)
+        {
+            outputPointers_[channel][outputFrameCount] =
+                dotProduct(phase, historyPointers_[channel] + frame, tapCount_);
+        }
+    }
+    time_ -= endTime;
+
+    for (int channel = 0; channel < channels_; ++channel)
+    {
+        std::memmove(historyPointers_[channel], historyPointers_[channel] + inputFrameCount,
+                     historySize * sizeof(float));
+    }
+
+    interleave(outputPointers_.data(), channels_, outputFrameCount, output);
+    return outputFrameCount;
+}
+
+/**
+ * @brief Forget the previous input, e.g. after a discontinuity.
+ */
+void PolyphaseResampler::reset()
+{
+    std::fill(history_.begin(), history_.end(), 0.f);
+    time_ = 0;
+}
+
+/**
+ * @brief Grow the buffers for bigger chunks, normally once, the history is kept.
+ */
+void PolyphaseResampler::allocateBuffers(std::size_t inputFrameCount)
+{
+    std::size_t historySize = tapCount_ - 1;
+    std::vector<float> history(history_);
+    std::size_t previousStride = historyStride_;
+
+    historyStride_ = std::max(historyStride_, historySize + inputFrameCount);
+    outputStride_ = std::max(outputStride_, getMaxOutputFrameCount(inputFrameCount));
+    history_.assign(historyStride_ * channels_, 0.f);
+    outputPlanes_.assign(outputStride_ * channels_, 0.f);
+
+    historyPointers_.resize(channels_);
+    inputPointers_.resize(channels_);
+    outputPointers_.resize(channels_);
+
+    for (int channel = 0; channel < channels_; ++channel)
+    {
+        historyPointers_[channel] = history_.data() + channel * historyStride_;
+        inputPointers_[channel] = historyPointers_[channel] + historySize;
+        outputPointers_[channel] = outputPlanes_.data() + channel * outputStride_;
+
+        if (previousStride > 0)
+        {
+            std::memcpy(historyPointers_[channel], history.data() + channel * previousStride,
+                        historySize * sizeof(float));
+        }
+    }
+}
+
+void PolyphaseResampler::designFilter()
+{
+    std::size_t prototypeSize = tapCount_ * upFactor_;
+    double center = (prototypeSize - 1) / 2.0;
+    double cutoff = FILTER_CUTOFF_RATIO * 0.5 / std::max(upFactor_, downFactor_);
+    double windowNormalization = getBesselI0(KAISER_BETA);
+
+    std::vector<double> prototype(prototypeSize);
+    double sum = 0.0;
+    for (std::size_t i = 0; i < prototypeSize; ++i)
+    {
+        double x = i - center;
+        double sinc = x == 0.0 ? 1.0 : std::sin(2.0 * math::PI * cutoff * x) / (2.0 * math::PI * cutoff * x);
+        double ratio = x / (center + 1.0);
+        double window = getBesselI0(KAISER_BETA * std::sqrt(std::max(0.0, 1.0 - ratio * ratio))) / windowNormalization;
+        prototype[i] = sinc * window;
+        sum += prototype[i];
+    }
+
+    // Each phase sees one of L upsampled samples, a gain of L keeps unity gain
+    double gain = upFactor_ / sum;
+
+    coefficients_.assign(prototypeSize, 0.f);
+    for (std::size_t phase = 0; phase < upFactor_; ++phase)
+    {
+        float* taps = coefficients_.data() + phase * tapCount_;
+        for (std::size_t tap = 0; tap < tapCount_; ++tap)
+        {
+            taps[tapCount_ - 1 - tap] = static_cast<float>(prototype[tap * upFactor_ + phase] * gain);
+        }
+    }
+}
+
+}    // namespace audio
+}    // namespace Model
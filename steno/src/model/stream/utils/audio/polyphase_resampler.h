@@ -0,0 +1,54 @@
+#ifndef POLYPHASE_RESAMPLER_H
+#define POLYPHASE_RESAMPLER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Model
+{
+namespace audio
+{
+/**
+ * @brief Rational sample rate converter (e.g. 16 kHz to 48 kHz) for interleaved float frames. The input is
+ * upsampled by L and downsampled by M with a Kaiser windowed sinc low pass, only the filter phases that produce
+ * output samples are computed. The state is kept between calls, a stream can be resampled chunk by chunk.
+ */
+class PolyphaseResampler
+{
+   public:
+    PolyphaseResampler(int inputRate, int outputRate, int channels);
+
+    std::size_t getMaxOutputFrameCount(std::size_t inputFrameCount) const;
+    std::size_t process(const float* input, std::size_t inputFrameCount, float* output);
+    void reset();
+
+   private:
+    void designFilter();
+    void allocateBuffers(std::size_t inputFrameCount);
+
+    int channels_;
+    uint64_t upFactor_;
+    uint64_t downFactor_;
+    std::size_t tapCount_;
+
+    // Taps of each phase in reverse order, so a phase is a dot product with the input in time order
+    std::vector<float> coefficients_;
+
+    // Per channel: the last tapCount - 1 input frames followed by the current input
+    std::vector<float> history_;
+    std::vector<float> outputPlanes_;
+    std::size_t historyStride_;
+    std::size_t outputStride_;
+    std::vector<float*> historyPointers_;
+    std::vector<float*> inputPointers_;
+    std::vector<float*> outputPointers_;
+
+    // Position of the next output in the upsampled input, relative to the start of the current input
+    uint64_t time_;
+};
+
+}    // namespace audio
+}    // namespace Model
+
+#endif    //! POLYPHASE_RESAMPLER_H
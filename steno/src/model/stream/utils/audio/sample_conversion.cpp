@@ -0,0 +1,390 @@
+#include "sample_conversion.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SAMPLE_CONVERSION_AVX2
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define SAMPLE_CONVERSION_NEON
+#endif
+
+namespace Model
+{
+namespace audio
+{
+namespace
+{
+const float INT16_SCALE = 32768.f;
+const float INT32_SCALE = 2147483648.f;
+
+// Largest float below 2^31, 2^31 itself would overflow when converted back to int32
+const float INT32_MAX_FLOAT = 2147483520.f;
+
+template <typename T>
+void convertToFloatScalar(const T* samples, std::size_t begin, std::size_t end, float scale, float* outSamples)
+{
+    float inverseScale = 1.f / scale;
+    for (std::size_t i = begin; i < end; ++i)
+    {
+        outSamples[i] = samples[i] * inverseScale;
+    }
+}
+
+template <typename T>
+void convertFromFloatScalar(const float* samples, std::size_t begin, std::size_t end, float scale, float maxValue,
+                            T* outSamples)
+{
+    for (std::size_t i = begin; i < end; ++i)
+    {
+        float value = std::min(maxValue, std::max(-scale, samples[i] * scale));
+        outSamples[i] = static_cast<T>(std::lrint(value));
+    }
+}
+
+#ifdef SAMPLE_CONVERSION_AVX2
+bool hasAvx2()
+{
+    static const bool isSupported = __builtin_cpu_supports("avx2");
+    return isSupported;
+}
+
+__attribute__((target("avx2"))) std::size_t convertToFloatAvx2(const int16_t* samples, std::size_t count,
+                                                               float* outSamples)
+{
+    const __m256 inverseScale = _mm256_set1_ps(1.f / INT16_SCALE);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i));
+        __m256 floats = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(values));
+        _mm256_storeu_ps(outSamples + i, _mm256_mul_ps(floats, inverseScale));
+    }
+    return i;
+}
+
+__attribute__((target("avx2"))) std::size_t convertToFloatAvx2(const int32_t* samples, std::size_t count,
+                                                               float* outSamples)
+{
+    const __m256 inverseScale = _mm256_set1_ps(1.f / INT32_SCALE);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(samples + i));
+        _mm256_storeu_ps(outSamples + i, _mm256_mul_ps(_mm256_cvtepi32_ps(values), inverseScale));
+    }
+    return i;
+}
+
+__attribute__((target("avx2"))) std::size_t convertFromFloatAvx2(const float* samples, std::size_t count,
+                                                                 int16_t* outSamples)
+{
+    const __m256 scale = _mm256_set1_ps(INT16_SCALE);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i values = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(samples + i), scale));
+
+        // Saturating pack works per 128 bits lane, gather the two packed halves in the low lane
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(values, values), 0xD8);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(outSamples + i), _mm256_castsi256_si128(packed));
+    }
+    return i;
+}
+
+__attribute__((target("avx2"))) std::size_t convertFromFloatAvx2(const float* samples, std::size_t count,
+                                                                 int32_t* outSamples)
+{
+    const __m256 scale = _mm256_set1_ps(INT32_SCALE);
+    const __m256 minValue = _mm256_set1_ps(-INT32_SCALE);
+    const __m256 maxValue = _mm256_set1_ps(INT32_MAX_FLOAT);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 values = _mm256_mul_ps(_mm256_loadu_ps(samples + i), scale);
+        values = _mm256_min_ps(maxValue, _mm256_max_ps(minValue, values));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(outSamples + i), _mm256_cvtps_epi32(values));
+    }
+    return i;
+}
+#endif
+
+#ifdef SAMPLE_CONVERSION_NEON
+std::size_t convertToFloatNeon(const int16_t* samples, std::size_t count, float* outSamples)
+{
+    const float32x4_t inverseScale = vdupq_n_f32(1.f / INT16_SCALE);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        int16x8_t values = vld1q_s16(samples + i);
+        float32x4_t low = vcvtq_f32_s32(vmovl_s16(vget_low_s16(values)));
+        float32x4_t high = vcvtq_f32_s32(vmovl_s16(vget_high_s16(values)));
+        vst1q_f32(outSamples + i, vmulq_f32(low, inverseScale));
+        vst1q_f32(outSamples + i + 4, vmulq_f32(high, inverseScale));
+    }
+    return i;
+}
+
+std::size_t convertToFloatNeon(const int32_t* samples, std::size_t count, float* outSamples)
+{
+    const float32x4_t inverseScale = vdupq_n_f32(1.f / INT32_SCALE);
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        vst1q_f32(outSamples + i, vmulq_f32(vcvtq_f32_s32(vld1q_s32(samples + i)), inverseScale));
+    }
+    return i;
+}
+
+std::size_t convertFromFloatNeon(const float* samples, std::size_t count, int16_t* outSamples)
+{
+    const float32x4_t scale = vdupq_n_f32(INT16_SCALE);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        int32x4_t low = vcvtnq_s32_f32(vmulq_f32(vld1q_f32(samples + i), scale));
+        int32x4_t high = vcvtnq_s32_f32(vmulq_f32(vld1q_f32(samples + i + 4), scale));
+        vst1q_s16(outSamples + i, vcombine_s16(vqmovn_s32(low), vqmovn_s32(high)));
+    }
+    return i;
+}
+
+std::size_t convertFromFloatNeon(const float* samples, std::size_t count, int32_t* outSamples)
+{
+    // The float to int conversion saturates on aarch64, no clamp needed
+    const float32x4_t scale = vdupq_n_f32(INT32_SCALE);
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        vst1q_s32(outSamples + i, vcvtnq_s32_f32(vmulq_f32(vld1q_f32(samples + i), scale)));
+    }
+    return i;
+}
+#endif
+
+#ifdef SAMPLE_CONVERSION_AVX2
+__attribute__((target("avx2"))) std::size_t interleaveStereoAvx2(const float* left, const float* right,
+                                                                 std::size_t count, float* outSamples)
+{
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 leftValues = _mm256_loadu_ps(left + i);
+        __m256 rightValues = _mm256_loadu_ps(right + i);
+
+        // Unpack works per 128 bits lane, frames 0-1 and 4-5 are in the low one, 2-3 and 6-7 in the high one
+        __m256 low = _mm256_unpacklo_ps(leftValues, rightValues);
+        __m256 high = _mm256_unpackhi_ps(leftValues, rightValues);
+        _mm256_storeu_ps(outSamples + 2 * i, _mm256_permute2f128_ps(low, high, 0x20));
+        _mm256_storeu_ps(outSamples + 2 * i + 8, _mm256_permute2f128_ps(low, high, 0x31));
+    }
+    return i;
+}
+
+__attribute__((target("avx2"))) std::size_t deinterleaveStereoAvx2(const float* samples, std::size_t count,
+                                                                   float* outLeft, float* outRight)
+{
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 first = _mm256_loadu_ps(samples + 2 * i);
+        __m256 second = _mm256_loadu_ps(samples + 2 * i + 8);
+
+        // Shuffle works per 128 bits lane, put the 64 bits halves back in order
+        __m256 leftValues = _mm256_shuffle_ps(first, second, 0x88);
+        __m256 rightValues = _mm256_shuffle_ps(first, second, 0xDD);
+        _mm256_storeu_ps(outLeft + i, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(leftValues), 0xD8)));
+        _mm256_storeu_ps(outRight + i,
+                         _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(rightValues), 0xD8)));
+    }
+    return i;
+}
+#endif
+
+#ifdef SAMPLE_CONVERSION_NEON
+std::size_t interleaveStereoNeon(const float* left, const float* right, std::size_t count, float* outSamples)
+{
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        float32x4x2_t frames = {{vld1q_f32(left + i), vld1q_f32(right + i)}};
+        vst2q_f32(outSamples + 2 * i, frames);
+    }
+    return i;
+}
+
+std::size_t deinterleaveStereoNeon(const float* samples, std::size_t count, float* outLeft, float* outRight)
+{
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        float32x4x2_t frames = vld2q_f32(samples + 2 * i);
+        vst1q_f32(outLeft + i, frames.val[0]);
+        vst1q_f32(outRight + i, frames.val[1]);
+    }
+    return i;
+}
+#endif
+
+template <typename T>
+void convertToFloat(const T* samples, std::size_t count, float scale, float* outSamples)
+{
+    std::size_t converted = 0;
+#if defined(SAMPLE_CONVERSION_AVX2)
+    if (hasAvx2())
+    {
+        converted = convertToFloatAvx2(samples, count, outSamples);
+    }
+#elif defined(SAMPLE_CONVERSION_NEON)
+    converted = convertToFloatNeon(samples, count, outSamples);
+#endif
+    convertToFloatScalar(samples, converted, count, scale, outSamples);
+}
+
+template <typename T>
+void convertFromFloat(const float* samples, std::size_t count, float scale, float maxValue, T* outSamples)
+{
+    std::size_t converted = 0;
+#if defined(SAMPLE_CONVERSION_AVX2)
+    if (hasAvx2())
+    {
+        converted = convertFromFloatAvx2(samples, count, outSamples);
+    }
+#elif defined(SAMPLE_CONVERSION_NEON)
+    converted = convertFromFloatNeon(samples, count, outSamples);
+#endif
+    convertFromFloatScalar(samples, converted, count, scale, maxValue, outSamples);
+}
+
+}    // namespace
+
+void convertToFloat(const uint8_t* samples, int bytesPerSample, std::size_t sampleCount, float* outSamples)
+{
+    switch (bytesPerSample)
+    {
+        case 2:
+            convertToFloat(reinterpret_cast<const int16_t*>(samples), sampleCount, INT16_SCALE, outSamples);
+            break;
+        case 4:
+            convertToFloat(reinterpret_cast<const int32_t*>(samples), sampleCount, INT32_SCALE, outSamples);
+            break;
+        default:
+            throw std::invalid_argument("Error in convertToFloat - only 16 and 32 bits samples are supported");
+    }
+}
+
+void convertFromFloat(const float* samples, std::size_t sampleCount, int bytesPerSample, uint8_t* outSamples)
+{
+    switch (bytesPerSample)
+    {
+        case 2:
+            convertFromFloat(samples, sampleCount, INT16_SCALE, INT16_SCALE - 1.f,
+                             reinterpret_cast<int16_t*>(outSamples));
+            break;
+        case 4:
+            convertFromFloat(samples, sampleCount, INT32_SCALE, INT32_MAX_FLOAT,
+                             reinterpret_cast<int32_t*>(outSamples));
+            break;
+        default:
+            throw std::invalid_argument("Error in convertFromFloat - only 16 and 32 bits samples are supported");
+    }
+}
+
+void convertToFloat(const uint8_t* samples, SampleFormat sampleFormat, std::size_t sampleCount, float* outSamples)
+{
+    switch (sampleFormat)
+    {
+        case SampleFormat::S16:
+            convertToFloat(samples, 2, sampleCount, outSamples);
+            break;
+        case SampleFormat::S32:
+            convertToFloat(samples, 4, sampleCount, outSamples);
+            break;
+        case SampleFormat::F32:
+            std::memcpy(outSamples, samples, sampleCount * sizeof(float));
+            break;
+    }
+}
+
+void convertFromFloat(const float* samples, std::size_t sampleCount, SampleFormat sampleFormat, uint8_t* outSamples)
+{
+    switch (sampleFormat)
+    {
+        case SampleFormat::S16:
+            convertFromFloat(samples, sampleCount, 2, outSamples);
+            break;
+        case SampleFormat::S32:
+            convertFromFloat(samples, sampleCount, 4, outSamples);
+            break;
+        case SampleFormat::F32:
+            std::memcpy(outSamples, samples, sampleCount * sizeof(float));
+            break;
+    }
+}
+
+void interleave(const float* const* planes, int channels, std::size_t frameCount, float* outSamples)
+{
+    if (channels == 1)
+    {
+        std::memcpy(outSamples, planes[0], frameCount * sizeof(float));
+        return;
+    }
+
+    std::size_t frame = 0;
+    if (channels == 2)
+    {
+#if defined(SAMPLE_CONVERSION_AVX2)
+        if (hasAvx2())
+        {
+            frame = interleaveStereoAvx2(planes[0], planes[1], frameCount, outSamples);
+        }
+#elif defined(SAMPLE_CONVERSION_NEON)
+        frame = interleaveStereoNeon(planes[0], planes[1], frameCount, outSamples);
+#endif
+    }
+
+    for (; frame < frameCount; ++frame)
+    {
+        for (int channel = 0; channel < channels; ++channel)
+        {
+            outSamples[frame * channels + channel] = planes[channel][frame];
+        }
+    }
+}
+
+void deinterleave(const float* samples, int channels, std::size_t frameCount, float* const* outPlanes)
+{
+    if (channels == 1)
+    {
+        std::memcpy(outPlanes[0], samples, frameCount * sizeof(float));
+        return;
+    }
+
+    std::size_t frame = 0;
+    if (channels == 2)
+    {
+#if defined(SAMPLE_CONVERSION_AVX2)
+        if (hasAvx2())
+        {
+            frame = deinterleaveStereoAvx2(samples, frameCount, outPlanes[0], outPlanes[1]);
+        }
+#elif defined(SAMPLE_CONVERSION_NEON)
+        frame = deinterleaveStereoNeon(samples, frameCount, outPlanes[0], outPlanes[1]);
+#endif
+    }
+
+    for (; frame < frameCount; ++frame)
+    {
+        for (int channel = 0; channel < channels; ++channel)
+        {
+            outPlanes[channel][frame] = samples[frame * channels + channel];
+        }
+    }
+}
+
+}    // namespace audio
+}    // namespace Model
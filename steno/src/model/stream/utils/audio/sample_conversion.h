@@ -0,0 +1,42 @@
+#ifndef SAMPLE_CONVERSION_H
+#define SAMPLE_CONVERSION_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "model/stream/audio/audio_format.h"
+
+namespace Model
+{
+namespace audio
+{
+/**
+ * @brief Signed 16 or 32 bits native endian samples to float samples in [-1, 1].
+ */
+void convertToFloat(const uint8_t* samples, int bytesPerSample, std::size_t sampleCount, float* outSamples);
+
+/**
+ * @brief Float samples to signed 16 or 32 bits native endian samples, values outside [-1, 1] are clipped.
+ */
+void convertFromFloat(const float* samples, std::size_t sampleCount, int bytesPerSample, uint8_t* outSamples);
+
+/**
+ * @brief Same conversions for any sample format of the pipeline, float samples are copied as is.
+ */
+void convertToFloat(const uint8_t* samples, SampleFormat sampleFormat, std::size_t sampleCount, float* outSamples);
+void convertFromFloat(const float* samples, std::size_t sampleCount, SampleFormat sampleFormat, uint8_t* outSamples);
+
+/**
+ * @brief Interleave one plane of samples per channel in frames.
+ */
+void interleave(const float* const* planes, int channels, std::size_t frameCount, float* outSamples);
+
+/**
+ * @brief Split frames in one plane of samples per channel.
+ */
+void deinterleave(const float* samples, int channels, std::size_t frameCount, float* const* outPlanes);
+
+}    // namespace audio
+}    // namespace Model
+
+#endif    //! SAMPLE_CONVERSION_H
@@ -0,0 +1,126 @@
+#include "frame_ref.h"
+
+#include <stdexcept>
+#include <utility>
+
+namespace Model
+{
+FrameBuffer::FrameBuffer(const Image& image)
+    : image(image)
+    , refCount_(0)
+{
+}
+
+FrameRef::FrameRef() noexcept
+    : buffer_(nullptr)
+{
+}
+
+/**
+ * @brief First reference to a buffer.
+ * @param [IN] recycler - takes the buffer back when it is released, null if the buffer outlives its references.
+ */
+FrameRef::FrameRef(FrameBuffer* buffer, std::shared_ptr<IFrameRecycler> recycler)
+    : buffer_(buffer)
+{
+    if (buffer_ == nullptr)
+    {
+        throw std::invalid_argument("Error in FrameRef - Null is not a valid frame buffer");
+    }
+
+    if (buffer_->refCount_.load(std::memory_order_acquire) != 0)
+    {
+        throw std::invalid_argument("Error in FrameRef - the frame buffer is already referenced");
+    }
+
+    buffer_->recycler_ = std::move(recycler);
+    buffer_->refCount_.store(1, std::memory_order_release);
+}
+
+FrameRef::FrameRef(const FrameRef& other) noexcept
+    : buffer_(other.buffer_)
+{
+    if (buffer_ != nullptr)
+    {
+        buffer_->refCount_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+FrameRef::FrameRef(FrameRef&& other) noexcept
+    : buffer_(other.buffer_)
+{
+    other.buffer_ = nullptr;
+}
+
+FrameRef::~FrameRef()
+{
+    reset();
+}
+
+FrameRef& FrameRef::operator=(const FrameRef& other) noexcept
+{
+    FrameRef copy(other);
+    std::swap(buffer_, copy.buffer_);
+    return *this;
+}
+
+FrameRef& FrameRef::operator=(FrameRef&& other) noexcept
+{
+    if (this != &other)
+    {
+        reset();
+        buffer_ = other.buffer_;
+        other.buffer_ = nullptr;
+    }
+
+    return *this;
+}
+
+/**
+ * @brief Release the reference, the buffer is recycled if it was the last one.
+ */
+void FrameRef::reset() noexcept
+{
+    if (buffer_ == nullptr)
+    {
+        return;
+    }
+
+    // Writes to the frame by any holder happen before its recycling
+    if (buffer_->refCount_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        // The buffer can be referenced again as soon as it is recycled, the recycler is taken out before
+        std::shared_ptr<IFrameRecycler> recycler = std::move(buffer_->recycler_);
+        if (recycler)
+        {
+            recycler->recycle(buffer_);
+        }
+    }
+
+    buffer_ = nullptr;
+}
+
+Image& FrameRef::operator*() const noexcept
+{
+    return buffer_->image;
+}
+
+Image* FrameRef::operator->() const noexcept
+{
+    return &buffer_->image;
+}
+
+FrameRef::operator bool() const noexcept
+{
+    return buffer_ != nullptr;
+}
+
+/**
+ * @brief References sharing the buffer, only exact while no other thread holds the frame.
+ */
+int FrameRef::getRefCount() const noexcept
+{
+    return buffer_ != nullptr ? buffer_->refCount_.load(std::memory_order_relaxed) : 0;
+}
+
+}    // namespace Model
@@ -0,0 +1,76 @@
+#ifndef FRAME_REF_H
+#define FRAME_REF_H
+
+#include <atomic>
+#include <memory>
+
+#include "model/stream/utils/images/images.h"
+
+namespace Model
+{
+class FrameBuffer;
+
+/**
+ * @brief Owner of frame buffers, takes a buffer back when the last reference to it is released. Can be called from
+ * any thread holding a frame.
+ */
+class IFrameRecycler
+{
+   public:
+    virtual ~IFrameRecycler() = default;
+    virtual void recycle(FrameBuffer* buffer) = 0;
+};
+
+/**
+ * @brief Image buffer shared by frame references, it stays with its owner while not referenced.
+ */
+class FrameBuffer
+{
+   public:
+    explicit FrameBuffer(const Image& image);
+
+    FrameBuffer(const FrameBuffer&) = delete;
+    FrameBuffer& operator=(const FrameBuffer&) = delete;
+
+    Image image;
+
+   private:
+    friend class FrameRef;
+
+    std::atomic<int> refCount_;
+    std::shared_ptr<IFrameRecycler> recycler_;    // Set while referenced, keeps the owner alive
+};
+
+/**
+ * @brief Counted reference to a frame buffer, copies share the buffer without copying the image. The buffer goes
+ * back to its recycler when the last reference is released, so a producer never writes to a frame a consumer still
+ * holds. A reference is not thread safe itself, each thread must hold its own copy. Consumers must not write to
+ * a shared frame.
+ */
+class FrameRef
+{
+   public:
+    FrameRef() noexcept;
+    FrameRef(FrameBuffer* buffer, std::shared_ptr<IFrameRecycler> recycler);
+    FrameRef(const FrameRef& other) noexcept;
+    FrameRef(FrameRef&& other) noexcept;
+    ~FrameRef();
+
+    FrameRef& operator=(const FrameRef& other) noexcept;
+    FrameRef& operator=(FrameRef&& other) noexcept;
+
+    void reset() noexcept;
+
+    Image& operator*() const noexcept;
+    Image* operator->() const noexcept;
+    explicit operator bool() const noexcept;
+
+    int getRefCount() const noexcept;
+
+   private:
+    FrameBuffer* buffer_;
+};
+
+}    // namespace Model
+
+#endif    //! FRAME_REF_H
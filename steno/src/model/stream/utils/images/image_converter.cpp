@@ -8,49 +8,68 @@
 
 namespace Model
 {
+namespace
+{
+const int PIXEL_PAIRS_PER_TASK = 8192;
+}
+
+ImageConverter::ImageConverter(std::shared_ptr<TaskScheduler> taskScheduler, TaskPriority priority)
+    : taskScheduler_(taskScheduler)
+    , priority_(priority)
+{
+}
+
 void ImageConverter::convert(const Image& inImage, Image& outImage)
 {
-    int size = inImage.width * inImage.height;
+    int pairCount = (inImage.width * inImage.height) / 2;
 
     if (inImage.format == ImageFormat::RGB_FMT && outImage.format == ImageFormat::UYVY_FMT)
     {
         const RGB* rbgData = reinterpret_cast<const RGB*>(inImage.hostData);
         UYVY* uyvyData = reinterpret_cast<UYVY*>(outImage.hostData);
 
-        for (int i = 0, j = 0; i < size; i += 2, ++j)
-        {
-            getUYVYFromRGB(rbgData[i], rbgData[i + 1], uyvyData[j]);
-        }
+        parallelFor(taskScheduler_.get(), priority_, 0, pairCount, PIXEL_PAIRS_PER_TASK, [&](int begin, int end) {
+            for (int j = begin, i = begin * 2; j < end; ++j, i += 2)
+            {
+                getUYVYFromRGB(rbgData[i], rbgData[i + 1], uyvyData[j]);
+            }
+        });
     }
     else if (inImage.format == ImageFormat::RGB_FMT && outImage.format == ImageFormat::YUYV_FMT)
     {
         const RGB* rbgData = reinterpret_cast<const RGB*>(inImage.hostData);
         YUYV* yuyvData = reinterpret_cast<YUYV*>(outImage.hostData);
 
-        for (int i = 0, j = 0; i < size; i += 2, ++j)
-        {
-            getYUYVFromRGB(rbgData[i], rbgData[i + 1], yuyvData[j]);
-        }
+        parallelFor(taskScheduler_.get(), priority_, 0, pairCount, PIXEL_PAIRS_PER_TASK, [&](int begin, int end) {
+            for (int j = begin, i = begin * 2; j < end; ++j, i += 2)
+            {
+                getYUYVFromRGB(rbgData[i], rbgData[i + 1], yuyvData[j]);
+            }
+        });
     }
     else if (inImage.format == ImageFormat::UYVY_FMT && outImage.format == ImageFormat::RGB_FMT)
     {
         const UYVY* uyvyData = reinterpret_cast<const UYVY*>(inImage.hostData);
         RGB* rbgData = reinterpret_cast<RGB*>(outImage.hostData);
 
-        for (int i = 0, j = 0; i < size; i += 2, ++j)
-        {
-            getRGBFromUYVY(uyvyData[j], rbgData[i], rbgData[i + 1]);
-        }
+        parallelFor(taskScheduler_.get(), priority_, 0, pairCount, PIXEL_PAIRS_PER_TASK, [&](int begin, int end) {
+            for (int j = begin, i = begin * 2; j < end; ++j, i += 2)
+            {
+                getRGBFromUYVY(uyvyData[j], rbgData[i], rbgData[i + 1]);
+            }
+        });
     }
     else if (inImage.format == ImageFormat::YUYV_FMT && outImage.format == ImageFormat::RGB_FMT)
     {
         const YUYV* yuyvData = reinterpret_cast<const YUYV*>(inImage.hostData);
         RGB* rbgData = reinterpret_cast<RGB*>(outImage.hostData);
 
-        for (int i = 0, j = 0; i < size; i += 2, ++j)
-        {
-            getRGBFromYUYV(yuyvData[j], rbgData[i], rbgData[i + 1]);
-        }
+        parallelFor(taskScheduler_.get(), priority_, 0, pairCount, PIXEL_PAIRS_PER_TASK, [&](int begin, int end) {
+            for (int j = begin, i = begin * 2; j < end; ++j, i += 2)
+            {
+                getRGBFromYUYV(yuyvData[j], rbgData[i], rbgData[i + 1]);
+            }
+        });
     }
     else if (inImage.format == outImage.format)
     {
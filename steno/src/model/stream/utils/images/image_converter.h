@@ -1,13 +1,19 @@
 #ifndef IMAGE_CONVERTER_H
 #define IMAGE_CONVERTER_H
 
+#include <memory>
+
 #include "model/stream/utils/images/i_image_converter.h"
+#include "model/stream/utils/threads/task_scheduler.h"
 
 namespace Model
 {
 class ImageConverter : public IImageConverter
 {
    public:
+    explicit ImageConverter(std::shared_ptr<TaskScheduler> taskScheduler = nullptr,
+                            TaskPriority priority = TaskPriority::HIGH);
+
     void convert(const Image& inImage, Image& outImage) override;
 
    private:
@@ -15,6 +21,9 @@ class ImageConverter : public IImageConverter
     void getRGBFromYUYV(const YUYV& uyvy, RGB& rgb1, RGB& rgb2);
     void getUYVYFromRGB(const RGB& rgb1, const RGB& rgb2, UYVY& uyvy);
     void getYUYVFromRGB(const RGB& rgb1, const RGB& rgb2, YUYV& uyvy);
+
+    std::shared_ptr<TaskScheduler> taskScheduler_;
+    TaskPriority priority_;
 };
 
 }    // namespace Model
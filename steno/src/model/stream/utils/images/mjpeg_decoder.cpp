@@ -0,0 +1,541 @@
+#include "mjpeg_decoder.h"
+
+// jpeglib.h needs the definitions of stdio
+#include <cstdio>
+
+#include <jpeglib.h>
+
+#include <algorithm>
+#include <csetjmp>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace Model
+{
+namespace
+{
+// Smallest work item, below this the setup of a band costs more than its decoding
+const int MCU_ROWS_PER_TASK = 8;
+
+const unsigned char MARKER_PREFIX = 0xFF;
+const unsigned char SOI_MARKER = 0xD8;
+const unsigned char EOI_MARKER = 0xD9;
+const unsigned char SOS_MARKER = 0xDA;
+const unsigned char DRI_MARKER = 0xDD;
+const unsigned char RST0_MARKER = 0xD0;
+const unsigned char RST7_MARKER = 0xD7;
+const unsigned char STUFFED_BYTE = 0x00;
+
+const int BLOCK_SIZE = 8;
+
+struct ErrorManager
+{
+    jpeg_error_mgr base;
+    std::jmp_buf jumpBuffer;
+    char message[JMSG_LENGTH_MAX];
+};
+
+void exitOnError(j_common_ptr cinfo)
+{
+    ErrorManager* errorManager = reinterpret_cast<ErrorManager*>(cinfo->err);
+    (*cinfo->err->format_message)(cinfo, errorManager->message);
+    std::longjmp(errorManager->jumpBuffer, 1);
+}
+
+// Cameras often send a few bytes of padding after the frame, the warnings are not worth a log per frame
+void ignoreMessage(j_common_ptr)
+{
+}
+
+int readUint16(const unsigned char* data)
+{
+    return (data[0] << 8) | data[1];
+}
+
+bool isSofMarker(unsigned char marker)
+{
+    return marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+}
+
+int gcd(int a, int b)
+{
+    while (b != 0)
+    {
+        int remainder = a % b;
+        a = b;
+        b = remainder;
+    }
+    return a;
+}
+}    // namespace
+
+struct MjpegDecoder::DecodeContext
+{
+    DecodeContext()
+    {
+        cinfo.err = jpeg_std_error(&errorManager.base);
+        errorManager.base.error_exit = exitOnError;
+        errorManager.base.output_message = ignoreMessage;
+        jpeg_create_decompress(&cinfo);
+    }
+
+    ~DecodeContext()
+    {
+        jpeg_destroy_decompress(&cinfo);
+    }
+
+    jpeg_decompress_struct cinfo;
+    ErrorManager errorManager;
+
+    // Header and entropy data of a band, a decoded row before it is packed
+    std::vector<unsigned char> bandData;
+    std::vector<unsigned char> rowBuffer;
+};
+
+MjpegDecoder::MjpegDecoder(std::shared_ptr<TaskScheduler> taskScheduler, TaskPriority priority)
+    : taskScheduler_(taskScheduler)
+    , priority_(priority)
+    , hasDecodeRegion_(false)
+{
+    for (int i = 0; i < 256; ++i)
+    {
+        lumaTable_[i] = static_cast<unsigned char>(16 + (i * 219 + 127) / 255);
+        chromaTable_[i] = static_cast<unsigned char>(128 + ((i - 128) * 224 + (i >= 128 ? 127 : -127)) / 255);
+    }
+}
+
+MjpegDecoder::~MjpegDecoder() = default;
+
+/**
+ * @brief Only decode the MCUs covering the region, like the bounding box of the fisheye circle. Pixels outside the
+ * region are black.
+ */
+void MjpegDecoder::setDecodeRegion(const Rectangle& region)
+{
+    decodeRegion_ = region;
+    hasDecodeRegion_ = true;
+}
+
+/**
+ * @param [IN] jpegData - one MJPEG frame, it must have the dimensions of the image.
+ * @param [OUT] outImage - RGB, UYVY or YUYV image receiving the frame.
+ */
+void MjpegDecoder::decode(const unsigned char* jpegData, std::size_t jpegSize, Image& outImage)
+{
+    if (!parseFrame(jpegData, jpegSize, layout_))
+    {
+        throw std::runtime_error("Error in MjpegDecoder - Invalid JPEG frame");
+    }
+
+    if (layout_.width != outImage.width || layout_.height != outImage.height)
+    {
+        throw std::runtime_error("Error in MjpegDecoder - Frame of " + std::to_string(layout_.width) + " x " +
+                                 std::to_string(layout_.height) + " does not fit the image");
+    }
+
+    frameRegion_ = Rectangle(0, 0, outImage.width, outImage.height);
+    if (hasDecodeRegion_)
+    {
+        // Columns are rounded to pixel pairs of the packed formats
+        int left = std::max(decodeRegion_.x, 0) & ~1;
+        int top = std::max(decodeRegion_.y, 0);
+        int right = (std::min(decodeRegion_.x + decodeRegion_.width, outImage.width) + 1) & ~1;
+        int bottom = std::min(decodeRegion_.y + decodeRegion_.height, outImage.height);
+        frameRegion_ = Rectangle(left, top, std::max(right - left, 0), std::max(bottom - top, 0));
+    }
+
+    fillOutsideRegion(outImage);
+
+    if (frameRegion_.width == 0 || frameRegion_.height == 0)
+    {
+        return;
+    }
+
+    int mcuRowCount = (layout_.height + layout_.mcuHeight - 1) / layout_.mcuHeight;
+    int mcusPerRow = (layout_.width + layout_.mcuWidth - 1) / layout_.mcuWidth;
+    int restartInterval = layout_.restartInterval;
+    std::size_t intervalCount = 0;
+    if (restartInterval > 0)
+    {
+        intervalCount = (static_cast<std::size_t>(mcuRowCount) * mcusPerRow + restartInterval - 1) / restartInterval;
+    }
+
+    // Without the expected markers the frame can only be decoded from the start
+    if (!layout_.isSplittable || restartInterval == 0 || layout_.restartMarkerOffsets.size() + 1 != intervalCount)
+    {
+        decodeRows(jpegData, jpegSize, 0, outImage);
+        return;
+    }
+
+    // A band starts on a restart marker at the start of a MCU row
+    int bandMcuRows = restartInterval / gcd(mcusPerRow, restartInterval);
+    int bandHeight = bandMcuRows * layout_.mcuHeight;
+    int firstBand = frameRegion_.y / bandHeight;
+    int endBand = (frameRegion_.y + frameRegion_.height + bandHeight - 1) / bandHeight;
+    int grainSize = std::max(MCU_ROWS_PER_TASK / bandMcuRows, 1);
+
+    parallelFor(taskScheduler_.get(), priority_, firstBand, endBand, grainSize, [&](int begin, int end) {
+        decodeBands(jpegData, begin, end, bandMcuRows, outImage);
+    });
+}
+
+/**
+ * @brief Find the dimensions, the MCU size and the restart markers of the frame.
+ * @return false if the data is not a JPEG frame.
+ */
+bool MjpegDecoder::parseFrame(const unsigned char* data, std::size_t size, FrameLayout& layout) const
+{
+    layout.width = 0;
+    layout.height = 0;
+    layout.mcuWidth = BLOCK_SIZE;
+    layout.mcuHeight = BLOCK_SIZE;
+    layout.restartInterval = 0;
+    layout.isSplittable = false;
+    layout.entropyBegin = 0;
+    layout.restartMarkerOffsets.clear();
+
+    if (size < 4 || data[0] != MARKER_PREFIX || data[1] != SOI_MARKER)
+    {
+        return false;
+    }
+
+    int componentCount = 0;
+    std::size_t pos = 2;
+    while (layout.entropyBegin == 0)
+    {
+        if (pos + 4 > size || data[pos] != MARKER_PREFIX)
+        {
+            return false;
+        }
+
+        unsigned char marker = data[pos + 1];
+        if (marker == MARKER_PREFIX)
+        {
+            // Fill byte before a marker
+            ++pos;
+            continue;
+        }
+
+        std::size_t length = readUint16(data + pos + 2);
+        if (length < 2 || pos + 2 + length > size)
+        {
+            return false;
+        }
+
+        const unsigned char* segment = data + pos + 4;
+        if (isSofMarker(marker))
+        {
+            componentCount = length >= 8 ? segment[5] : 0;
+            if (componentCount == 0 || length < 8 + 3 * static_cast<std::size_t>(componentCount))
+            {
+                return false;
+            }
+
+            layout.sofHeightOffset = pos + 5;
+            layout.height = readUint16(segment + 1);
+            layout.width = readUint16(segment + 3);
+
+            // The MCU of a single component frame is a block whatever its sampling factors
+            if (componentCount > 1)
+            {
+                int maxHorizontalSampling = 1;
+                int maxVerticalSampling = 1;
+                for (int i = 0; i < componentCount; ++i)
+                {
+                    unsigned char samplingFactors = segment[6 + 3 * i + 1];
+                    maxHorizontalSampling = std::max(maxHorizontalSampling, samplingFactors >> 4);
+                    maxVerticalSampling = std::max(maxVerticalSampling, samplingFactors & 0x0F);
+                }
+                layout.mcuWidth = BLOCK_SIZE * maxHorizontalSampling;
+                layout.mcuHeight = BLOCK_SIZE * maxVerticalSampling;
+            }
+
+            layout.isSplittable = marker == 0xC0 || marker == 0xC1;
+        }
+        else if (marker == DRI_MARKER)
+        {
+            layout.restartInterval = length >= 4 ? readUint16(segment) : 0;
+        }
+        else if (marker == SOS_MARKER)
+        {
+            // Every component must be in this scan, the bands are cut in its MCUs
+            layout.isSplittable = layout.isSplittable && length >= 3 && segment[0] == componentCount;
+            layout.entropyBegin = pos + 2 + length;
+        }
+
+        pos += 2 + length;
+    }
+
+    if (layout.width == 0 || layout.height == 0)
+    {
+        return false;
+    }
+
+    // The entropy data ends on the first marker that is not a restart marker, usually the EOI
+    layout.entropyEnd = size;
+    pos = layout.entropyBegin;
+    while (pos + 1 < size)
+    {
+        const void* prefix = std::memchr(data + pos, MARKER_PREFIX, size - pos - 1);
+        if (prefix == nullptr)
+        {
+            break;
+        }
+
+        pos = static_cast<const unsigned char*>(prefix) - data;
+        unsigned char marker = data[pos + 1];
+        if (marker == STUFFED_BYTE)
+        {
+            pos += 2;
+        }
+        else if (marker == MARKER_PREFIX)
+        {
+            ++pos;
+        }
+        else if (marker >= RST0_MARKER && marker <= RST7_MARKER)
+        {
+            layout.restartMarkerOffsets.push_back(pos);
+            pos += 2;
+        }
+        else
+        {
+            layout.entropyEnd = pos;
+            break;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Decode bands [firstBand, endBand) as a JPEG made of the frame header, with the height of the bands, and
+ * of their entropy data, restart markers renumbered from RST0.
+ */
+void MjpegDecoder::decodeBands(const unsigned char* jpegData, int firstBand, int endBand, int bandMcuRows,
+                               Image& outImage)
+{
+    int mcusPerRow = (layout_.width + layout_.mcuWidth - 1) / layout_.mcuWidth;
+    std::size_t intervalsPerBand = static_cast<std::size_t>(bandMcuRows) * mcusPerRow / layout_.restartInterval;
+    std::size_t intervalCount = layout_.restartMarkerOffsets.size() + 1;
+    std::size_t firstInterval = firstBand * intervalsPerBand;
+    std::size_t endInterval = std::min(endBand * intervalsPerBand, intervalCount);
+
+    std::size_t dataBegin =
+        firstInterval == 0 ? layout_.entropyBegin : layout_.restartMarkerOffsets[firstInterval - 1] + 2;
+    std::size_t dataEnd =
+        endInterval == intervalCount ? layout_.entropyEnd : layout_.restartMarkerOffsets[endInterval - 1];
+
+    int firstRow = firstBand * bandMcuRows * layout_.mcuHeight;
+    int endRow = std::min(endBand * bandMcuRows * layout_.mcuHeight, layout_.height);
+
+    std::unique_ptr<DecodeContext> context = acquireContext();
+    std::vector<unsigned char>& bandData = context->bandData;
+
+    bandData.assign(jpegData, jpegData + layout_.entropyBegin);
+    bandData[layout_.sofHeightOffset] = static_cast<unsigned char>((endRow - firstRow) >> 8);
+    bandData[layout_.sofHeightOffset + 1] = static_cast<unsigned char>(endRow - firstRow);
+    bandData.insert(bandData.end(), jpegData + dataBegin, jpegData + dataEnd);
+    bandData.push_back(MARKER_PREFIX);
+    bandData.push_back(EOI_MARKER);
+
+    for (std::size_t interval = firstInterval; interval + 1 < endInterval; ++interval)
+    {
+        std::size_t markerOffset = layout_.restartMarkerOffsets[interval] - dataBegin + layout_.entropyBegin;
+        bandData[markerOffset + 1] = static_cast<unsigned char>(RST0_MARKER + (interval - firstInterval) % 8);
+    }
+
+    bool isDecoded = decompress(*context, bandData.data(), bandData.size(), firstRow, outImage);
+    std::string message = isDecoded ? "" : context->errorManager.message;
+    releaseContext(std::move(context));
+
+    if (!isDecoded)
+    {
+        throw std::runtime_error("Error in MjpegDecoder - " + message);
+    }
+}
+
+/**
+ * @brief Decode a whole JPEG on the calling thread, its first row is row firstRow of the image.
+ */
+void MjpegDecoder::decodeRows(const unsigned char* data, std::size_t size, int firstRow, Image& outImage)
+{
+    std::unique_ptr<DecodeContext> context = acquireContext();
+    bool isDecoded = decompress(*context, data, size, firstRow, outImage);
+    std::string message = isDecoded ? "" : context->errorManager.message;
+    releaseContext(std::move(context));
+
+    if (!isDecoded)
+    {
+        throw std::runtime_error("Error in MjpegDecoder - " + message);
+    }
+}
+
+/**
+ * @brief Decode the rows of the JPEG inside the decode region, RGB is written in place and YCbCr is packed row by
+ * row while it is in cache. Errors jump back here, nothing in this function needs to be destroyed.
+ * @return false on a libjpeg error, its message is in the error manager of the context.
+ */
+bool MjpegDecoder::decompress(DecodeContext& context, const unsigned char* data, std::size_t size, int firstRow,
+                              Image& outImage) const
+{
+    jpeg_decompress_struct& cinfo = context.cinfo;
+
+    if (setjmp(context.errorManager.jumpBuffer))
+    {
+        jpeg_abort_decompress(&cinfo);
+        return false;
+    }
+
+    jpeg_mem_src(&cinfo, data, size);
+    jpeg_read_header(&cinfo, TRUE);
+    cinfo.out_color_space = outImage.format == ImageFormat::RGB_FMT ? JCS_RGB : JCS_YCbCr;
+
+    // Chroma is replicated instead of interpolated with the neighbouring rows and columns: the bands and the region
+    // are decoded exactly like the whole frame, and the packed formats subsample the chroma again anyway
+    cinfo.do_fancy_upsampling = FALSE;
+    jpeg_start_decompress(&cinfo);
+
+    JDIMENSION xOffset = frameRegion_.x;
+    JDIMENSION width = frameRegion_.width;
+    if (width < cinfo.output_width)
+    {
+        // Widened to the MCU boundaries, the offset stays even for the packed formats
+        jpeg_crop_scanline(&cinfo, &xOffset, &width);
+    }
+
+    int beginRow = std::max(frameRegion_.y - firstRow, 0);
+    int endRow = std::min(frameRegion_.y + frameRegion_.height - firstRow, static_cast<int>(cinfo.output_height));
+    if (beginRow > 0)
+    {
+        jpeg_skip_scanlines(&cinfo, beginRow);
+    }
+
+    std::size_t rowBytes = static_cast<std::size_t>(outImage.width) * getBytesPerPixel(outImage.format);
+    std::size_t pixelBytes = static_cast<std::size_t>(getBytesPerPixel(outImage.format));
+    context.rowBuffer.resize(static_cast<std::size_t>(width) * cinfo.output_components);
+
+    while (static_cast<int>(cinfo.output_scanline) < endRow)
+    {
+        unsigned char* outRow = outImage.hostData + (firstRow + cinfo.output_scanline) * rowBytes;
+
+        if (outImage.format == ImageFormat::RGB_FMT)
+        {
+            JSAMPROW row = outRow + xOffset * pixelBytes;
+            jpeg_read_scanlines(&cinfo, &row, 1);
+        }
+        else
+        {
+            JSAMPROW row = context.rowBuffer.data();
+            jpeg_read_scanlines(&cinfo, &row, 1);
+            packYuv422(row, width, outRow + xOffset * pixelBytes, outImage.format);
+        }
+    }
+
+    // The rows after the region are never decoded
+    jpeg_abort_decompress(&cinfo);
+    return true;
+}
+
+void MjpegDecoder::packYuv422(const unsigned char* yccRow, int width, unsigned char* outRow, ImageFormat format) const
+{
+    int pairCount = width / 2;
+
+    if (format == ImageFormat::UYVY_FMT)
+    {
+        UYVY* uyvyRow = reinterpret_cast<UYVY*>(outRow);
+        for (int i = 0; i < pairCount; ++i, yccRow += 6)
+        {
+            uyvyRow[i].u = chromaTable_[(yccRow[1] + yccRow[4] + 1) >> 1];
+            uyvyRow[i].y1 = lumaTable_[yccRow[0]];
+            uyvyRow[i].v = chromaTable_[(yccRow[2] + yccRow[5] + 1) >> 1];
+            uyvyRow[i].y2 = lumaTable_[yccRow[3]];
+        }
+    }
+    else
+    {
+        YUYV* yuyvRow = reinterpret_cast<YUYV*>(outRow);
+        for (int i = 0; i < pairCount; ++i, yccRow += 6)
+        {
+            yuyvRow[i].y1 = lumaTable_[yccRow[0]];
+            yuyvRow[i].u = chromaTable_[(yccRow[1] + yccRow[4] + 1) >> 1];
+            yuyvRow[i].y2 = lumaTable_[yccRow[3]];
+            yuyvRow[i].v = chromaTable_[(yccRow[2] + yccRow[5] + 1) >> 1];
+        }
+    }
+}
+
+/**
+ * @brief Paint the pixels outside the decode region black, the images come from pools and hold older frames.
+ */
+void MjpegDecoder::fillOutsideRegion(Image& outImage) const
+{
+    if (frameRegion_.width == outImage.width && frameRegion_.height == outImage.height)
+    {
+        return;
+    }
+
+    std::size_t pixelBytes = static_cast<std::size_t>(getBytesPerPixel(outImage.format));
+    std::size_t rowBytes = outImage.width * pixelBytes;
+
+    // A pair of black pixels in the format of the image, video range for the packed formats
+    unsigned char blackPair[6] = {};
+    if (outImage.format == ImageFormat::UYVY_FMT)
+    {
+        const unsigned char uyvyBlack[4] = {128, 16, 128, 16};
+        std::memcpy(blackPair, uyvyBlack, sizeof(uyvyBlack));
+    }
+    else if (outImage.format == ImageFormat::YUYV_FMT)
+    {
+        const unsigned char yuyvBlack[4] = {16, 128, 16, 128};
+        std::memcpy(blackPair, yuyvBlack, sizeof(yuyvBlack));
+    }
+
+    // Regions start and end on even columns, a pair is never split
+    auto fillRow = [&](unsigned char* row, int beginColumn, int endColumn) {
+        for (int x = beginColumn; x + 1 < endColumn; x += 2)
+        {
+            std::memcpy(row + x * pixelBytes, blackPair, 2 * pixelBytes);
+        }
+    };
+
+    int regionEnd = frameRegion_.y + frameRegion_.height;
+    for (int y = 0; y < outImage.height; ++y)
+    {
+        unsigned char* row = outImage.hostData + y * rowBytes;
+        if (y < frameRegion_.y || y >= regionEnd)
+        {
+            fillRow(row, 0, outImage.width);
+        }
+        else
+        {
+            fillRow(row, 0, frameRegion_.x);
+            fillRow(row, frameRegion_.x + frameRegion_.width, outImage.width);
+        }
+    }
+}
+
+std::unique_ptr<MjpegDecoder::DecodeContext> MjpegDecoder::acquireContext()
+{
+    {
+        std::lock_guard<std::mutex> lock(contextMutex_);
+
+        if (!freeContexts_.empty())
+        {
+            std::unique_ptr<DecodeContext> context = std::move(freeContexts_.back());
+            freeContexts_.pop_back();
+            return context;
+        }
+    }
+
+    // One per thread decoding at the same time, created on the first frames
+    return std::make_unique<DecodeContext>();
+}
+
+void MjpegDecoder::releaseContext(std::unique_ptr<DecodeContext> context)
+{
+    std::lock_guard<std::mutex> lock(contextMutex_);
+    freeContexts_.push_back(std::move(context));
+}
+
+}    // namespace Model
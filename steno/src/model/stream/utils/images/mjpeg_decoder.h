@@ -0,0 +1,80 @@
+#ifndef MJPEG_DECODER_H
+#define MJPEG_DECODER_H
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "model/stream/utils/images/images.h"
+#include "model/stream/utils/models/rectangle.h"
+#include "model/stream/utils/threads/task_scheduler.h"
+
+namespace Model
+{
+/**
+ * @brief Decodes MJPEG frames straight into RGB, UYVY or YUYV images. Frames with restart markers are split in bands
+ * of MCU rows decoded in parallel on the task scheduler, a band is a JPEG of its own once the frame header is given
+ * its height. Other frames are decoded on the calling thread.
+ */
+class MjpegDecoder
+{
+   public:
+    MjpegDecoder(std::shared_ptr<TaskScheduler> taskScheduler, TaskPriority priority);
+    ~MjpegDecoder();
+
+    MjpegDecoder(const MjpegDecoder&) = delete;
+    MjpegDecoder& operator=(const MjpegDecoder&) = delete;
+
+    void setDecodeRegion(const Rectangle& region);
+    void decode(const unsigned char* jpegData, std::size_t jpegSize, Image& outImage);
+
+   private:
+    // libjpeg state of a thread, reused from frame to frame
+    struct DecodeContext;
+
+    struct FrameLayout
+    {
+        int width;
+        int height;
+        int mcuWidth;
+        int mcuHeight;
+        int restartInterval;    // MCUs between restart markers, 0 without markers
+        bool isSplittable;      // Baseline frame with a single interleaved scan
+        std::size_t sofHeightOffset;
+        std::size_t entropyBegin;
+        std::size_t entropyEnd;
+        std::vector<std::size_t> restartMarkerOffsets;
+    };
+
+    bool parseFrame(const unsigned char* data, std::size_t size, FrameLayout& layout) const;
+    void decodeBands(const unsigned char* jpegData, int firstBand, int endBand, int bandMcuRows, Image& outImage);
+    void decodeRows(const unsigned char* data, std::size_t size, int firstRow, Image& outImage);
+    bool decompress(DecodeContext& context, const unsigned char* data, std::size_t size, int firstRow,
+                    Image& outImage) const;
+    void fillOutsideRegion(Image& outImage) const;
+    void packYuv422(const unsigned char* yccRow, int width, unsigned char* outRow, ImageFormat format) const;
+    std::unique_ptr<DecodeContext> acquireContext();
+    void releaseContext(std::unique_ptr<DecodeContext> context);
+
+    std::shared_ptr<TaskScheduler> taskScheduler_;
+    TaskPriority priority_;
+
+    // Pixels outside the region are black, the whole image is decoded without region
+    Rectangle decodeRegion_;
+    bool hasDecodeRegion_;
+    Rectangle frameRegion_;
+
+    FrameLayout layout_;
+
+    // JPEG is full range, the images are video range like the other converted images
+    unsigned char lumaTable_[256];
+    unsigned char chromaTable_[256];
+
+    std::mutex contextMutex_;
+    std::vector<std::unique_ptr<DecodeContext>> freeContexts_;
+};
+
+}    // namespace Model
+
+#endif    //! MJPEG_DECODER_H
@@ -1,5 +1,6 @@
 #include "angle_calculations.h"
 
+#include <algorithm>
 #include <cmath>
 #include <stdexcept>
 
@@ -10,6 +11,37 @@ namespace Model
 {
 namespace math
 {
+namespace
+{
+/**
+ * @brief Branchless atan2 so a loop over many positions is vectorized, the polynomial (Abramowitz and Stegun 4.4.49)
+ * is accurate to float precision on [0, 1].
+ */
+inline float approximateAtan2(float y, float x)
+{
+    float absX = std::abs(x);
+    float absY = std::abs(y);
+    float maxValue = std::max(absX, absY);
+    float ratio = maxValue > 0.f ? std::min(absX, absY) / maxValue : 0.f;
+    float ratio2 = ratio * ratio;
+
+    float angle = -0.0040540580f;
+    angle = angle * ratio2 + 0.0218612288f;
+    angle = angle * ratio2 - 0.0559098861f;
+    angle = angle * ratio2 + 0.0964200441f;
+    angle = angle * ratio2 - 0.1390853351f;
+    angle = angle * ratio2 + 0.1994653599f;
+    angle = angle * ratio2 - 0.3332985605f;
+    angle = angle * ratio2 + 0.9999993329f;
+    angle *= ratio;
+
+    angle = absY > absX ? math::PI / 2.f - angle : angle;
+    angle = x < 0.f ? math::PI - angle : angle;
+    return y < 0.f ? -angle : angle;
+}
+
+}    // namespace
+
 float deg2rad(float deg)
 {
     return deg * math::PI / 180.f;
@@ -57,6 +89,21 @@ float getElevationFromPosition(float x, float y, float z)
     return getPositiveAngle(tanRes);
 }
 
+/**
+ * @brief Same as getAzimuthFromPosition and getElevationFromPosition for many positions at once.
+ */
+void getSphericalAnglesFromPositions(const float* x, const float* y, const float* z, std::size_t count,
+                                     float* outAzimuths, float* outElevations)
+{
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        float azimuth = approximateAtan2(y[i], x[i]);
+        float elevation = approximateAtan2(z[i], std::sqrt(x[i] * x[i] + y[i] * y[i]));
+        outAzimuths[i] = azimuth < 0.f ? azimuth + math::PI * 2.f : azimuth;
+        outElevations[i] = elevation < 0.f ? elevation + math::PI * 2.f : elevation;
+    }
+}
+
 float getElevationFromDistanceToFisheyeCenter(float distanceToFisheyeCenter, float fisheyeRadius, float fisheyeAngle)
 {
     float distanceFromFisheyeEdge = fisheyeRadius - distanceToFisheyeCenter;
@@ -1,6 +1,8 @@
 #ifndef ANGLE_CALCULATIONS_H
 #define ANGLE_CALCULATIONS_H
 
+#include <cstddef>
+
 #include "model/stream/utils/models/point.h"
 #include "model/stream/video/dewarping/models/dewarping_parameters.h"
 
@@ -16,6 +18,8 @@ float getPositiveAngle(float angle);
 
 float getAzimuthFromPosition(float x, float y);
 float getElevationFromPosition(float x, float y, float z);
+void getSphericalAnglesFromPositions(const float* x, const float* y, const float* z, std::size_t count,
+                                     float* outAzimuths, float* outElevations);
 
 float getElevationFromDistanceToFisheyeCenter(float distanceToFisheyeCenter, float fisheyeRadius, float fisheyeAngle);
 float getDistanceToFisheyeCenterFromElevation(float elevation, float fisheyeRadius, float fisheyeAngle);
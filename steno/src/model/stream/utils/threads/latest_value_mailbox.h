@@ -0,0 +1,113 @@
+#ifndef LATEST_VALUE_MAILBOX_H
+#define LATEST_VALUE_MAILBOX_H
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+namespace Model
+{
+struct MailboxStats
+{
+    uint64_t producedCount = 0;
+    uint64_t consumedCount = 0;
+    uint64_t droppedCount = 0;
+};
+
+/**
+ * @brief Single slot handoff between a producer and a consumer where the newest value wins. Publishing never
+ * blocks, an unconsumed value is overwritten and handed back to the producer so it can reuse it (e.g. its buffer).
+ * Values are moved out, the mailbox keeps no reference to a consumed value.
+ */
+template <typename T>
+class LatestValueMailbox
+{
+   public:
+    explicit LatestValueMailbox(const T& value = T())
+        : value_(value)
+        , hasValue_(false)
+        , producedCount_(0)
+        , consumedCount_(0)
+        , droppedCount_(0)
+        , lock_(ATOMIC_FLAG_INIT)
+    {
+    }
+
+    /**
+     * @brief Publish a value, overwriting the previous one if it was not consumed.
+     * @param outDisplaced - receives the overwritten value, if any.
+     * @return true if an unconsumed value was overwritten.
+     */
+    bool publish(const T& value, T& outDisplaced)
+    {
+        getLock();
+        bool isDisplaced = hasValue_;
+        if (isDisplaced)
+        {
+            outDisplaced = std::move(value_);
+        }
+        value_ = value;
+        hasValue_ = true;
+        releaseLock();
+
+        ++producedCount_;
+        if (isDisplaced)
+        {
+            ++droppedCount_;
+        }
+
+        return isDisplaced;
+    }
+
+    bool tryConsume(T& outValue)
+    {
+        getLock();
+        bool hasValue = hasValue_;
+        if (hasValue)
+        {
+            outValue = std::move(value_);
+            hasValue_ = false;
+        }
+        releaseLock();
+
+        if (hasValue)
+        {
+            ++consumedCount_;
+        }
+
+        return hasValue;
+    }
+
+    MailboxStats getStats() const
+    {
+        MailboxStats stats;
+        stats.producedCount = producedCount_;
+        stats.consumedCount = consumedCount_;
+        stats.droppedCount = droppedCount_;
+        return stats;
+    }
+
+   private:
+    void getLock()
+    {
+        while (lock_.test_and_set(std::memory_order_acquire))
+        {
+        }
+    }
+
+    void releaseLock()
+    {
+        lock_.clear(std::memory_order_release);
+    }
+
+    T value_;
+    bool hasValue_;
+    std::atomic<uint64_t> producedCount_;
+    std::atomic<uint64_t> consumedCount_;
+    std::atomic<uint64_t> droppedCount_;
+    std::atomic_flag lock_;
+};
+
+}    // namespace Model
+
+#endif    //! LATEST_VALUE_MAILBOX_H
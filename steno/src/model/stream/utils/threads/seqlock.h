@@ -0,0 +1,72 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace Model
+{
+/**
+ * @brief Single writer, multiple readers sequence lock. Readers never block the writer and never allocate,
+ * they copy the value and retry if a write happened during the copy.
+ */
+template <typename T>
+class SeqLock
+{
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock value must be trivially copyable");
+
+   public:
+    explicit SeqLock(const T& value = T())
+        : sequence_(0)
+        , value_(value)
+    {
+    }
+
+    void store(const T& value)
+    {
+        uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+
+        // An odd sequence tells readers a write is in progress
+        sequence_.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        std::memcpy(&value_, &value, sizeof(T));
+
+        sequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Copy the last stored value.
+     * @return version of the copied value, incremented by one on each store.
+     */
+    uint64_t load(T& outValue) const
+    {
+        uint64_t before;
+        uint64_t after;
+
+        do
+        {
+            before = sequence_.load(std::memory_order_acquire);
+            std::memcpy(&outValue, &value_, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = sequence_.load(std::memory_order_relaxed);
+        } while ((before & 1) != 0 || before != after);
+
+        return before / 2;
+    }
+
+    uint64_t getVersion() const
+    {
+        return sequence_.load(std::memory_order_acquire) / 2;
+    }
+
+   private:
+    alignas(64) std::atomic<uint64_t> sequence_;
+    T value_;
+};
+
+}    // namespace Model
+
+#endif    //! SEQLOCK_H
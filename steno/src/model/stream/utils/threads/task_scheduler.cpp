@@ -0,0 +1,295 @@
+#include "task_scheduler.h"
+
+#include <iostream>
+#include <stdexcept>
+
+namespace Model
+{
+namespace
+{
+const int PRIORITY_COUNT = 2;
+
+// Lets a task submitted from a worker go in that worker's own deque
+struct WorkerIdentity
+{
+    const TaskScheduler* scheduler = nullptr;
+    int index = -1;
+};
+
+thread_local WorkerIdentity currentWorker;
+
+}    // namespace
+
+TaskScheduler::TaskScheduler(int workerCount)
+    : pendingTaskCount_(0)
+    , nextQueueIndex_(0)
+    , isAbortRequested_(false)
+{
+    if (workerCount < 0)
+    {
+        throw std::invalid_argument("Error in TaskScheduler - worker count cannot be negative");
+    }
+
+    for (int i = 0; i < workerCount * PRIORITY_COUNT; ++i)
+    {
+        queues_.push_back(std::make_unique<WorkerQueue>());
+    }
+
+    workers_.reserve(workerCount);
+    for (int i = 0; i < workerCount; ++i)
+    {
+        workers_.emplace_back(&TaskScheduler::workerExecution, this, i);
+    }
+}
+
+/**
+ * @brief Stop and join the workers, tasks still queued at this point are never executed.
+ */
+TaskScheduler::~TaskScheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        isAbortRequested_ = true;
+    }
+    sleepCondition_.notify_all();
+
+    for (std::thread& worker : workers_)
+    {
+        worker.join();
+    }
+}
+
+/**
+ * @brief Queue a task, if there are no workers the task is executed right away on the calling thread.
+ */
+void TaskScheduler::submit(std::function<void()> task, TaskPriority priority)
+{
+    int workerCount = getWorkerCount();
+    if (workerCount == 0)
+    {
+        task();
+        return;
+    }
+
+    int workerIndex = getCurrentWorkerIndex();
+    if (workerIndex < 0)
+    {
+        workerIndex = static_cast<int>(nextQueueIndex_++ % static_cast<unsigned int>(workerCount));
+    }
+
+    WorkerQueue& queue = getQueue(workerIndex, priority);
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+
+    ++pendingTaskCount_;
+
+    // Taking the lock makes sure a worker can't miss the notification between its check and its wait
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+    }
+    sleepCondition_.notify_one();
+}
+
+/**
+ * @brief Execute one queued task on the calling thread, used by workers and by threads waiting on a TaskGroup.
+ * @param lowestPriority - tasks with a lower priority than this one are left in the queues.
+ * @return true if a task was executed.
+ */
+bool TaskScheduler::tryRunTask(TaskPriority lowestPriority)
+{
+    if (pendingTaskCount_ == 0)
+    {
+        return false;
+    }
+
+    int workerIndex = getCurrentWorkerIndex();
+    std::function<void()> task;
+
+    for (int priority = 0; priority <= static_cast<int>(lowestPriority); ++priority)
+    {
+        TaskPriority taskPriority = static_cast<TaskPriority>(priority);
+        if ((workerIndex >= 0 && popTask(workerIndex, taskPriority, task)) ||
+            stealTask(workerIndex, taskPriority, task))
+        {
+            --pendingTaskCount_;
+            task();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int TaskScheduler::getWorkerCount() const
+{
+    return static_cast<int>(workers_.size());
+}
+
+/**
+ * @brief One worker per core, minus the core used by the thread submitting the work.
+ */
+int TaskScheduler::getDefaultWorkerCount()
+{
+    int coreCount = static_cast<int>(std::thread::hardware_concurrency());
+    return std::max(coreCount - 1, 0);
+}
+
+void TaskScheduler::workerExecution(int workerIndex)
+{
+    currentWorker.scheduler = this;
+    currentWorker.index = workerIndex;
+
+    while (!isAbortRequested_)
+    {
+        try
+        {
+            if (tryRunTask(TaskPriority::LOW))
+            {
+                continue;
+            }
+        }
+        catch (const std::exception& e)
+        {
+            std::cout << "Exception during task execution : " << e.what() << std::endl;
+            continue;
+        }
+        catch (...)
+        {
+            std::cout << "Unknown exception during task execution" << std::endl;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        sleepCondition_.wait(lock, [this] { return isAbortRequested_ || pendingTaskCount_ > 0; });
+    }
+}
+
+bool TaskScheduler::popTask(int workerIndex, TaskPriority priority, std::function<void()>& task)
+{
+    WorkerQueue& queue = getQueue(workerIndex, priority);
+    std::lock_guard<std::mutex> lock(queue.mutex);
+
+    if (queue.tasks.empty())
+    {
+        return false;
+    }
+
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool TaskScheduler::stealTask(int thiefIndex, TaskPriority priority, std::function<void()>& task)
+{
+    int workerCount = getWorkerCount();
+
+    // Start after the thief so all workers don't hammer the same victim
+    for (int offset = 1; offset <= workerCount; ++offset)
+    {
+        int victimIndex = (thiefIndex + offset + workerCount) % workerCount;
+        if (victimIndex == thiefIndex)
+        {
+            continue;
+        }
+
+        WorkerQueue& queue = getQueue(victimIndex, priority);
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if (!queue.tasks.empty())
+        {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int TaskScheduler::getCurrentWorkerIndex() const
+{
+    return currentWorker.scheduler == this ? currentWorker.index : -1;
+}
+
+TaskScheduler::WorkerQueue& TaskScheduler::getQueue(int workerIndex, TaskPriority priority)
+{
+    return *queues_[workerIndex * PRIORITY_COUNT + static_cast<int>(priority)];
+}
+
+TaskGroup::TaskGroup(TaskScheduler* scheduler, TaskPriority priority)
+    : scheduler_(scheduler)
+    , priority_(priority)
+    , pendingTaskCount_(0)
+{
+}
+
+TaskGroup::~TaskGroup()
+{
+    // Tasks reference this group, they must be done before it goes away
+    std::unique_lock<std::mutex> lock(mutex_);
+    doneCondition_.wait(lock, [this] { return pendingTaskCount_ == 0; });
+}
+
+void TaskGroup::run(std::function<void()> task)
+{
+    if (scheduler_ == nullptr)
+    {
+        executeTask(task);
+        return;
+    }
+
+    ++pendingTaskCount_;
+
+    scheduler_->submit(
+        [this, task]() {
+            executeTask(task);
+
+            // Notify under the lock, otherwise the waiter could destroy the group while it is still used here
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--pendingTaskCount_ == 0)
+            {
+                doneCondition_.notify_all();
+            }
+        },
+        priority_);
+}
+
+/**
+ * @brief Help executing queued tasks until every task of the group is done. Only tasks with a priority at least as
+ * high as the group's priority are picked, so a media thread never ends up running detection work.
+ */
+void TaskGroup::wait()
+{
+    while (pendingTaskCount_ > 0 && scheduler_->tryRunTask(priority_))
+    {
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    doneCondition_.wait(lock, [this] { return pendingTaskCount_ == 0; });
+
+    if (exception_)
+    {
+        std::exception_ptr exception = exception_;
+        exception_ = nullptr;
+        std::rethrow_exception(exception);
+    }
+}
+
+void TaskGroup::executeTask(const std::function<void()>& task)
+{
+    try
+    {
+        task();
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!exception_)
+        {
+            exception_ = std::current_exception();
+        }
+    }
+}
+}    // namespace Model
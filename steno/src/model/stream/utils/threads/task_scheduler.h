@@ -0,0 +1,146 @@
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Model
+{
+/**
+ * @brief Order in which queued tasks are picked. Every queued HIGH task is executed before any LOW task.
+ * HIGH is for the media path (conversion, dewarping, compositing), LOW for detection.
+ */
+enum class TaskPriority
+{
+    HIGH = 0,
+    LOW = 1
+};
+
+/**
+ * @brief Work-stealing task pool shared by every stage of the stream. Each worker owns one deque per priority,
+ * it pops its own tasks LIFO (cache locality) and steals from other workers FIFO (oldest, usually biggest, work).
+ */
+class TaskScheduler
+{
+   public:
+    explicit TaskScheduler(int workerCount = getDefaultWorkerCount());
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    void submit(std::function<void()> task, TaskPriority priority);
+    bool tryRunTask(TaskPriority lowestPriority);
+    int getWorkerCount() const;
+
+    static int getDefaultWorkerCount();
+
+   private:
+    struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void workerExecution(int workerIndex);
+    bool popTask(int workerIndex, TaskPriority priority, std::function<void()>& task);
+    bool stealTask(int thiefIndex, TaskPriority priority, std::function<void()>& task);
+    int getCurrentWorkerIndex() const;
+    WorkerQueue& getQueue(int workerIndex, TaskPriority priority);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<int> pendingTaskCount_;
+    std::atomic<unsigned int> nextQueueIndex_;
+    std::atomic<bool> isAbortRequested_;
+    std::mutex sleepMutex_;
+    std::condition_variable sleepCondition_;
+};
+
+/**
+ * @brief Fork-join helper, tasks are run on the scheduler and wait() helps executing them. The first exception
+ * thrown by a task is rethrown by wait(). Without scheduler the tasks are run inline.
+ */
+class TaskGroup
+{
+   public:
+    TaskGroup(TaskScheduler* scheduler, TaskPriority priority);
+    ~TaskGroup();
+
+    void run(std::function<void()> task);
+    void wait();
+
+   private:
+    void executeTask(const std::function<void()>& task);
+
+    TaskScheduler* scheduler_;
+    TaskPriority priority_;
+    std::atomic<int> pendingTaskCount_;
+    std::mutex mutex_;
+    std::condition_variable doneCondition_;
+    std::exception_ptr exception_;
+};
+
+/**
+ * @brief Split [begin, end) in chunks of at least grainSize and call func(chunkBegin, chunkEnd) on each chunk in
+ * parallel. The calling thread executes the first chunk and returns once every chunk is done.
+ */
+template <typename Func>
+void parallelFor(TaskScheduler* scheduler, TaskPriority priority, int begin, int end, int grainSize, const Func& func)
+{
+    int count = end - begin;
+    if (count <= 0)
+    {
+        return;
+    }
+
+    grainSize = std::max(grainSize, 1);
+    int chunkCount = (count + grainSize - 1) / grainSize;
+
+    if (scheduler == nullptr || scheduler->getWorkerCount() == 0 || chunkCount == 1)
+    {
+        func(begin, end);
+        return;
+    }
+
+    // A few chunks per thread so faster threads can steal from slower ones
+    chunkCount = std::min(chunkCount, (scheduler->getWorkerCount() + 1) * 4);
+    int chunkSize = (count + chunkCount - 1) / chunkCount;
+
+    TaskGroup taskGroup(scheduler, priority);
+    for (int chunkBegin = begin + chunkSize; chunkBegin < end; chunkBegin += chunkSize)
+    {
+        int chunkEnd = std::min(chunkBegin + chunkSize, end);
+        taskGroup.run([&func, chunkBegin, chunkEnd]() { func(chunkBegin, chunkEnd); });
+    }
+
+    std::exception_ptr exception;
+    try
+    {
+        func(begin, std::min(begin + chunkSize, end));
+    }
+    catch (...)
+    {
+        exception = std::current_exception();
+    }
+
+    // Must wait even on error, the queued chunks reference func
+    taskGroup.wait();
+
+    if (exception)
+    {
+        std::rethrow_exception(exception);
+    }
+}
+
+}    // namespace Model
+
+#endif    //! TASK_SCHEDULER_H
@@ -32,7 +32,9 @@ void Thread::stop()
 {
     if (isRunning_)
     {
+        std::lock_guard<std::mutex> lock(abortMutex_);
         isAbortRequested_ = true;
+        abortCondition_.notify_all();
     }
 }
 
@@ -81,4 +83,15 @@ void Thread::sleep(const int timeMs)
 {
     std::this_thread::sleep_for(std::chrono::milliseconds(timeMs));
 }
+
+/**
+ * @brief Put the thread in pause until a deadline, or until an abort is requested.
+ * @param deadline - time to wake up at.
+ * @return false if the pause was interrupted by an abort request.
+ */
+bool Thread::sleepUntil(std::chrono::steady_clock::time_point deadline)
+{
+    std::unique_lock<std::mutex> lock(abortMutex_);
+    return !abortCondition_.wait_until(lock, deadline, [this] { return isAbortRequested_.load(); });
+}
 }    // namespace Model
@@ -2,7 +2,10 @@
 #define THREAD_H
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <thread>
 
 namespace Model
@@ -19,6 +22,7 @@ class Thread
     bool isRunning();
     bool isAbortRequested();
     void sleep(const int timeMs);
+    bool sleepUntil(std::chrono::steady_clock::time_point deadline);
 
     enum class ThreadStatus
     {
@@ -42,6 +46,10 @@ class Thread
     std::unique_ptr<std::thread> thread_;
     std::atomic<bool> isAbortRequested_;
     std::atomic<bool> isRunning_;
+
+    // Wakes up sleepUntil when an abort is requested
+    std::mutex abortMutex_;
+    std::condition_variable abortCondition_;
 };
 
 }    // namespace Model
@@ -0,0 +1,256 @@
+#include "media_clock.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+#include "model/stream/utils/time/time_utils.h"
+
+namespace
+{
+// Crystals drift by tens of ppm, more than this is a bad fit on a short or noisy window
+const double MAX_SKEW = 1000e-6;
+
+// The window keeps the fastest arrival of each interval, it spans about two minutes
+const int64_t OBSERVATION_INTERVAL_US = 1000000;
+
+// Over a short span the arrival jitter dominates the drift, the skew is left at 0
+const std::size_t MIN_SKEW_OBSERVATIONS = 8;
+const int64_t MIN_SKEW_SPAN_US = 8000000;
+
+// A source restarted or its clock was set, the previous observations do not apply anymore
+const int64_t DISCONTINUITY_US = 1000000;
+}    // namespace
+
+namespace Model
+{
+SourceClock::SourceClock(const std::string& name)
+    : name_(name)
+{
+    reset();
+}
+
+/**
+ * @brief Add a timestamp of the source and when it was received on the media timeline.
+ * @param [IN] sourceTimestamp - time in microseconds on the source clock.
+ * @param [IN] arrivalTime - MediaClock::now() when the timestamp was received.
+ */
+void SourceClock::observe(uint64_t sourceTimestamp, uint64_t arrivalTime)
+{
+    Observation observation = {sourceTimestamp, arrivalTime};
+
+    if (isIntervalStarted_)
+    {
+        int64_t error = static_cast<int64_t>(arrivalTime) -
+                        (anchorMediaTime_ + std::llround(rate_ * static_cast<int64_t>(sourceTimestamp -
+                                                                                      anchorSourceTimestamp_)));
+
+        if (sourceTimestamp < intervalStartTimestamp_ || std::abs(error) > DISCONTINUITY_US)
+        {
+            std::cout << "Clock of " << name_ << " jumped by " << error / 1000 << " ms, estimate reset" << std::endl;
+            reset();
+        }
+    }
+
+    if (!isIntervalStarted_)
+    {
+        fastestObservation_ = observation;
+        intervalStartTimestamp_ = sourceTimestamp;
+        isIntervalStarted_ = true;
+    }
+    else if (static_cast<int64_t>(sourceTimestamp - intervalStartTimestamp_) >= OBSERVATION_INTERVAL_US)
+    {
+        observations_[nextObservation_] = fastestObservation_;
+        nextObservation_ = (nextObservation_ + 1) % SOURCE_CLOCK_WINDOW_SIZE;
+        observationCount_ = std::min(observationCount_ + 1, SOURCE_CLOCK_WINDOW_SIZE);
+
+        fastestObservation_ = observation;
+        intervalStartTimestamp_ = sourceTimestamp;
+    }
+    else if (getRelativeDelay(observation, fastestObservation_, 1.0) < 0)
+    {
+        fastestObservation_ = observation;
+    }
+
+    updateEstimate();
+}
+
+/**
+ * @brief Map a source timestamp on the media timeline, the result never goes back for increasing timestamps.
+ * @return the arrival time if the source was not observed yet.
+ */
+uint64_t SourceClock::toMediaTime(uint64_t sourceTimestamp)
+{
+    if (!isIntervalStarted_)
+    {
+        return MediaClock::now();
+    }
+
+    int64_t delta = static_cast<int64_t>(sourceTimestamp - anchorSourceTimestamp_);
+    uint64_t mediaTime = static_cast<uint64_t>(anchorMediaTime_ + std::llround(rate_ * delta));
+
+    if (sourceTimestamp >= lastSourceTimestamp_)
+    {
+        mediaTime = std::max(mediaTime, lastMediaTime_);
+        lastSourceTimestamp_ = sourceTimestamp;
+        lastMediaTime_ = mediaTime;
+    }
+
+    return mediaTime;
+}
+
+/**
+ * @brief Forget the observations, e.g. when the source reconnects with a new clock.
+ */
+void SourceClock::reset()
+{
+    observationCount_ = 0;
+    nextObservation_ = 0;
+    fastestObservation_ = {0, 0};
+    intervalStartTimestamp_ = 0;
+    isIntervalStarted_ = false;
+    anchorSourceTimestamp_ = 0;
+    anchorMediaTime_ = 0;
+    rate_ = 1.0;
+    lastSourceTimestamp_ = 0;
+    lastMediaTime_ = 0;
+    estimate_.store(ClockEstimate());
+}
+
+ClockEstimate SourceClock::getEstimate() const
+{
+    ClockEstimate estimate;
+    estimate_.load(estimate);
+    return estimate;
+}
+
+const std::string& SourceClock::getName() const
+{
+    return name_;
+}
+
+/**
+ * @brief Fit the mapping on the window and the current interval, from the oldest to the newest observation.
+ */
+void SourceClock::updateEstimate()
+{
+    std::size_t count = observationCount_ + 1;
+    const Observation& origin = getObservation(0);
+    const Observation& last = getObservation(count - 1);
+
+    // Times are relative to the oldest observation to keep the precision of doubles
+    double meanX = 0;
+    double meanY = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const Observation& observation = getObservation(i);
+        meanX += static_cast<int64_t>(observation.sourceTimestamp - origin.sourceTimestamp);
+        meanY += static_cast<int64_t>(observation.arrivalTime - origin.arrivalTime);
+    }
+    meanX /= count;
+    meanY /= count;
+
+    double covarianceXY = 0;
+    double varianceX = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const Observation& observation = getObservation(i);
+        double x = static_cast<int64_t>(observation.sourceTimestamp - origin.sourceTimestamp) - meanX;
+        double y = static_cast<int64_t>(observation.arrivalTime - origin.arrivalTime) - meanY;
+        covarianceXY += x * y;
+        varianceX += x * x;
+    }
+
+    double rate = 1.0;
+    int64_t spanUs = static_cast<int64_t>(last.sourceTimestamp - origin.sourceTimestamp);
+    if (count >= MIN_SKEW_OBSERVATIONS && spanUs >= MIN_SKEW_SPAN_US && varianceX > 0)
+    {
+        rate = std::min(std::max(covarianceXY / varianceX, 1.0 - MAX_SKEW), 1.0 + MAX_SKEW);
+    }
+
+    // The line goes through the fastest arrival, the others were delayed by the transport
+    int64_t minDelay = std::numeric_limits<int64_t>::max();
+    double meanDelay = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        int64_t delay = getRelativeDelay(getObservation(i), origin, rate);
+        minDelay = std::min(minDelay, delay);
+        meanDelay += delay;
+    }
+    meanDelay /= count;
+
+    anchorSourceTimestamp_ = origin.sourceTimestamp;
+    anchorMediaTime_ = static_cast<int64_t>(origin.arrivalTime) + minDelay;
+    rate_ = rate;
+
+    ClockEstimate estimate;
+    estimate.offsetUs = anchorMediaTime_ + std::llround(rate_ * spanUs) - static_cast<int64_t>(last.sourceTimestamp);
+    estimate.skewPpm = (rate_ - 1.0) * 1e6;
+    estimate.jitterUs = meanDelay - minDelay;
+    estimate.sampleCount = count;
+    estimate_.store(estimate);
+}
+
+/**
+ * @brief Observations from the oldest of the window to the fastest of the current interval, at index observationCount_.
+ */
+const SourceClock::Observation& SourceClock::getObservation(std::size_t index) const
+{
+    if (index == observationCount_)
+    {
+        return fastestObservation_;
+    }
+
+    std::size_t oldest = observationCount_ < SOURCE_CLOCK_WINDOW_SIZE ? 0 : nextObservation_;
+    return observations_[(oldest + index) % SOURCE_CLOCK_WINDOW_SIZE];
+}
+
+/**
+ * @brief Arrival time of an observation past the prediction of a line of slope rate through the origin.
+ */
+int64_t SourceClock::getRelativeDelay(const Observation& observation, const Observation& origin, double rate) const
+{
+    int64_t elapsedArrival = static_cast<int64_t>(observation.arrivalTime - origin.arrivalTime);
+    int64_t elapsedSource = static_cast<int64_t>(observation.sourceTimestamp - origin.sourceTimestamp);
+    return elapsedArrival - std::llround(rate * elapsedSource);
+}
+
+/**
+ * @brief Current time on the media timeline, in microseconds. Monotonic, unlike the system clock it was anchored on.
+ */
+uint64_t MediaClock::now()
+{
+    return fromMonotonicTime(steadyTimeSinceEpoch());
+}
+
+/**
+ * @brief Map a time of the monotonic clock (the steady clock, e.g. kernel timestamps of V4L2 buffers) on the media
+ * timeline, both advance together.
+ */
+uint64_t MediaClock::fromMonotonicTime(uint64_t monotonicTimeUs)
+{
+    static const int64_t steadyToSystemOffset =
+        static_cast<int64_t>(systemTimeSinceEpoch()) - static_cast<int64_t>(steadyTimeSinceEpoch());
+    return static_cast<uint64_t>(static_cast<int64_t>(monotonicTimeUs) + steadyToSystemOffset);
+}
+
+/**
+ * @brief Create the mapping of a source clock, it is listed with its estimate until the media clock is destroyed.
+ */
+std::shared_ptr<SourceClock> MediaClock::addSource(const std::string& name)
+{
+    std::shared_ptr<SourceClock> source = std::make_shared<SourceClock>(name);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    sources_.push_back(source);
+    return source;
+}
+
+std::vector<std::shared_ptr<SourceClock>> MediaClock::getSources() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sources_;
+}
+
+}    // namespace Model
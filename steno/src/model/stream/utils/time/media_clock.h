@@ -0,0 +1,100 @@
+#ifndef MEDIA_CLOCK_H
+#define MEDIA_CLOCK_H
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "model/stream/utils/threads/seqlock.h"
+
+namespace Model
+{
+const std::size_t SOURCE_CLOCK_WINDOW_SIZE = 128;
+
+/**
+ * @brief Mapping of a source clock on the media timeline, media = source + offset, advancing 1 + skew times faster.
+ */
+struct ClockEstimate
+{
+    int64_t offsetUs = 0;          // Media time minus source time at the last observation
+    double skewPpm = 0;            // How much faster the media timeline runs than the source clock
+    double jitterUs = 0;           // Mean arrival delay above the fastest observed, e.g. network or scheduling
+    std::size_t sampleCount = 0;    // Observations in the window, the skew is only estimated past a few seconds
+};
+
+/**
+ * @brief Maps the timestamps of one source clock (e.g. odas) on the media timeline. Each timestamped packet is
+ * observed with its arrival time, only the fastest arrival of each interval is kept since it is the least delayed
+ * by the transport. The skew is a linear regression over a window of these, the offset follows the fastest of them.
+ * Observe and map from one thread, the estimate can be read from any thread.
+ */
+class SourceClock
+{
+   public:
+    explicit SourceClock(const std::string& name);
+
+    void observe(uint64_t sourceTimestamp, uint64_t arrivalTime);
+    uint64_t toMediaTime(uint64_t sourceTimestamp);
+    void reset();
+
+    ClockEstimate getEstimate() const;
+    const std::string& getName() const;
+
+   private:
+    struct Observation
+    {
+        uint64_t sourceTimestamp;
+        uint64_t arrivalTime;
+    };
+
+    void updateEstimate();
+    const Observation& getObservation(std::size_t index) const;
+    int64_t getRelativeDelay(const Observation& observation, const Observation& origin, double rate) const;
+
+    std::string name_;
+
+    std::array<Observation, SOURCE_CLOCK_WINDOW_SIZE> observations_;
+    std::size_t observationCount_;
+    std::size_t nextObservation_;
+
+    // Fastest arrival of the current interval, added to the window when the interval ends
+    Observation fastestObservation_;
+    uint64_t intervalStartTimestamp_;
+    bool isIntervalStarted_;
+
+    // media = anchorMediaTime_ + rate_ * (source - anchorSourceTimestamp_)
+    uint64_t anchorSourceTimestamp_;
+    int64_t anchorMediaTime_;
+    double rate_;
+
+    // Mapped timestamps never go back when the estimate moves
+    uint64_t lastSourceTimestamp_;
+    uint64_t lastMediaTime_;
+
+    SeqLock<ClockEstimate> estimate_;
+};
+
+/**
+ * @brief The media timeline shared by every stream: microseconds since epoch when the process started, then only
+ * following the steady clock. Local captures are stamped with now(), remote clocks are mapped by a SourceClock.
+ */
+class MediaClock
+{
+   public:
+    static uint64_t now();
+    static uint64_t fromMonotonicTime(uint64_t monotonicTimeUs);
+
+    std::shared_ptr<SourceClock> addSource(const std::string& name);
+    std::vector<std::shared_ptr<SourceClock>> getSources() const;
+
+   private:
+    mutable std::mutex mutex_;
+    std::vector<std::shared_ptr<SourceClock>> sources_;
+};
+
+}    // namespace Model
+
+#endif    //! MEDIA_CLOCK_H
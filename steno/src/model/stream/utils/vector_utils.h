@@ -7,8 +7,8 @@
 
 namespace Model
 {
-template <typename T, typename F>
-void removeElementsAndPack(std::vector<T>& vec, const F& checkFunc)
+template <typename T, typename A, typename F>
+void removeElementsAndPack(std::vector<T, A>& vec, const F& checkFunc)
 {
     vec.erase(std::remove_if(vec.begin(), vec.end(), checkFunc), vec.end());
 }
@@ -16,7 +16,8 @@ namespace Model
 {
 DetectionThread::DetectionThread(std::shared_ptr<LockTripleBuffer<RGBImage>> imageBuffer, std::unique_ptr<IDetector> detector,
                                  std::unique_ptr<IDetectionFisheyeDewarper> dewarper, std::unique_ptr<IObjectFactory> objectFactory,
-                                 std::unique_ptr<ISynchronizer> synchronizer, std::shared_ptr<DewarpingConfig> dewarpingConfig)
+                                 std::unique_ptr<ISynchronizer> synchronizer, std::shared_ptr<DewarpingConfig> dewarpingConfig,
+                                 std::shared_ptr<QualityGovernor> qualityGovernor)
     : Thread()
     , imageBuffer_(imageBuffer)
     , detector_(std::move(detector))
@@ -24,9 +25,10 @@ DetectionThread::DetectionThread(std::shared_ptr<LockTripleBuffer<RGBImage>> ima
     , objectFactory_(std::move(objectFactory))
     , synchronizer_(std::move(synchronizer))
     , dewarpingConfig_(dewarpingConfig)
+    , qualityGovernor_(qualityGovernor)
     , detectionQueue_(1)
 {
-    if (!imageBuffer_ || !detector_ || !dewarper_ || !objectFactory_ || !synchronizer_)
+    if (!imageBuffer_ || !detector_ || !dewarper_ || !objectFactory_ || !synchronizer_ || !qualityGovernor_)
     {
         throw std::invalid_argument("Error in DetectionThread - Arguments can not be null");
     }
@@ -54,6 +56,7 @@ void DetectionThread::run()
     std::vector<SphericalAngleRect> detections;
 
     DetectionDewarpingOptimizer detectionDewarpingOptimizer(dewarpingConfig_->detectionDewarpingCount, 4);
+    std::chrono::steady_clock::time_point detectionStartTime;
 
     try
     {
@@ -66,6 +69,10 @@ void DetectionThread::run()
 
         while (!isAbortRequested())
         {
+            // When the stream is overloaded the quality governor lowers the detection rate, a stop ends the wait
+            sleepUntil(detectionStartTime + std::chrono::milliseconds(qualityGovernor_->getDetectionIntervalMs()));
+            detectionStartTime = std::chrono::steady_clock::now();
+
             // Make sure a new image is actually in the buffer
             while (!imageBuffer_->getAndClearSwapCount() && !isAbortRequested())
             {
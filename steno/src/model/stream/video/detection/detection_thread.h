@@ -1,6 +1,7 @@
 #ifndef DETECTION_THREAD_H
 #define DETECTION_THREAD_H
 
+#include "model/stream/quality_governor.h"
 #include "model/stream/utils/alloc/i_object_factory.h"
 #include "model/stream/utils/images/images.h"
 #include "model/stream/utils/models/spherical_angle_rect.h"
@@ -22,7 +23,8 @@ class DetectionThread : public Thread, public Subject
    public:
     DetectionThread(std::shared_ptr<LockTripleBuffer<RGBImage>> imageBuffer, std::unique_ptr<IDetector> detector,
                     std::unique_ptr<IDetectionFisheyeDewarper> dewarper, std::unique_ptr<IObjectFactory> objectFactory,
-                    std::unique_ptr<ISynchronizer> synchronizer, std::shared_ptr<DewarpingConfig> dewarpingConfig);
+                    std::unique_ptr<ISynchronizer> synchronizer, std::shared_ptr<DewarpingConfig> dewarpingConfig,
+                    std::shared_ptr<QualityGovernor> qualityGovernor);
 
     bool getDetections(std::vector<SphericalAngleRect>& detections);
 
@@ -43,6 +45,7 @@ class DetectionThread : public Thread, public Subject
     std::unique_ptr<ISynchronizer> synchronizer_;
 
     std::shared_ptr<DewarpingConfig> dewarpingConfig_;
+    std::shared_ptr<QualityGovernor> qualityGovernor_;
 
     moodycamel::ReaderWriterQueue<std::vector<SphericalAngleRect>> detectionQueue_;
 };
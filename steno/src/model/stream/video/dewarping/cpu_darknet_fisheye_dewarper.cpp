@@ -7,6 +7,8 @@ namespace Model
 {
 namespace
 {
+const int ROWS_PER_TASK = 8;
+
 void dewarpImagePixelNormalized(const Image& src, const ImageFloat& dst, int srcIndex, int dstIndex)
 {
     int size = dst.width * dst.height;
@@ -62,8 +64,12 @@ int calculateOffset(const Dim2<int>& dim, float aspectRatio)
 
 }    // namespace
 
-CpuDarknetFisheyeDewarper::CpuDarknetFisheyeDewarper(float outputAspectRatio)
+CpuDarknetFisheyeDewarper::CpuDarknetFisheyeDewarper(float outputAspectRatio,
+                                                     std::shared_ptr<TaskScheduler> taskScheduler,
+                                                     TaskPriority priority)
     : outputAspectRatio_(outputAspectRatio)
+    , taskScheduler_(taskScheduler)
+    , priority_(priority)
 {
 }
 
@@ -73,13 +79,15 @@ void CpuDarknetFisheyeDewarper::dewarpImage(const Image& src, const ImageFloat&
     int size = dst.height * dst.width;
     int offset = calculateOffset(dst, outputAspectRatio_);
 
-    for (int index = 0; index < size; ++index)
-    {
-        Point<float> normalizedPixel = getNormalizedPixelFromIndex(index, dst);
-        Point<float> srcPosition = getSourcePixelFromDewarpedImageNormalizedPixel(normalizedPixel, params);
-        int srcIndex = getSourcePixelIndex(srcPosition, src) * 3;  // For now only can dewarp in RGB format
-        dewarpImagePixelNormalized(src, dst, srcIndex, index + offset);
-    }
+    parallelFor(taskScheduler_.get(), priority_, 0, size, ROWS_PER_TASK * dst.width, [&](int begin, int end) {
+        for (int index = begin; index < end; ++index)
+        {
+            Point<float> normalizedPixel = getNormalizedPixelFromIndex(index, dst);
+            Point<float> srcPosition = getSourcePixelFromDewarpedImageNormalizedPixel(normalizedPixel, params);
+            int srcIndex = getSourcePixelIndex(srcPosition, src) * 3;  // For now only can dewarp in RGB format
+            dewarpImagePixelNormalized(src, dst, srcIndex, index + offset);
+        }
+    });
 }
 
 void CpuDarknetFisheyeDewarper::dewarpImage(const Image& src, const ImageFloat& dst,
@@ -88,10 +96,12 @@ void CpuDarknetFisheyeDewarper::dewarpImage(const Image& src, const ImageFloat&
     int size = mapping.height * mapping.width;
     int offset = calculateOffset(dst, outputAspectRatio_);
 
-    for (int index = 0; index < size; ++index)
-    {
-        dewarpImagePixelNormalized(src, dst, mapping.hostData[index], index + offset);
-    }
+    parallelFor(taskScheduler_.get(), priority_, 0, size, ROWS_PER_TASK * mapping.width, [&](int begin, int end) {
+        for (int index = begin; index < end; ++index)
+        {
+            dewarpImagePixelNormalized(src, dst, mapping.hostData[index], index + offset);
+        }
+    });
 }
 
 void CpuDarknetFisheyeDewarper::dewarpImageFiltered(const Image& src, const ImageFloat& dst,
@@ -100,13 +110,15 @@ void CpuDarknetFisheyeDewarper::dewarpImageFiltered(const Image& src, const Imag
     int size = dst.height * dst.width;
     int offset = calculateOffset(dst, outputAspectRatio_);
 
-    for (int index = 0; index < size; ++index)
-    {
-        Point<float> normalizedPixel = getNormalizedPixelFromIndex(index, dst);
-        Point<float> srcPosition = getSourcePixelFromDewarpedImageNormalizedPixel(normalizedPixel, params);
-        LinearPixelFilter linearPixelFilter = getLinearPixelFilter(srcPosition, src);
-        dewarpImagePixelFilteredNormalized(src, dst, linearPixelFilter, index + offset);
-    }
+    parallelFor(taskScheduler_.get(), priority_, 0, size, ROWS_PER_TASK * dst.width, [&](int begin, int end) {
+        for (int index = begin; index < end; ++index)
+        {
+            Point<float> normalizedPixel = getNormalizedPixelFromIndex(index, dst);
+            Point<float> srcPosition = getSourcePixelFromDewarpedImageNormalizedPixel(normalizedPixel, params);
+            LinearPixelFilter linearPixelFilter = getLinearPixelFilter(srcPosition, src);
+            dewarpImagePixelFilteredNormalized(src, dst, linearPixelFilter, index + offset);
+        }
+    });
 }
 
 void CpuDarknetFisheyeDewarper::dewarpImageFiltered(const Image& src, const ImageFloat& dst,
@@ -115,10 +127,12 @@ void CpuDarknetFisheyeDewarper::dewarpImageFiltered(const Image& src, const Imag
     int size = mapping.height * mapping.width;
     int offset = calculateOffset(dst, outputAspectRatio_);
 
-    for (int index = 0; index < size; ++index)
-    {
-        dewarpImagePixelFilteredNormalized(src, dst, mapping.hostData[index], index + offset);
-    }
+    parallelFor(taskScheduler_.get(), priority_, 0, size, ROWS_PER_TASK * mapping.width, [&](int begin, int end) {
+        for (int index = begin; index < end; ++index)
+        {
+            dewarpImagePixelFilteredNormalized(src, dst, mapping.hostData[index], index + offset);
+        }
+    });
 }
 
 void CpuDarknetFisheyeDewarper::fillDewarpingMapping(const Dim2<int>& src, const DewarpingParameters& params,
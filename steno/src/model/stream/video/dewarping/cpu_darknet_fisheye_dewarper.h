@@ -1,6 +1,9 @@
 #ifndef CPU_DARKNET_FISHEYE_DEWARPER_H
 #define CPU_DARKNET_FISHEYE_DEWARPER_H
 
+#include <memory>
+
+#include "model/stream/utils/threads/task_scheduler.h"
 #include "model/stream/video/dewarping/cpu_dewarping_mapping_filler.h"
 #include "model/stream/video/dewarping/i_detection_fisheye_dewarper.h"
 
@@ -9,7 +12,8 @@ namespace Model
 class CpuDarknetFisheyeDewarper : public IDetectionFisheyeDewarper
 {
    public:
-    explicit CpuDarknetFisheyeDewarper(float outputAspectRatio);
+    explicit CpuDarknetFisheyeDewarper(float outputAspectRatio, std::shared_ptr<TaskScheduler> taskScheduler = nullptr,
+                                       TaskPriority priority = TaskPriority::LOW);
 
     void dewarpImage(const Image& src, const ImageFloat& dst, const DewarpingParameters& params) const override;
     void dewarpImage(const Image& src, const ImageFloat& dst, const DewarpingMapping& mapping) const override;
@@ -26,6 +30,8 @@ class CpuDarknetFisheyeDewarper : public IDetectionFisheyeDewarper
    private:
     CpuDewarpingMappingFiller mappingFiller_;
     float outputAspectRatio_;
+    std::shared_ptr<TaskScheduler> taskScheduler_;
+    TaskPriority priority_;
 };
 
 }    // namespace Model
@@ -6,6 +6,8 @@ namespace Model
 {
 namespace
 {
+const int ROWS_PER_TASK = 8;
+
 void dewarpImagePixel(const Image& src, const Image& dst, int srcIndex, int dstIndex)
 {
     if (srcIndex < int(src.size) &&
@@ -52,30 +54,40 @@ void dewarpImagePixelFiltered(const Image& src, const Image& dst, const LinearPi
 
 }    // namespace
 
+CpuFisheyeDewarper::CpuFisheyeDewarper(std::shared_ptr<TaskScheduler> taskScheduler, TaskPriority priority)
+    : taskScheduler_(taskScheduler)
+    , priority_(priority)
+{
+}
+
 void CpuFisheyeDewarper::dewarpImage(const Image& src, const Image& dst, const DewarpingParameters& params) const
 {
     int size = dst.height * dst.width;
 
-    for (int index = 0; index < size; ++index)
-    {
-        int dstIndex = index * 3;
+    parallelFor(taskScheduler_.get(), priority_, 0, size, ROWS_PER_TASK * dst.width, [&](int begin, int end) {
+        for (int index = begin; index < end; ++index)
+        {
+            int dstIndex = index * 3;
 
-        Point<float> normalizedPixel = getNormalizedPixelFromIndex(index, dst);
-        Point<float> srcPosition = getSourcePixelFromDewarpedImageNormalizedPixel(normalizedPixel, params);
-        int srcIndex = getSourcePixelIndex(srcPosition, src) * 3;  // For now only can dewarp in RGB format
-        dewarpImagePixel(src, dst, srcIndex, dstIndex);
-    }
+            Point<float> normalizedPixel = getNormalizedPixelFromIndex(index, dst);
+            Point<float> srcPosition = getSourcePixelFromDewarpedImageNormalizedPixel(normalizedPixel, params);
+            int srcIndex = getSourcePixelIndex(srcPosition, src) * 3;  // For now only can dewarp in RGB format
+            dewarpImagePixel(src, dst, srcIndex, dstIndex);
+        }
+    });
 }
 
 void CpuFisheyeDewarper::dewarpImage(const Image& src, const Image& dst, const DewarpingMapping& mapping) const
 {
     int size = mapping.height * mapping.width;
 
-    for (int index = 0; index < size; ++index)
-    {
-        int dstIndex = index * 3;
-        dewarpImagePixel(src, dst, mapping.hostData[index], dstIndex);
-    }
+    parallelFor(taskScheduler_.get(), priority_, 0, size, ROWS_PER_TASK * mapping.width, [&](int begin, int end) {
+        for (int index = begin; index < end; ++index)
+        {
+            int dstIndex = index * 3;
+            dewarpImagePixel(src, dst, mapping.hostData[index], dstIndex);
+        }
+    });
 }
 
 void CpuFisheyeDewarper::dewarpImageFiltered(const Image& src, const Image& dst,
@@ -83,15 +95,17 @@ void CpuFisheyeDewarper::dewarpImageFiltered(const Image& src, const Image& dst,
 {
     int size = dst.height * dst.width;
 
-    for (int index = 0; index < size; ++index)
-    {
-        int dstIndex = index * 3;
+    parallelFor(taskScheduler_.get(), priority_, 0, size, ROWS_PER_TASK * dst.width, [&](int begin, int end) {
+        for (int index = begin; index < end; ++index)
+        {
+            int dstIndex = index * 3;
 
-        Point<float> normalizedPixel = getNormalizedPixelFromIndex(index, dst);
-        Point<float> srcPosition = getSourcePixelFromDewarpedImageNormalizedPixel(normalizedPixel, params);
-        LinearPixelFilter linearPixelFilter = getLinearPixelFilter(srcPosition, Dim3<int>(src, 3));
-        dewarpImagePixelFiltered(src, dst, linearPixelFilter, dstIndex);
-    }
+            Point<float> normalizedPixel = getNormalizedPixelFromIndex(index, dst);
+            Point<float> srcPosition = getSourcePixelFromDewarpedImageNormalizedPixel(normalizedPixel, params);
+            LinearPixelFilter linearPixelFilter = getLinearPixelFilter(srcPosition, Dim3<int>(src, 3));
+            dewarpImagePixelFiltered(src, dst, linearPixelFilter, dstIndex);
+        }
+    });
 }
 
 void CpuFisheyeDewarper::dewarpImageFiltered(const Image& src, const Image& dst,
@@ -99,11 +113,13 @@ void CpuFisheyeDewarper::dewarpImageFiltered(const Image& src, const Image& dst,
 {
     int size = mapping.height * mapping.width;
 
-    for (int index = 0; index < size; ++index)
-    {
-        int dstIndex = index * 3;
-        dewarpImagePixelFiltered(src, dst, mapping.hostData[index], dstIndex);
-    }
+    parallelFor(taskScheduler_.get(), priority_, 0, size, ROWS_PER_TASK * mapping.width, [&](int begin, int end) {
+        for (int index = begin; index < end; ++index)
+        {
+            int dstIndex = index * 3;
+            dewarpImagePixelFiltered(src, dst, mapping.hostData[index], dstIndex);
+        }
+    });
 }
 
 void CpuFisheyeDewarper::fillDewarpingMapping(const Dim2<int>& src, const DewarpingParameters& params,
@@ -1,6 +1,9 @@
 #ifndef CPU_FISHEYE_DEWARPER_H
 #define CPU_FISHEYE_DEWARPER_H
 
+#include <memory>
+
+#include "model/stream/utils/threads/task_scheduler.h"
 #include "model/stream/video/dewarping/cpu_dewarping_mapping_filler.h"
 #include "model/stream/video/dewarping/i_fisheye_dewarper.h"
 
@@ -9,6 +12,9 @@ namespace Model
 class CpuFisheyeDewarper : public IFisheyeDewarper
 {
    public:
+    explicit CpuFisheyeDewarper(std::shared_ptr<TaskScheduler> taskScheduler = nullptr,
+                                TaskPriority priority = TaskPriority::HIGH);
+
     void dewarpImage(const Image& src, const Image& dst, const DewarpingParameters& params) const override;
     void dewarpImage(const Image& src, const Image& dst, const DewarpingMapping& mapping) const override;
     void dewarpImageFiltered(const Image& src, const Image& dst, const DewarpingParameters& params) const override;
@@ -21,6 +27,8 @@ class CpuFisheyeDewarper : public IFisheyeDewarper
 
    private:
     CpuDewarpingMappingFiller mappingFiller_;
+    std::shared_ptr<TaskScheduler> taskScheduler_;
+    TaskPriority priority_;
 };
 
 }    // namespace Model
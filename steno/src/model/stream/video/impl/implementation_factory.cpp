@@ -2,14 +2,16 @@
 
 #include <iostream>
 
+#include "model/stream/utils/alloc/accounting_object_factory.h"
+#include "model/stream/video/input/mjpeg_file_reader.h"
+
 #ifdef NO_CUDA
-#include "model/stream/utils/alloc/heap_object_factory.h"
+#include "model/stream/utils/alloc/pooled_object_factory.h"
 #include "model/stream/utils/images/image_converter.h"
 #include "model/stream/utils/threads/sync/nop_synchronizer.h"
 #include "model/stream/video/detection/darknet_detector.h"
 #include "model/stream/video/dewarping/cpu_darknet_fisheye_dewarper.h"
 #include "model/stream/video/dewarping/cpu_fisheye_dewarper.h"
-#include "model/stream/video/input/camera_reader.h"
 #include "model/stream/video/input/vc_camera_reader.h"
 #include "model/stream/video/input/image_file_reader.h"
 #else
@@ -39,6 +41,9 @@ namespace Model
 ImplementationFactory::ImplementationFactory(bool useZeroCopyIfSupported)
     : useZeroCopyIfSupported_(useZeroCopyIfSupported)
     , isZeroCopySupported_(false)
+    , taskScheduler_(std::make_shared<TaskScheduler>())
+    , blockPool_(std::make_shared<BlockPool>(true))
+    , memoryAccounting_(std::make_shared<MemoryAccounting>())
 {
     std::string message;
 #ifdef NO_CUDA
@@ -80,12 +85,15 @@ std::unique_ptr<IDetector> ImplementationFactory::getDetector(const std::string&
     return detector;
 }
 
-std::unique_ptr<IObjectFactory> ImplementationFactory::getObjectFactory()
+/**
+ * @param [IN] subsystem - label of the allocations made by the factory in the memory stats.
+ */
+std::unique_ptr<IObjectFactory> ImplementationFactory::getObjectFactory(const std::string& subsystem)
 {
     std::unique_ptr<IObjectFactory> objectFactory = nullptr;
 
 #ifdef NO_CUDA
-    objectFactory = std::make_unique<HeapObjectFactory>();
+    objectFactory = std::make_unique<PooledObjectFactory>(blockPool_);
 #else
     if (useZeroCopyIfSupported_ && isZeroCopySupported_)
     {
@@ -97,15 +105,18 @@ std::unique_ptr<IObjectFactory> ImplementationFactory::getObjectFactory()
     }
 #endif
 
-    return objectFactory;
+    return std::make_unique<AccountingObjectFactory>(std::move(objectFactory), memoryAccounting_, subsystem);
 }
 
-std::unique_ptr<IObjectFactory> ImplementationFactory::getDetectionObjectFactory()
+/**
+ * @param [IN] subsystem - label of the allocations made by the factory in the memory stats.
+ */
+std::unique_ptr<IObjectFactory> ImplementationFactory::getDetectionObjectFactory(const std::string& subsystem)
 {
     std::unique_ptr<IObjectFactory> objectFactory = nullptr;
 
 #ifdef NO_CUDA
-    objectFactory = std::make_unique<HeapObjectFactory>();
+    objectFactory = std::make_unique<PooledObjectFactory>(blockPool_);
 #else
     if (useZeroCopyIfSupported_ && isZeroCopySupported_)
     {
@@ -117,7 +128,7 @@ std::unique_ptr<IObjectFactory> ImplementationFactory::getDetectionObjectFactory
     }
 #endif
 
-    return objectFactory;
+    return std::make_unique<AccountingObjectFactory>(std::move(objectFactory), memoryAccounting_, subsystem);
 }
 
 std::unique_ptr<IFisheyeDewarper> ImplementationFactory::getFisheyeDewarper()
@@ -125,7 +136,7 @@ std::unique_ptr<IFisheyeDewarper> ImplementationFactory::getFisheyeDewarper()
     std::unique_ptr<IFisheyeDewarper> fisheyeDewarper = nullptr;
 
 #ifdef NO_CUDA
-    fisheyeDewarper = std::make_unique<CpuFisheyeDewarper>();
+    fisheyeDewarper = std::make_unique<CpuFisheyeDewarper>(taskScheduler_, TaskPriority::HIGH);
 #else
     fisheyeDewarper = std::make_unique<CudaFisheyeDewarper>(stream);
 #endif
@@ -138,7 +149,7 @@ std::unique_ptr<IDetectionFisheyeDewarper> ImplementationFactory::getDetectionFi
     std::unique_ptr<IDetectionFisheyeDewarper> normalizedFisheyeDewarper = nullptr;
 
 #ifdef NO_CUDA
-    normalizedFisheyeDewarper = std::make_unique<CpuDarknetFisheyeDewarper>(aspectRatio);
+    normalizedFisheyeDewarper = std::make_unique<CpuDarknetFisheyeDewarper>(aspectRatio, taskScheduler_, TaskPriority::LOW);
 #else
     normalizedFisheyeDewarper = std::make_unique<CudaDarknetFisheyeDewarper>(detectionStream, aspectRatio);
 #endif
@@ -177,7 +188,7 @@ std::unique_ptr<IImageConverter> ImplementationFactory::getImageConverter()
     std::unique_ptr<IImageConverter> imageConverter = nullptr;
 
 #ifdef NO_CUDA
-    imageConverter = std::make_unique<ImageConverter>();
+    imageConverter = std::make_unique<ImageConverter>(taskScheduler_, TaskPriority::HIGH);
 #else
     imageConverter = std::make_unique<CudaImageConverter>(stream);
 #endif
@@ -199,19 +210,46 @@ std::unique_ptr<IVideoInput> ImplementationFactory::getImageFileReader(const std
     return fileImageReader;
 }
 
-std::unique_ptr<IVideoInput> ImplementationFactory::getCameraReader(std::shared_ptr<VideoConfig> videoConfig)
+/**
+ * @param [IN] captureMemory - memory the camera captures in, the reader falls back on the driver buffers.
+ * @param [IN] decodeRegion - part of the MJPEG captures that is decoded.
+ * @param [IN] subsystem - label of the capture buffers allocated by the pipeline in the memory stats.
+ */
+std::unique_ptr<IVideoInput> ImplementationFactory::getCameraReader(std::shared_ptr<VideoConfig> videoConfig,
+                                                                    CaptureMemory captureMemory,
+                                                                    const Rectangle& decodeRegion,
+                                                                    const std::string& subsystem)
 {
     std::unique_ptr<IVideoInput> cameraReader = nullptr;
 
 #ifdef NO_CUDA
-    cameraReader = std::make_unique<CameraReader>(videoConfig, 2);
+    // Captures are pooled on huge pages like the other frames
+    std::shared_ptr<IObjectFactory> captureObjectFactory = getObjectFactory(subsystem);
+    cameraReader = std::make_unique<CameraReader>(videoConfig, 2, captureMemory, captureObjectFactory, taskScheduler_,
+                                                  decodeRegion);
 #else
-    cameraReader = std::make_unique<CudaCameraReader>(videoConfig);
+    // Captures are page-locked so they are copied to the device directly
+    std::shared_ptr<IObjectFactory> captureObjectFactory = std::make_shared<AccountingObjectFactory>(
+        std::make_unique<ZeroCopyCudaObjectFactory>(), memoryAccounting_, subsystem);
+    cameraReader = std::make_unique<CudaCameraReader>(videoConfig, captureMemory, captureObjectFactory,
+                                                      taskScheduler_, decodeRegion);
 #endif
 
     return cameraReader;
 }
 
+/**
+ * @brief Stand-in of a MJPEG camera playing a recording, the frames are allocated like the other frames.
+ * @param [IN] subsystem - label of the decoded frames in the memory stats.
+ */
+std::unique_ptr<IVideoInput> ImplementationFactory::getMjpegFileReader(const std::string& mjpegFilePath,
+                                                                       std::shared_ptr<VideoConfig> videoConfig,
+                                                                       const std::string& subsystem)
+{
+    std::shared_ptr<IObjectFactory> objectFactory = getObjectFactory(subsystem);
+    return std::make_unique<MjpegFileReader>(mjpegFilePath, videoConfig, objectFactory, taskScheduler_);
+}
+
 std::unique_ptr<IVideoInput> ImplementationFactory::getVcCameraReader(std::shared_ptr<VideoConfig> videoConfig)
 {
     std::unique_ptr<IVideoInput> cameraReader = nullptr;
@@ -224,4 +262,26 @@ std::unique_ptr<IVideoInput> ImplementationFactory::getVcCameraReader(std::share
 
     return cameraReader;
 }
+
+/**
+ * @brief Task pool shared by every CPU stage, media work is queued with a higher priority than detection work.
+ */
+std::shared_ptr<TaskScheduler> ImplementationFactory::getTaskScheduler()
+{
+    return taskScheduler_;
+}
+
+/**
+ * @brief Pool of the host buffers allocated by the object factories of CPU builds, shared so its statistics cover
+ * every stage.
+ */
+std::shared_ptr<BlockPool> ImplementationFactory::getBlockPool()
+{
+    return blockPool_;
+}
+
+std::shared_ptr<MemoryAccounting> ImplementationFactory::getMemoryAccounting()
+{
+    return memoryAccounting_;
+}
 }    // namespace Model
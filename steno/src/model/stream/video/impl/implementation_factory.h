@@ -3,12 +3,17 @@
 
 #include <memory>
 
+#include "model/stream/utils/alloc/block_pool.h"
 #include "model/stream/utils/alloc/i_object_factory.h"
+#include "model/stream/utils/alloc/memory_accounting.h"
 #include "model/stream/utils/images/i_image_converter.h"
+#include "model/stream/utils/models/rectangle.h"
 #include "model/stream/utils/threads/sync/i_synchronizer.h"
+#include "model/stream/utils/threads/task_scheduler.h"
 #include "model/stream/video/detection/i_detector.h"
 #include "model/stream/video/dewarping/i_detection_fisheye_dewarper.h"
 #include "model/stream/video/dewarping/i_fisheye_dewarper.h"
+#include "model/stream/video/input/camera_reader.h"
 #include "model/stream/video/input/i_video_input.h"
 #include "model/stream/video/video_config.h"
 
@@ -22,20 +27,31 @@ class ImplementationFactory
 
     std::unique_ptr<IDetector> getDetector(const std::string& configFile, const std::string& weightsFile,
                                            const std::string& metaFile, int sleepBetweenLayersForwardUs);
-    std::unique_ptr<IObjectFactory> getObjectFactory();
-    std::unique_ptr<IObjectFactory> getDetectionObjectFactory();
+    std::unique_ptr<IObjectFactory> getObjectFactory(const std::string& subsystem);
+    std::unique_ptr<IObjectFactory> getDetectionObjectFactory(const std::string& subsystem);
     std::unique_ptr<IFisheyeDewarper> getFisheyeDewarper();
     std::unique_ptr<IDetectionFisheyeDewarper> getDetectionFisheyeDewarper(float aspectRatio);
     std::unique_ptr<ISynchronizer> getSynchronizer();
     std::unique_ptr<ISynchronizer> getDetectionSynchronizer();
     std::unique_ptr<IImageConverter> getImageConverter();
     std::unique_ptr<IVideoInput> getImageFileReader(const std::string& imageFilePath, ImageFormat format);
-    std::unique_ptr<IVideoInput> getCameraReader(std::shared_ptr<VideoConfig> cameraConfig);
+    std::unique_ptr<IVideoInput> getCameraReader(std::shared_ptr<VideoConfig> cameraConfig,
+                                                 CaptureMemory captureMemory, const Rectangle& decodeRegion,
+                                                 const std::string& subsystem);
+    std::unique_ptr<IVideoInput> getMjpegFileReader(const std::string& mjpegFilePath,
+                                                    std::shared_ptr<VideoConfig> videoConfig,
+                                                    const std::string& subsystem);
     std::unique_ptr<IVideoInput> getVcCameraReader(std::shared_ptr<VideoConfig> videoConfig);
+    std::shared_ptr<TaskScheduler> getTaskScheduler();
+    std::shared_ptr<BlockPool> getBlockPool();
+    std::shared_ptr<MemoryAccounting> getMemoryAccounting();
 
    private:
     bool useZeroCopyIfSupported_;
     bool isZeroCopySupported_;
+    std::shared_ptr<TaskScheduler> taskScheduler_;
+    std::shared_ptr<BlockPool> blockPool_;
+    std::shared_ptr<MemoryAccounting> memoryAccounting_;
 };
 
 }    // namespace Model
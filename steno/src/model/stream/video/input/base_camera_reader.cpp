@@ -93,7 +93,10 @@ void BaseCameraReader::setImageFormat()
     fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
     fmt.fmt.pix.width = videoConfig_->resolution.width;
     fmt.fmt.pix.height = videoConfig_->resolution.height;
-    fmt.fmt.pix.pixelformat = getV4L2Format(videoConfig_->imageFormat);
+    // MJPEG frames are decoded to the image format by the reader
+    unsigned int pixelFormat =
+        videoConfig_->isMjpegCapture ? V4L2_PIX_FMT_MJPEG : getV4L2Format(videoConfig_->imageFormat);
+    fmt.fmt.pix.pixelformat = pixelFormat;
     fmt.fmt.pix.field = V4L2_FIELD_NONE;
 
     if (xioctl(VIDIOC_S_FMT, &fmt) == ERROR_CODE)
@@ -101,10 +104,11 @@ void BaseCameraReader::setImageFormat()
         throw std::runtime_error("Unable to set camera image format");
     }
 
-    if (fmt.fmt.pix.pixelformat != getV4L2Format(videoConfig_->imageFormat))
+    if (fmt.fmt.pix.pixelformat != pixelFormat)
     {
         throw std::runtime_error("Camera does not support specified image format : " +
-                                 getImageFormatString(videoConfig_->imageFormat));
+                                 (videoConfig_->isMjpegCapture ? std::string("MJPEG")
+                                                               : getImageFormatString(videoConfig_->imageFormat)));
     }
     else if (fmt.fmt.pix.width != (unsigned int)videoConfig_->resolution.width ||
              fmt.fmt.pix.height != (unsigned int)videoConfig_->resolution.height)
@@ -1,162 +1,676 @@
 #include "camera_reader.h"
 
 #include <fcntl.h>
+#include <linux/dma-buf.h>
+#include <linux/dma-heap.h>
+#include <poll.h>
 #include <sys/ioctl.h>
 #include <sys/mman.h>
 #include <unistd.h>
+#include <algorithm>
+#include <cerrno>
 #include <iostream>
 
-#include "model/stream/utils/time/time_utils.h"
+#include "model/stream/utils/time/media_clock.h"
 
 namespace Model
 {
 namespace
 {
 const int ERROR_CODE = -1;
-}
 
-CameraReader::IndexedImage::IndexedImage(const Image& image)
-    : index(0)
-    , image(image)
+// A camera streaming at any supported frame rate sends a frame well within this time
+const int CAPTURE_TIMEOUT_MS = 2000;
+
+const char* const DMA_HEAP_PATH = "/dev/dma_heap/system";
+
+uint32_t getV4l2Memory(CaptureMemory captureMemory)
 {
+    switch (captureMemory)
+    {
+        case CaptureMemory::USERPTR:
+            return V4L2_MEMORY_USERPTR;
+        case CaptureMemory::DMABUF:
+            return V4L2_MEMORY_DMABUF;
+        default:
+            return V4L2_MEMORY_MMAP;
+    }
 }
-
-CameraReader::CameraReader(std::shared_ptr<VideoConfig> videoConfig, std::size_t bufferCount)
+}    // namespace
+
+/**
+ * @param [IN] captureMemory - memory the driver captures in, MMAP is used instead if the driver or the system does
+ * not support it.
+ * @param [IN] captureObjectFactory - allocates the USERPTR buffers and the decoded MJPEG frames, can be null for
+ * uncompressed captures in the other modes.
+ * @param [IN] taskScheduler - decodes the MJPEG captures, can be null to decode them on the reading thread.
+ * @param [IN] decodeRegion - part of the MJPEG captures that is decoded, the consumers never read the rest.
+ */
+CameraReader::CameraReader(std::shared_ptr<VideoConfig> videoConfig, std::size_t bufferCount,
+                           CaptureMemory captureMemory, std::shared_ptr<IObjectFactory> captureObjectFactory,
+                           std::shared_ptr<TaskScheduler> taskScheduler, const Rectangle& decodeRegion)
     : BaseCameraReader(videoConfig)
-    , images_(bufferCount,
-              Image(videoConfig->resolution.width, videoConfig->resolution.height, videoConfig->imageFormat))
+    , hasSequence_(false)
+    , lastSequence_(0)
+    , droppedFrameCount_(0)
+    , skippedFrameCount_(0)
+    , corruptFrameCount_(0)
+    , requestedCaptureMemory_(captureMemory)
+    , captureMemory_(captureMemory)
+    , captureObjectFactory_(captureObjectFactory)
+    , captureSize_(0)
+    , captureBytesUsed_(bufferCount, 0)
+    , mappedLengths_(bufferCount, 0)
+    , dmaBufferSize_(0)
+    , captureRecycler_(std::make_shared<CaptureRecycler>(bufferCount))
+    , queuedCaptureCount_(0)
+    , heldCaptures_(bufferCount, false)
+    , staleCaptures_(bufferCount, false)
 {
-    buffer_.memory = V4L2_MEMORY_MMAP;
+    if ((captureMemory == CaptureMemory::USERPTR || videoConfig->isMjpegCapture) && !captureObjectFactory_)
+    {
+        throw std::invalid_argument("Error in CameraReader - Null is not a valid argument");
+    }
+
+    buffer_.memory = getV4l2Memory(captureMemory);
+
+    // The buffers live as long as the reader, released frames can still reference them after close
+    Image image(videoConfig->resolution.width, videoConfig->resolution.height, videoConfig->imageFormat);
+    for (std::size_t i = 0; i < bufferCount; ++i)
+    {
+        captureBuffers_.push_back(std::make_unique<FrameBuffer>(image));
+    }
+
+    releasedBuffers_.reserve(bufferCount);
+
+    if (videoConfig->isMjpegCapture)
+    {
+        mjpegDecoder_ = std::make_unique<MjpegDecoder>(taskScheduler, TaskPriority::HIGH);
+        mjpegDecoder_->setDecodeRegion(decodeRegion);
+
+        // A decoded frame is free while the consumers hold as many frames as there are captures
+        decodedFramePool_ = std::make_shared<FramePool>(captureObjectFactory_, image, bufferCount + 1);
+    }
 }
 
-void CameraReader::open()
+CameraReader::~CameraReader()
 {
-    BaseCameraReader::open();
+    // MMAP buffers still held at close are mapped until now
+    for (std::size_t i = 0; i < captureBuffers_.size(); ++i)
+    {
+        unmapBuffer(i);
+    }
 
-    // Queue a first capture for fast read
-    queueCapture(images_.current());
+    deallocateUserBuffers();
+    deallocateDmaBuffers();
 }
 
-bool CameraReader::readImage(Image& image)
+/**
+ * @brief Get the newest capture, blocking until the camera sends one. The previous frame of the caller is released
+ * first so its buffer can be captured to again.
+ */
+bool CameraReader::readImage(FrameRef& frame)
 {
-    CameraReader::IndexedImage& currentIndexedImage = images_.current();
+    frame.reset();
+    takeReleasedCaptures(true);
 
-    // Change the current() indexed image
-    images_.next();
+    if (queuedCaptureCount_ == 0)
+    {
+        throw std::runtime_error("Every capture buffer of camera " + videoConfig_->deviceName +
+                                 " is held by its consumers");
+    }
 
-    // Recover the last frame in queue
-    dequeueCapture(currentIndexedImage);
+    std::size_t index = dequeueCapture();
 
-    // Queue the next frame
-    queueCapture(images_.current());
+    // Captures that piled up while the reader was busy are outdated, only the newest is read
+    while (queuedCaptureCount_ > 0 && pollCapture(0))
+    {
+        std::size_t newerIndex = dequeueCapture();
+        syncDmaBuffer(index, DMA_BUF_SYNC_END);
+        queueCapture(index);
+        index = newerIndex;
+        ++skippedFrameCount_;
+    }
 
-    image = currentIndexedImage.image;
+    if (mjpegDecoder_)
+    {
+        // Damaged frames are dropped for the next capture
+        while (!decodeCapture(index, frame))
+        {
+            ++corruptFrameCount_;
+            index = dequeueCapture();
+        }
+    }
+    else
+    {
+        frame = FrameRef(captureBuffers_[index].get(), captureRecycler_);
+        heldCaptures_[index] = true;
+    }
 
     return true;
 }
 
+/**
+ * @return memory the driver captures in since the camera was opened.
+ */
+CaptureMemory CameraReader::getCaptureMemory() const
+{
+    return captureMemory_;
+}
+
 void CameraReader::initializeInternal()
 {
-    requestBuffers(images_.size());
+    hasSequence_ = false;
+    droppedFrameCount_ = 0;
+    skippedFrameCount_ = 0;
+    corruptFrameCount_ = 0;
+    captureSize_ = getCaptureSize();
+
+    // Buffers released while the camera was closed can be prepared and queued like the others
+    takeReleasedCaptures(false);
+
+    // The pipeline buffers are given to the driver when it supports importing them, else it captures in its own
+    captureMemory_ = requestedCaptureMemory_;
+    if (captureMemory_ != CaptureMemory::MMAP && !requestBuffers(captureMemory_))
+    {
+        std::cout << "Camera " << videoConfig_->deviceName << " can't capture in "
+                  << (captureMemory_ == CaptureMemory::USERPTR ? "user" : "dma") << " buffers, using mmap buffers"
+                  << std::endl;
+        captureMemory_ = CaptureMemory::MMAP;
+    }
+
+    if (captureMemory_ == CaptureMemory::MMAP && !requestBuffers(captureMemory_))
+    {
+        throw std::runtime_error("Failed to request buffers for camera " + videoConfig_->deviceName);
+    }
+
+    buffer_.memory = getV4l2Memory(captureMemory_);
+
+    // Every free buffer is given to the driver, the camera is never starved while the reader is busy. The held ones
+    // are queued when their frame is released
+    queuedCaptureCount_ = 0;
+    for (std::size_t i = 0; i < captureBuffers_.size(); ++i)
+    {
+        if (!heldCaptures_[i])
+        {
+            queueCapture(i);
+        }
+    }
 }
 
 void CameraReader::finalizeInternal()
 {
-    for (std::size_t i = 0; i < images_.size(); ++i)
+    std::cout << "Camera dropped " << droppedFrameCount_ << " frames, " << skippedFrameCount_
+              << " captures replaced before being read" << std::endl;
+
+    if (mjpegDecoder_)
+    {
+        std::cout << "Camera sent " << corruptFrameCount_ << " MJPEG frames that could not be decoded" << std::endl;
+    }
+
+    takeReleasedCaptures(false);
+
+    // Frames held by the consumers stay valid after close: pipeline buffers are kept, and the MMAP buffers of held
+    // frames stay mapped, the mapping keeps the driver memory alive until the buffer is prepared again
+    if (captureMemory_ == CaptureMemory::MMAP)
+    {
+        for (std::size_t i = 0; i < captureBuffers_.size(); ++i)
+        {
+            if (!heldCaptures_[i])
+            {
+                unmapBuffer(i);
+            }
+        }
+    }
+
+    queuedCaptureCount_ = 0;
+}
+
+/**
+ * @brief Decode a MJPEG capture in a frame of the image format, the capture buffer is queued again right away.
+ * @return false if the capture is not a valid JPEG, a frame damaged on the bus.
+ */
+bool CameraReader::decodeCapture(std::size_t index, FrameRef& frame)
+{
+    if (!decodedFramePool_->tryAcquire(frame))
+    {
+        throw std::runtime_error("Every decoded frame of camera " + videoConfig_->deviceName +
+                                 " is held by its consumers");
+    }
+
+    const Image& capture = captureBuffers_[index]->image;
+    bool isDecoded = true;
+
+    try
+    {
+        mjpegDecoder_->decode(capture.hostData, captureBytesUsed_[index], *frame);
+        frame->timeStamp = capture.timeStamp;
+    }
+    catch (const std::runtime_error&)
     {
-        unmapBuffer(images_.current());
-        images_.next();
+        frame.reset();
+        isDecoded = false;
     }
+
+    syncDmaBuffer(index, DMA_BUF_SYNC_END);
+    queueCapture(index);
+
+    return isDecoded;
 }
 
-void CameraReader::queueCapture(IndexedImage& indexedImage)
+/**
+ * @brief Take back the buffers whose frames were released by the consumers.
+ * @param [IN] isCameraOpen - the buffers are queued for capture, else they are queued when the camera opens.
+ */
+void CameraReader::takeReleasedCaptures(bool isCameraOpen)
+{
+    captureRecycler_->takeReleasedBuffers(releasedBuffers_);
+
+    for (FrameBuffer* buffer : releasedBuffers_)
+    {
+        for (std::size_t i = 0; i < captureBuffers_.size(); ++i)
+        {
+            if (captureBuffers_[i].get() == buffer)
+            {
+                heldCaptures_[i] = false;
+
+                if (isCameraOpen)
+                {
+                    // A buffer held across a close still has the memory of the previous open
+                    if (staleCaptures_[i])
+                    {
+                        prepareCapture(i);
+                        staleCaptures_[i] = false;
+                    }
+
+                    syncDmaBuffer(i, DMA_BUF_SYNC_END);
+                    queueCapture(i);
+                }
+                break;
+            }
+        }
+    }
+
+    releasedBuffers_.clear();
+}
+
+void CameraReader::queueCapture(std::size_t index)
 {
     v4l2_buffer buffer = buffer_;
-    buffer.index = indexedImage.index;
+    buffer.index = index;
+
+    if (captureMemory_ == CaptureMemory::USERPTR)
+    {
+        buffer.m.userptr = reinterpret_cast<unsigned long>(captureBuffers_[index]->image.hostData);
+        buffer.length = captureSize_;
+    }
+    else if (captureMemory_ == CaptureMemory::DMABUF)
+    {
+        buffer.m.fd = dmaBuffers_[index].fd;
+        buffer.length = captureSize_;
+    }
 
     if (xioctl(VIDIOC_QBUF, &buffer) == ERROR_CODE)
     {
         throw std::runtime_error("Failed to querry camera buffer");
     }
+
+    ++queuedCaptureCount_;
 }
 
-void CameraReader::dequeueCapture(IndexedImage& indexedImage)
+/**
+ * @brief Block until the driver filled a queued buffer, the video loop follows the camera frame rate.
+ * @return index of the buffer, the driver fills its buffers in the order they were queued.
+ */
+std::size_t CameraReader::dequeueCapture()
 {
-    fd_set fds;
-    FD_ZERO(&fds);
-    FD_SET(fd_, &fds);
+    if (!pollCapture(CAPTURE_TIMEOUT_MS))
+    {
+        throw std::runtime_error("Timeout waiting for camera frame from " + videoConfig_->deviceName);
+    }
+
+    v4l2_buffer buffer = buffer_;
+
+    if (xioctl(VIDIOC_DQBUF, &buffer) == ERROR_CODE || buffer.index >= captureBuffers_.size())
+    {
+        throw std::runtime_error("Failed to retrieve camera frame");
+    }
+
+    --queuedCaptureCount_;
+
+    captureBuffers_[buffer.index]->image.timeStamp = getCaptureTimestamp(buffer);
+    captureBytesUsed_[buffer.index] = buffer.bytesused;
+    updateSequence(buffer.sequence);
+    syncDmaBuffer(buffer.index, DMA_BUF_SYNC_START);
 
-    timeval tv = {};
-    tv.tv_sec = 2;
+    return buffer.index;
+}
 
-    int result = select(fd_ + 1, &fds, NULL, NULL, &tv);
+/**
+ * @return true if a capture is ready to be dequeued.
+ */
+bool CameraReader::pollCapture(int timeoutMs)
+{
+    pollfd pollFd = {};
+    pollFd.fd = fd_;
+    pollFd.events = POLLIN;
 
-    if (result == ERROR_CODE)
+    int result;
+    do
+    {
+        result = poll(&pollFd, 1, timeoutMs);
+    } while (result == ERROR_CODE && errno == EINTR);
+
+    if (result == ERROR_CODE || (pollFd.revents & (POLLERR | POLLNVAL)))
     {
         throw std::runtime_error("Error waiting for camera frame");
     }
 
-    v4l2_buffer buffer = buffer_;
-    buffer.index = indexedImage.index;
+    return result > 0;
+}
 
-    if (xioctl(VIDIOC_DQBUF, &buffer) == ERROR_CODE)
+/**
+ * @brief Time the driver captured the frame on the media timeline, without the scheduling delay of the reader.
+ */
+uint64_t CameraReader::getCaptureTimestamp(const v4l2_buffer& buffer) const
+{
+    if ((buffer.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) != V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC)
     {
-        throw std::runtime_error("Failed to retrieve camera frame");
+        // The driver timestamp is not on a known clock
+        return MediaClock::now();
     }
 
-    // Set capture time + timestamp correction offset
-    indexedImage.image.timeStamp = systemTimeSinceEpoch() + 40000; // TODO: config
+    uint64_t monotonicTimeUs =
+        static_cast<uint64_t>(buffer.timestamp.tv_sec) * 1000000 + static_cast<uint64_t>(buffer.timestamp.tv_usec);
+    return MediaClock::fromMonotonicTime(monotonicTimeUs);
 }
 
-void CameraReader::requestBuffers(std::size_t bufferCount)
+void CameraReader::updateSequence(uint32_t sequence)
 {
+    if (hasSequence_ && sequence - lastSequence_ > 1)
+    {
+        droppedFrameCount_ += sequence - lastSequence_ - 1;
+    }
+
+    hasSequence_ = true;
+    lastSequence_ = sequence;
+}
+
+/**
+ * @return false if the driver can't capture in this memory or the pipeline buffers can't be allocated.
+ */
+bool CameraReader::requestBuffers(CaptureMemory captureMemory)
+{
+    if (captureMemory == CaptureMemory::DMABUF && !allocateDmaBuffers())
+    {
+        return false;
+    }
+
     v4l2_requestbuffers req = {};
-    req.count = bufferCount;
+    req.count = captureBuffers_.size();
     req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-    req.memory = V4L2_MEMORY_MMAP;
+    req.memory = getV4l2Memory(captureMemory);
 
-    if (xioctl(VIDIOC_REQBUFS, &req) == ERROR_CODE || req.count != bufferCount)
+    if (xioctl(VIDIOC_REQBUFS, &req) == ERROR_CODE || req.count != captureBuffers_.size())
     {
-        throw std::runtime_error("Failed to request buffers for camera " + videoConfig_->deviceName);
+        // Held frames can still read the dma buffers
+        if (!isAnyCaptureHeld())
+        {
+            deallocateDmaBuffers();
+        }
+        return false;
     }
 
-    for (std::size_t i = 0; i < images_.size(); ++i)
+    if (captureMemory == CaptureMemory::USERPTR)
     {
-        IndexedImage& indexedImage = images_.current();
-        indexedImage.index = i;
-        mapBuffer(indexedImage);
-        images_.next();
+        allocateUserBuffers();
     }
+
+    // The frames still held keep reading the memory of the previous open, their buffer is prepared once released
+    captureMemory_ = captureMemory;
+    for (std::size_t i = 0; i < captureBuffers_.size(); ++i)
+    {
+        if (heldCaptures_[i])
+        {
+            staleCaptures_[i] = true;
+        }
+        else
+        {
+            prepareCapture(i);
+            staleCaptures_[i] = false;
+        }
+    }
+
+    return true;
 }
 
-void CameraReader::mapBuffer(IndexedImage& indexedImage)
+/**
+ * @brief Point a capture buffer at the memory the driver captures in since the camera was opened. Only the host data
+ * is set, the device data of the capture buffers belongs to the derived readers.
+ */
+void CameraReader::prepareCapture(std::size_t index)
+{
+    // MMAP buffer of a previous open
+    unmapBuffer(index);
+
+    switch (captureMemory_)
+    {
+        case CaptureMemory::USERPTR:
+            captureBuffers_[index]->image.hostData = userBuffers_[index].hostData;
+            break;
+        case CaptureMemory::DMABUF:
+            captureBuffers_[index]->image.hostData = dmaBuffers_[index].data;
+            break;
+        default:
+            mapBuffer(index);
+            break;
+    }
+}
+
+bool CameraReader::isAnyCaptureHeld() const
+{
+    return std::find(heldCaptures_.begin(), heldCaptures_.end(), true) != heldCaptures_.end();
+}
+
+/**
+ * @brief Bytes the driver writes for a capture, at least the size of the image.
+ */
+std::size_t CameraReader::getCaptureSize()
+{
+    v4l2_format fmt = {};
+    fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+
+    if (xioctl(VIDIOC_G_FMT, &fmt) == ERROR_CODE)
+    {
+        throw std::runtime_error("Failed to get the format of camera " + videoConfig_->deviceName);
+    }
+
+    return std::max<std::size_t>(fmt.fmt.pix.sizeimage, captureBuffers_.front()->image.size);
+}
+
+void CameraReader::mapBuffer(std::size_t index)
 {
     v4l2_buffer buffer = {};
     buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
     buffer.memory = V4L2_MEMORY_MMAP;
-    buffer.index = indexedImage.index;
+    buffer.index = index;
 
     if (xioctl(VIDIOC_QUERYBUF, &buffer) == ERROR_CODE)
     {
         throw std::runtime_error("Failed to query buffers of camera " + videoConfig_->deviceName);
     }
 
-    indexedImage.image.hostData =
-        (uint8_t*)mmap(NULL, buffer.length, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, buffer.m.offset);
+    void* data = mmap(NULL, buffer.length, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, buffer.m.offset);
 
-    if (indexedImage.image.hostData == nullptr)
+    if (data == MAP_FAILED)
     {
         throw std::runtime_error("Camera allocated buffer is null");
     }
+
+    captureBuffers_[index]->image.hostData = static_cast<uint8_t*>(data);
+    mappedLengths_[index] = buffer.length;
+}
+
+void CameraReader::unmapBuffer(std::size_t index)
+{
+    Image& image = captureBuffers_[index]->image;
+
+    if (mappedLengths_[index] != 0)
+    {
+        munmap(image.hostData, mappedLengths_[index]);
+        image.hostData = nullptr;
+        mappedLengths_[index] = 0;
+    }
+}
+
+/**
+ * @brief Allocate the USERPTR buffers from the pipeline on the first open, the driver captures in them directly.
+ */
+void CameraReader::allocateUserBuffers()
+{
+    if (!userBuffers_.empty() && userBuffers_.front().size < captureSize_)
+    {
+        if (isAnyCaptureHeld())
+        {
+            throw std::runtime_error("Capture size of camera " + videoConfig_->deviceName +
+                                     " changed while its frames are held");
+        }
+        deallocateUserBuffers();
+    }
+
+    if (userBuffers_.empty())
+    {
+        for (std::size_t i = 0; i < captureBuffers_.size(); ++i)
+        {
+            Image userBuffer = captureBuffers_[i]->image;
+            userBuffer.size = captureSize_;
+            userBuffer.hostData = nullptr;
+            userBuffer.deviceData = nullptr;
+            captureObjectFactory_->allocateObject(userBuffer);
+            userBuffers_.push_back(userBuffer);
+        }
+    }
+}
+
+void CameraReader::deallocateUserBuffers()
+{
+    for (Image& userBuffer : userBuffers_)
+    {
+        captureObjectFactory_->deallocateObject(userBuffer);
+    }
+
+    userBuffers_.clear();
 }
 
-void CameraReader::unmapBuffer(IndexedImage& indexedImage)
+/**
+ * @brief Allocate the DMABUF buffers from the system dma heap on the first open, mapped for the CPU stages.
+ * @return false if the system has no dma heap or it is out of memory.
+ */
+bool CameraReader::allocateDmaBuffers()
 {
-    if (indexedImage.image.hostData != nullptr)
+    if (!dmaBuffers_.empty() && dmaBufferSize_ < captureSize_)
+    {
+        if (isAnyCaptureHeld())
+        {
+            throw std::runtime_error("Capture size of camera " + videoConfig_->deviceName +
+                                     " changed while its frames are held");
+        }
+        deallocateDmaBuffers();
+    }
+
+    if (!dmaBuffers_.empty())
     {
-        munmap(indexedImage.image.hostData, indexedImage.image.size);
-        indexedImage.image.hostData = nullptr;
+        return true;
     }
+
+    int heapFd = ::open(DMA_HEAP_PATH, O_RDWR | O_CLOEXEC);
+    if (heapFd == ERROR_CODE)
+    {
+        return false;
+    }
+
+    dmaBufferSize_ = captureSize_;
+    for (std::size_t i = 0; i < captureBuffers_.size(); ++i)
+    {
+        dma_heap_allocation_data allocation = {};
+        allocation.len = dmaBufferSize_;
+        allocation.fd_flags = O_RDWR | O_CLOEXEC;
+
+        if (ioctl(heapFd, DMA_HEAP_IOCTL_ALLOC, &allocation) == ERROR_CODE)
+        {
+            break;
+        }
+
+        void* data = mmap(NULL, dmaBufferSize_, PROT_READ | PROT_WRITE, MAP_SHARED, allocation.fd, 0);
+        if (data == MAP_FAILED)
+        {
+            ::close(allocation.fd);
+            break;
+        }
+
+        DmaBuffer dmaBuffer;
+        dmaBuffer.fd = allocation.fd;
+        dmaBuffer.data = static_cast<uint8_t*>(data);
+        dmaBuffers_.push_back(dmaBuffer);
+    }
+
+    ::close(heapFd);
+
+    if (dmaBuffers_.size() != captureBuffers_.size())
+    {
+        deallocateDmaBuffers();
+        return false;
+    }
+
+    return true;
+}
+
+void CameraReader::deallocateDmaBuffers()
+{
+    for (const DmaBuffer& dmaBuffer : dmaBuffers_)
+    {
+        munmap(dmaBuffer.data, dmaBufferSize_);
+        ::close(dmaBuffer.fd);
+    }
+
+    dmaBuffers_.clear();
+}
+
+/**
+ * @brief Bracket the CPU reads of a DMABUF capture, the caches are synced with what the device wrote.
+ */
+void CameraReader::syncDmaBuffer(std::size_t index, uint64_t flags)
+{
+    if (captureMemory_ != CaptureMemory::DMABUF)
+    {
+        return;
+    }
+
+    dma_buf_sync sync = {};
+    sync.flags = flags | DMA_BUF_SYNC_READ;
+
+    int result;
+    do
+    {
+        result = ioctl(dmaBuffers_[index].fd, DMA_BUF_IOCTL_SYNC, &sync);
+    } while (result == ERROR_CODE && (errno == EINTR || errno == EAGAIN));
+}
+
+CameraReader::CaptureRecycler::CaptureRecycler(std::size_t bufferCount)
+{
+    releasedBuffers_.reserve(bufferCount);
+}
+
+void CameraReader::CaptureRecycler::recycle(FrameBuffer* buffer)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    releasedBuffers_.push_back(buffer);
+}
+
+void CameraReader::CaptureRecycler::takeReleasedBuffers(std::vector<FrameBuffer*>& outBuffers)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    outBuffers.swap(releasedBuffers_);
 }
 
 }    // namespace Model
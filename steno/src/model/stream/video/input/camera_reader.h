@@ -3,41 +3,136 @@
 
 #include <linux/videodev2.h>
 
-#include "model/stream/utils/models/circular_buffer.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "model/stream/utils/alloc/frame_pool.h"
+#include "model/stream/utils/alloc/i_object_factory.h"
+#include "model/stream/utils/images/frame_ref.h"
+#include "model/stream/utils/images/mjpeg_decoder.h"
+#include "model/stream/utils/models/rectangle.h"
+#include "model/stream/utils/threads/task_scheduler.h"
 #include "model/stream/video/input/base_camera_reader.h"
 #include "model/stream/video/video_config.h"
 
 namespace Model
 {
+/**
+ * @brief Memory the driver captures in. MMAP buffers belong to the driver, USERPTR and DMABUF buffers belong to the
+ * pipeline and are imported by the driver.
+ */
+enum class CaptureMemory
+{
+    MMAP,       // Buffers allocated and mapped by the driver
+    USERPTR,    // Buffers allocated by the capture object factory
+    DMABUF      // Buffers allocated from the system dma heap
+};
+
 class CameraReader : public BaseCameraReader
 {
    public:
-    CameraReader(std::shared_ptr<VideoConfig> cameraConfig, std::size_t bufferCount);
+    CameraReader(std::shared_ptr<VideoConfig> cameraConfig, std::size_t bufferCount, CaptureMemory captureMemory,
+                 std::shared_ptr<IObjectFactory> captureObjectFactory, std::shared_ptr<TaskScheduler> taskScheduler,
+                 const Rectangle& decodeRegion);
+    virtual ~CameraReader();
+
+    bool readImage(FrameRef& frame) override;
 
-    void open() override;
-    bool readImage(Image& image) override;
+    CaptureMemory getCaptureMemory() const;
 
    protected:
     void initializeInternal() override;
     void finalizeInternal() override;
 
-    struct IndexedImage
+    // Capture buffers, indexed like the driver buffers. A buffer is queued for capture again once every frame
+    // referencing it is released
+    std::vector<std::unique_ptr<FrameBuffer>> captureBuffers_;
+
+    // Frames dropped by the driver, from the gaps in the buffer sequence numbers
+    bool hasSequence_;
+    uint32_t lastSequence_;
+    uint64_t droppedFrameCount_;
+
+    // Captures replaced by a newer one before they were read
+    uint64_t skippedFrameCount_;
+
+    // MJPEG captures dropped because they could not be decoded
+    uint64_t corruptFrameCount_;
+
+   private:
+    /**
+     * @brief Collects the released buffers, they are queued back from the reading thread.
+     */
+    class CaptureRecycler : public IFrameRecycler
     {
-        IndexedImage() = default;
-        IndexedImage(const Image& image);
+       public:
+        explicit CaptureRecycler(std::size_t bufferCount);
+
+        void recycle(FrameBuffer* buffer) override;
+        void takeReleasedBuffers(std::vector<FrameBuffer*>& outBuffers);
 
-        int index;
-        Image image;
+       private:
+        std::mutex mutex_;
+        std::vector<FrameBuffer*> releasedBuffers_;
     };
 
-    CircularBuffer<IndexedImage> images_;
+    struct DmaBuffer
+    {
+        int fd;
+        uint8_t* data;    // Mapping of the buffer for the CPU stages
+    };
 
-   private:
-    void queueCapture(IndexedImage& indexedImage);
-    void dequeueCapture(IndexedImage& indexedImage);
-    void requestBuffers(std::size_t bufferCount);
-    void mapBuffer(IndexedImage& indexedImage);
-    void unmapBuffer(IndexedImage& indexedImage);
+    bool decodeCapture(std::size_t index, FrameRef& frame);
+    void takeReleasedCaptures(bool isCameraOpen);
+    void prepareCapture(std::size_t index);
+    bool isAnyCaptureHeld() const;
+    void queueCapture(std::size_t index);
+    std::size_t dequeueCapture();
+    bool pollCapture(int timeoutMs);
+    uint64_t getCaptureTimestamp(const v4l2_buffer& buffer) const;
+    void updateSequence(uint32_t sequence);
+    bool requestBuffers(CaptureMemory captureMemory);
+    std::size_t getCaptureSize();
+    void mapBuffer(std::size_t index);
+    void unmapBuffer(std::size_t index);
+    void allocateUserBuffers();
+    void deallocateUserBuffers();
+    bool allocateDmaBuffers();
+    void deallocateDmaBuffers();
+    void syncDmaBuffer(std::size_t index, uint64_t flags);
+
+    CaptureMemory requestedCaptureMemory_;
+    CaptureMemory captureMemory_;
+    std::shared_ptr<IObjectFactory> captureObjectFactory_;
+
+    // Bytes of a capture, the driver can pad the image
+    std::size_t captureSize_;
+
+    // Bytes the driver wrote in each buffer, MJPEG frames are shorter than their buffer
+    std::vector<std::size_t> captureBytesUsed_;
+
+    // Length the driver reported for each MMAP buffer, MJPEG buffers are smaller than the decoded image
+    std::vector<std::size_t> mappedLengths_;
+
+    // MJPEG captures are decoded in frames of the image format, their buffer is captured to again right away
+    std::unique_ptr<MjpegDecoder> mjpegDecoder_;
+    std::shared_ptr<FramePool> decodedFramePool_;
+
+    // Pipeline buffers as allocated, kept across open and close since released frames can still reference them
+    std::vector<Image> userBuffers_;
+    std::vector<DmaBuffer> dmaBuffers_;
+    std::size_t dmaBufferSize_;
+
+    std::shared_ptr<CaptureRecycler> captureRecycler_;
+    std::vector<FrameBuffer*> releasedBuffers_;
+    std::size_t queuedCaptureCount_;
+
+    // Buffers referenced by frames of the consumers, they are queued once released instead of when the camera opens.
+    // A buffer held across a close is prepared for the current open when released, MMAP buffers stay mapped until then
+    std::vector<bool> heldCaptures_;
+    std::vector<bool> staleCaptures_;
 };
 
 }    // namespace Model
@@ -6,16 +6,25 @@
 
 namespace Model
 {
-CudaCameraReader::CudaCameraReader(std::shared_ptr<VideoConfig> videoConfig)
-    : CameraReader(videoConfig, 3)
+/**
+ * @param [IN] captureObjectFactory - allocates the USERPTR buffers and the decoded MJPEG frames in page-locked memory
+ * mapped on the device, the captures are copied to the device without a staging copy.
+ */
+CudaCameraReader::CudaCameraReader(std::shared_ptr<VideoConfig> videoConfig, CaptureMemory captureMemory,
+                                   std::shared_ptr<IObjectFactory> captureObjectFactory,
+                                   std::shared_ptr<TaskScheduler> taskScheduler, const Rectangle& decodeRegion)
+    : CameraReader(videoConfig, 3, captureMemory, captureObjectFactory, taskScheduler, decodeRegion)
     , pageLockedImage_(videoConfig->resolution.width, videoConfig->resolution.height, videoConfig->imageFormat)
 {
     checkCuda(cudaMallocHost(&pageLockedImage_.hostData, pageLockedImage_.size, 0));
 
-    for (std::size_t i = 0; i < images_.size(); ++i)
+    // Decoded MJPEG frames are read by the device where they are, the captures are never on the device
+    if (!videoConfig->isMjpegCapture)
     {
-        deviceCudaObjectFactory_.allocateObject(images_.current().image);
-        images_.next();
+        for (std::unique_ptr<FrameBuffer>& captureBuffer : captureBuffers_)
+        {
+            deviceCudaObjectFactory_.allocateObject(captureBuffer->image);
+        }
     }
 
     checkCuda(cudaStreamCreate(&stream_));
@@ -25,10 +34,9 @@ CudaCameraReader::~CudaCameraReader()
 {
     cudaFreeHost(pageLockedImage_.hostData);
 
-    for (std::size_t i = 0; i < images_.size(); ++i)
+    for (std::unique_ptr<FrameBuffer>& captureBuffer : captureBuffers_)
     {
-        deviceCudaObjectFactory_.deallocateObject(images_.current().image);
-        images_.next();
+        deviceCudaObjectFactory_.deallocateObject(captureBuffer->image);
     }
 
     cudaStreamDestroy(stream_);
@@ -37,34 +45,46 @@ CudaCameraReader::~CudaCameraReader()
 void CudaCameraReader::open()
 {
     CameraReader::open();
-    CameraReader::readImage(nextImage_);
-    copyImageToDevice(nextImage_);
+    CameraReader::readImage(nextFrame_);
+    copyImageToDevice(*nextFrame_);
     cudaStreamSynchronize(stream_);
 }
 
 void CudaCameraReader::close()
 {
+    nextFrame_.reset();
     BaseCameraReader::close();
 }
 
-bool CudaCameraReader::readImage(Image& image)
+bool CudaCameraReader::readImage(FrameRef& frame)
 {
-    image = nextImage_;
-    CameraReader::readImage(nextImage_);
-    copyImageToDevice(nextImage_);
+    // The next frame is copied to the device while this one is processed
+    frame = nextFrame_;
+    CameraReader::readImage(nextFrame_);
+    copyImageToDevice(*nextFrame_);
 
     return true;
 }
 
 void CudaCameraReader::copyImageToDevice(const Image& image)
 {
-    // Copy the image data to a page-locked image (this is for faster async copy to device memory)
-    std::memcpy(pageLockedImage_.hostData, image.hostData, image.size);
+    if (videoConfig_->isMjpegCapture)
+    {
+        return;
+    }
 
-    // Wait for the previous async copy completion
+    // Wait for the previous async copy completion, it can read from the page-locked image
     cudaStreamSynchronize(stream_);
 
-    // Async copy to device memory
-    cudaMemcpyAsync(image.deviceData, pageLockedImage_.hostData, image.size, cudaMemcpyHostToDevice, stream_);
+    // User buffers are page-locked already, driver buffers are copied to a page-locked image for a faster async copy
+    const unsigned char* pageLockedData = image.hostData;
+    if (getCaptureMemory() != CaptureMemory::USERPTR)
+    {
+        std::memcpy(pageLockedImage_.hostData, image.hostData, image.size);
+        pageLockedData = pageLockedImage_.hostData;
+    }
+
+    // Async copy to device memory, the frame is held by nextFrame_ so its buffer is not captured to meanwhile
+    cudaMemcpyAsync(image.deviceData, pageLockedData, image.size, cudaMemcpyHostToDevice, stream_);
 }
 }    // namespace Model
\ No newline at end of file
@@ -11,18 +11,20 @@ namespace Model
 class CudaCameraReader : public CameraReader
 {
    public:
-    explicit CudaCameraReader(std::shared_ptr<VideoConfig> videoConfig);
+    CudaCameraReader(std::shared_ptr<VideoConfig> videoConfig, CaptureMemory captureMemory,
+                     std::shared_ptr<IObjectFactory> captureObjectFactory, std::shared_ptr<TaskScheduler> taskScheduler,
+                     const Rectangle& decodeRegion);
     virtual ~CudaCameraReader();
 
     void open() override;
     void close() override;
-    bool readImage(Image& image) override;
+    bool readImage(FrameRef& frame) override;
 
    private:
     void copyImageToDevice(const Image& image);
 
     DeviceCudaObjectFactory deviceCudaObjectFactory_;
-    Image nextImage_;
+    FrameRef nextFrame_;
     cudaStream_t stream_;
     Image pageLockedImage_;
 };
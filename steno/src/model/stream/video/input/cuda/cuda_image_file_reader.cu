@@ -14,8 +14,8 @@ CudaImageFileReader::~CudaImageFileReader()
     deviceCudaObjectFactory_.deallocateObject(image_);
 }
 
-bool CudaImageFileReader::readImage(Image& image)
+bool CudaImageFileReader::readImage(FrameRef& frame)
 {
-    return ImageFileReader::readImage(image);
+    return ImageFileReader::readImage(frame);
 }
 }    // namespace Model
\ No newline at end of file
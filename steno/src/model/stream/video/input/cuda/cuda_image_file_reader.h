@@ -12,7 +12,7 @@ class CudaImageFileReader : public ImageFileReader
     CudaImageFileReader(const std::string& imageFilePath, ImageFormat format);
     virtual ~CudaImageFileReader();
 
-    bool readImage(Image& image) override;
+    bool readImage(FrameRef& frame) override;
 
    private:
     DeviceCudaObjectFactory deviceCudaObjectFactory_;
@@ -12,12 +12,6 @@ VcCudaCameraReader::VcCudaCameraReader(std::shared_ptr<VideoConfig> videoConfig)
 {
     checkCuda(cudaMallocHost(&pageLockedImage_.hostData, pageLockedImage_.size, 0));
 
-    for (std::size_t i = 0; i < images_.size(); ++i)
-    {
-        deviceCudaObjectFactory_.allocateObject(images_.current());
-        images_.next();
-    }
-
     checkCuda(cudaStreamCreate(&stream_));
 }
 
@@ -25,10 +19,9 @@ VcCudaCameraReader::~VcCudaCameraReader()
 {
     cudaFreeHost(pageLockedImage_.hostData);
 
-    for (std::size_t i = 0; i < images_.size(); ++i)
+    for (Image& deviceImage : deviceImages_)
     {
-        deviceCudaObjectFactory_.deallocateObject(images_.current());
-        images_.next();
+        deviceCudaObjectFactory_.deallocateObject(deviceImage);
     }
 
     cudaStreamDestroy(stream_);
@@ -37,27 +30,35 @@ VcCudaCameraReader::~VcCudaCameraReader()
 void VcCudaCameraReader::open()
 {
     VcCameraReader::open();
-    VcCameraReader::readImage(nextImage_);
-    copyImageToDevice(nextImage_);
+    VcCameraReader::readImage(nextFrame_);
+    copyImageToDevice(*nextFrame_);
     cudaStreamSynchronize(stream_);
 }
 
 void VcCudaCameraReader::close()
 {
+    nextFrame_.reset();
     BaseCameraReader::close();
 }
 
-bool VcCudaCameraReader::readImage(Image& image)
+bool VcCudaCameraReader::readImage(FrameRef& frame)
 {
-    image = nextImage_;
-    VcCameraReader::readImage(nextImage_);
-    copyImageToDevice(nextImage_);
+    // The next frame is copied to the device while this one is processed
+    frame = nextFrame_;
+    VcCameraReader::readImage(nextFrame_);
+    copyImageToDevice(*nextFrame_);
 
     return true;
 }
 
-void VcCudaCameraReader::copyImageToDevice(const Image& image)
+void VcCudaCameraReader::copyImageToDevice(Image& image)
 {
+    if (image.deviceData == nullptr)
+    {
+        deviceCudaObjectFactory_.allocateObject(image);
+        deviceImages_.push_back(image);
+    }
+
     // Copy the image data to a page-locked image (this is for faster async copy to device memory)
     std::memcpy(pageLockedImage_.hostData, image.hostData, image.size);
 
@@ -3,6 +3,8 @@
 
 #include <cuda_runtime.h>
 
+#include <vector>
+
 #include "model/stream/utils/alloc/cuda/device_cuda_object_factory.h"
 #include "model/stream/video/input/vc_camera_reader.h"
 
@@ -16,13 +18,16 @@ class VcCudaCameraReader : public VcCameraReader
 
     void open() override;
     void close() override;
-    bool readImage(Image& image) override;
+    bool readImage(FrameRef& frame) override;
 
    private:
-    void copyImageToDevice(const Image& image);
+    void copyImageToDevice(Image& image);
 
     DeviceCudaObjectFactory deviceCudaObjectFactory_;
-    Image nextImage_;
+    FrameRef nextFrame_;
+
+    // Device buffers of the pooled frames, allocated the first time a frame is read
+    std::vector<Image> deviceImages_;
     cudaStream_t stream_;
     Image pageLockedImage_;
 };
@@ -1,17 +1,35 @@
 #include "dewarped_video_input.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cstring>
 #include <iostream>
 
 #include "model/classifier/classifier.h"
+#include "model/stream/utils/alloc/accounting_object_factory.h"
+#include "model/stream/utils/alloc/frame_pool.h"
 #include "model/stream/utils/alloc/heap_object_factory.h"
 #include "model/stream/utils/images/image_drawing.h"
 #include "model/stream/video/virtualcamera/display_image_builder.h"
-#include "model/stream/frame_rate_stabilizer.h"
 #include "model/stream/utils/models/point.h"
 #include "model/stream/utils/models/spherical_angle_rect.h"
+#include "model/stream/utils/time/timer.h"
 #include "model/stream/video/dewarping/dewarping_helper.h"
 
+namespace
+{
+// Transient data of a frame (virtual cameras, classification, display layout), grows if a frame needs more
+const std::size_t FRAME_ARENA_SIZE = 64 * 1024;
+
+// Virtual camera buffers unused for this long are released, a speaker leaving for a moment keeps its buffers
+const uint64_t VC_BUFFER_RELEASE_DELAY_US = 10000000;
+
+const char* DISPLAY_FRAMES_SUBSYSTEM = "display frames";
+
+// Pause before reading again when the video input has no frame
+const std::chrono::milliseconds READ_RETRY_DELAY(10);
+}    // namespace
+
 namespace Model
 {
 DewarpedVideoInput::DewarpedVideoInput(std::unique_ptr<IVideoInput> videoInput,
@@ -21,10 +39,14 @@ DewarpedVideoInput::DewarpedVideoInput(std::unique_ptr<IVideoInput> videoInput,
                                        std::unique_ptr<DetectionThread> detectionThread,
                                        std::shared_ptr<LockTripleBuffer<RGBImage>> imageBuffer, std::unique_ptr<IImageConverter> imageConverter,
                                        std::shared_ptr<IPositionSource> positionSource,
+                                       std::shared_ptr<TaskScheduler> taskScheduler,
+                                       std::shared_ptr<QualityGovernor> qualityGovernor,
+                                       std::shared_ptr<MemoryAccounting> memoryAccounting,
                                        std::shared_ptr<DewarpingConfig> dewarpingConfig, std::shared_ptr<VideoConfig> videoInputConfig,
                                        std::shared_ptr<VideoConfig> videoOutputConfig,
                                        int bufferCount,
-                                       float classifierRangeThreshold)
+                                       float classifierRangeThreshold,
+                                       OutputMode outputMode)
     : Thread()
     , videoInput_(std::move(videoInput))
     , dewarper_(std::move(dewarper))
@@ -35,15 +57,24 @@ DewarpedVideoInput::DewarpedVideoInput(std::unique_ptr<IVideoInput> videoInput,
     , imageBuffer_(imageBuffer)
     , imageConverter_(std::move(imageConverter))
     , positionSource_(positionSource)
+    , taskScheduler_(taskScheduler)
+    , qualityGovernor_(qualityGovernor)
+    , memoryAccounting_(memoryAccounting)
     , dewarpingConfig_(dewarpingConfig)
     , videoInputConfig_(videoInputConfig)
     , videoOutputConfig_(videoOutputConfig)
+    , outputMode_(outputMode)
     , outputImageQueue_(bufferCount - 1)
     , bufferCount_(bufferCount)
     , classifierRangeThreshold_(classifierRangeThreshold)
+    , frameArena_(FRAME_ARENA_SIZE)
+    , isVcCountBelowBuffers_(false)
+    , vcCountBelowBuffersTimestamp_(0)
+    , maxRecentVcCount_(0)
 {
     if (!videoInput_ || !dewarper_ || !objectFactory_ || !synchronizer_ || !virtualCameraManager_ || 
-        !imageBuffer_ || !imageConverter_ || !positionSource || !dewarpingConfig_ || !videoInputConfig_ || !videoOutputConfig_)
+        !imageBuffer_ || !imageConverter_ || !positionSource || !qualityGovernor_ || !memoryAccounting_ ||
+        !dewarpingConfig_ || !videoInputConfig_ || !videoOutputConfig_)
     {
         throw std::invalid_argument("Error in DewarpedVideoInput - Null is not a valid argument");
     }
@@ -75,21 +106,37 @@ void DewarpedVideoInput::close()
     join();
 }
 
-bool DewarpedVideoInput::readImage(Image& image)
+bool DewarpedVideoInput::readImage(FrameRef& frame)
+{
+    if (outputMode_ == OutputMode::LATEST_FRAME)
+    {
+        return outputMailbox_.tryConsume(frame);
+    }
+
+    return outputImageQueue_.try_dequeue(frame);
+}
+
+/**
+ * @brief Produced, consumed and dropped output frames, frames are only dropped in LATEST_FRAME mode.
+ */
+MailboxStats DewarpedVideoInput::getOutputStats() const
 {
-    return outputImageQueue_.try_dequeue(image);
+    return outputMailbox_.getStats();
 }
 
 void DewarpedVideoInput::run()
 {
     // Utilitary objects
-    HeapObjectFactory heapObjectFactory;
-    DisplayImageBuilder displayImageBuilder(videoOutputConfig_->resolution);
-    FrameRateStabilizer videoStabilizer(videoInputConfig_->fpsTarget);
+    std::shared_ptr<IObjectFactory> displayObjectFactory = std::make_shared<AccountingObjectFactory>(
+        std::make_unique<HeapObjectFactory>(), memoryAccounting_, DISPLAY_FRAMES_SUBSYSTEM);
+    DisplayImageBuilder displayImageBuilder(videoOutputConfig_->resolution, taskScheduler_);
+    Timer processingTimer;
+    uint64_t lastCaptureTimestamp = 0;
 
-    // Display images
+    // Display images, a display frame is back in the pool when the consumers release it
     Image emptyDisplay(videoOutputConfig_->resolution, videoOutputConfig_->imageFormat);
-    CircularBuffer<Image> displayBuffers(bufferCount_, Image(videoOutputConfig_->resolution, videoOutputConfig_->imageFormat));
+    std::shared_ptr<FramePool> displayPool =
+        std::make_shared<FramePool>(displayObjectFactory, emptyDisplay, bufferCount_);
 
     // Virtual cameras images
     Dim2<int> maxVcDim = displayImageBuilder.getMaxVirtualCameraDim();
@@ -97,8 +144,7 @@ void DewarpedVideoInput::run()
     try
     {
         // Allocate display images
-        heapObjectFactory.allocateObject(emptyDisplay);
-        heapObjectFactory.allocateObjectCircularBuffer(displayBuffers);
+        displayObjectFactory->allocateObject(emptyDisplay);
 
         // Set background color of empty display
         displayImageBuilder.setDisplayImageColor(emptyDisplay);
@@ -108,16 +154,51 @@ void DewarpedVideoInput::run()
 
         while (!isAbortRequested())
         {
-            videoStabilizer.startFrame();
-
-            updateVirtualCameras(videoStabilizer.getLastFrameTimeMs());
+            // The loop follows the camera, reading blocks until the next frame is captured. Waiting for the
+            // camera is not part of the frame processing time
+            FrameRef rawFisheyeFrame;
+            if (!videoInput_->readImage(rawFisheyeFrame))
+            {
+                sleepUntil(std::chrono::steady_clock::now() + READ_RETRY_DELAY);
+                continue;
+            }
+            processingTimer.reset();
+            frameArena_.reset();
+            const Image& rawFisheyeImage = *rawFisheyeFrame;
+
+            // Virtual cameras move by the time between the captures
+            int frameTimeMs = lastCaptureTimestamp == 0
+                                  ? 0
+                                  : static_cast<int>((rawFisheyeImage.timeStamp - lastCaptureTimestamp) / 1000);
+            lastCaptureTimestamp = rawFisheyeImage.timeStamp;
+            updateVirtualCameras(frameTimeMs);
+
+            // Convert the image to rgb format for dewarping
+            const RGBImage& rgbFisheyeImage = getRgbFisheyeImage(rawFisheyeImage);
+
+            // Every display frame is held by the consumers, this capture is not displayed and counts as a
+            // missed frame for the quality governor
+            FrameRef displayFrame;
+            if (!displayPool->tryAcquire(displayFrame))
+            {
+                qualityGovernor_->reportDroppedFrame();
+                continue;
+            }
 
-            // Read image from video input and convert it to rgb format for dewarping
-            const RGBImage& rgbFisheyeImage = getRgbFisheyeImage();
+            // Set the timestamp of the output image to the timestamp of the input image
+            Image& displayImage = *displayFrame;
+            displayImage.timeStamp = rgbFisheyeImage.timeStamp;
 
-            // Get the active virtual cameras
-            const std::vector<VirtualCamera> virtualCameras = virtualCameraManager_->getVirtualCameras();
+            // Get the active virtual cameras, the quality governor can limit how many are displayed
+            ArenaVector<VirtualCamera> virtualCameras(frameArena_);
+            virtualCameraManager_->getVirtualCameras(virtualCameras);
+            int maxVcCount = qualityGovernor_->getMaxVirtualCameraCount();
+            if (static_cast<int>(virtualCameras.size()) > maxVcCount)
+            {
+                virtualCameras.erase(virtualCameras.begin() + maxVcCount, virtualCameras.end());
+            }
             int vcCount = static_cast<int>(virtualCameras.size());
+            releaseUnusedDewarpedImageBuffers(vcCount, rawFisheyeImage.timeStamp);
 
             // If there are active virtual cameras, dewarp images of each vc and combine them in an output image
             if (vcCount > 0)
@@ -128,35 +209,38 @@ void DewarpedVideoInput::run()
                     addDewarpedImageBuffers(maxVcDim);
                 }
 
-                // Get the size of the virtual camera images to dewarp (this is to prevent resizing after)
+                // Get the size of the virtual camera images to dewarp (this is to prevent resizing after), the
+                // quality governor can lower it in which case the display image builder scales the images back
                 Dim2<int> dewarpDim = displayImageBuilder.getVirtualCameraDim(vcCount);
-                std::vector<Image> dewarpedImages(vcCount);
+                float resolutionScale = qualityGovernor_->getVirtualCameraResolutionScale();
+                if (resolutionScale < 1.f)
+                {
+                    // Make sure it's a multiple of 2 for compressed formats (make last bit 0)
+                    dewarpDim = Dim2<int>(static_cast<int>(dewarpDim.width * resolutionScale) & 0xFFFE,
+                                          static_cast<int>(dewarpDim.height * resolutionScale) & 0xFFFE);
+                }
+                bool isFiltered = qualityGovernor_->isFilteringEnabled();
+                ArenaVector<Image> dewarpedImages(frameArena_);
+                dewarpedImages.reserve(vcCount);
 
                 // Virtual camera dewarping loop
                 for (int i = 0; i < vcCount; ++i)
                 {
-                    dewarpedImages[i] = dewarpInOutputFormat(rgbFisheyeImage, virtualCameras[i], dewarpDim, 
-                                                             vcRgbImages_[i], vcOutputFormatImages_[i]);
+                    dewarpedImages.push_back(dewarpInOutputFormat(rgbFisheyeImage, virtualCameras[i], dewarpDim,
+                                                                  vcRgbImages_[i], vcOutputFormatImages_[i],
+                                                                  isFiltered));
                 }
 
                 // Clear the image before writting to it
-                Image& displayImage = displayBuffers.current();
                 std::memcpy(displayImage.hostData, emptyDisplay.hostData, displayImage.size);
 
-                // Set the timestamp of the output image to the timestamp of the input image
-                displayImage.timeStamp = rgbFisheyeImage.timeStamp;
-
                 // Wait for dewarping to be completed
                 synchronizer_->sync();
 
-                // Get audio sources and image spatial positions
-                std::vector<SourcePosition> sourcePositions = positionSource_->getPositions();
-                std::vector<SphericalAngleRect> imagePositions;
-                imagePositions.reserve(virtualCameras.size());
-                for (const auto& vc : virtualCameras)
-                {
-                    imagePositions.push_back(vc);
-                }
+                // Get audio sources at the time of the image and image spatial positions
+                SourcePositions sourcePositions = positionSource_->getPositionsAt(rgbFisheyeImage.timeStamp);
+                ArenaVector<SphericalAngleRect> imagePositions(virtualCameras.begin(), virtualCameras.end(),
+                                                               frameArena_);
 
                 int borderWidth = 2;
                 RGB borderColor;
@@ -164,8 +248,9 @@ void DewarpedVideoInput::run()
                 borderColor.g = 165;
                 borderColor.b = 89;
 
-                std::vector<std::pair<int, int>> audioImagePairs =
-                    Classifier::getAudioImagePairs(sourcePositions, imagePositions, classifierRangeThreshold_);
+                ArenaVector<std::pair<int, int>> audioImagePairs(frameArena_);
+                Classifier::getAudioImagePairs(sourcePositions, imagePositions, classifierRangeThreshold_,
+                                               audioImagePairs);
 
                 for (std::pair<int, int> pair : audioImagePairs)
                 {
@@ -173,22 +258,20 @@ void DewarpedVideoInput::run()
                                               borderWidth, borderColor);
                 }
 
-                // Write to output image and send it to the video output
+                // Write to output image
                 displayImageBuilder.createDisplayImage(dewarpedImages, displayImage);
-                queueOutputImage(displayImage);
-                displayBuffers.next();
             }
             else
             {
-                // Set the timestamp of the output image to the timestamp of the input image
-                emptyDisplay.timeStamp = rgbFisheyeImage.timeStamp;
-
                 // If there are no active virtual cameras, just send an empty image
-                queueOutputImage(emptyDisplay);
+                std::memcpy(displayImage.hostData, emptyDisplay.hostData, displayImage.size);
             }
 
-            // If the frame took less than 1/fps, this call will block to match frame time of 1/fps
-            videoStabilizer.endFrame();
+            // Waiting for the consumers to take the image is backpressure, not processing
+            qualityGovernor_->reportFrameTime(processingTimer.getElapsedTime<std::chrono::microseconds>());
+
+            // Send the image to the video output
+            queueOutputImage(displayFrame);
         }
     }
     catch (const std::exception& e)
@@ -200,23 +283,48 @@ void DewarpedVideoInput::run()
     videoInput_->close();
     virtualCameraManager_->clearVirtualCameras();
 
-    // Deallocate display images
-    heapObjectFactory.deallocateObject(emptyDisplay);
-    heapObjectFactory.deallocateObjectCircularBuffer(displayBuffers);
+    // Deallocate display images, the pool is freed once the consumers release their frames
+    displayObjectFactory->deallocateObject(emptyDisplay);
 
     cleanDewarpedImageBuffers();
 
+    if (outputMode_ == OutputMode::LATEST_FRAME)
+    {
+        MailboxStats stats = outputMailbox_.getStats();
+        std::cout << "DewarpedVideoInput output frames : " << stats.producedCount << " produced, "
+                  << stats.consumedCount << " consumed, " << stats.droppedCount << " dropped" << std::endl;
+    }
+
+    FramePoolStats poolStats = displayPool->getStats();
+    std::cout << "DewarpedVideoInput display frames : " << poolStats.frameCount << " allocated, "
+              << poolStats.exhaustedCount << " captures skipped while every frame was held" << std::endl;
+
+    ArenaStats arenaStats = frameArena_.getStats();
+    std::cout << "DewarpedVideoInput frame arena : " << arenaStats.peakUsedBytes << " of " << arenaStats.capacity
+              << " bytes used at most, " << arenaStats.overflowCount << " heap allocations, grown "
+              << arenaStats.growCount << " times" << std::endl;
+
     std::cout << "DewarpedVideoInput loop finished" << std::endl;
 }
 
-void DewarpedVideoInput::queueOutputImage(const Image& image)
+/**
+ * @brief Hand an output frame to the consumer, in LATEST_FRAME mode the unconsumed frame it replaces is released.
+ */
+void DewarpedVideoInput::queueOutputImage(const FrameRef& frame)
 {
+    if (outputMode_ == OutputMode::LATEST_FRAME)
+    {
+        FrameRef droppedFrame;
+        outputMailbox_.publish(frame, droppedFrame);
+        return;
+    }
+
     bool success = false;
     
     // If queue is full keep trying...
     while (!success && !isAbortRequested())
     {
-        success = outputImageQueue_.try_enqueue(image);
+        success = outputImageQueue_.try_enqueue(frame);
 
         if (!success)
         {
@@ -232,18 +340,15 @@ void DewarpedVideoInput::updateVirtualCameras(int frameTimeMs)
     // Try to get queued detections
     if (detectionThread_->getDetections(detections))
     {
-        virtualCameraManager_->updateVirtualCamerasGoal(detections);
+        virtualCameraManager_->updateVirtualCamerasGoal(detections, frameArena_);
     }
 
     // Update the position and size of virtual cameras
-    virtualCameraManager_->updateVirtualCameras(frameTimeMs);
+    virtualCameraManager_->updateVirtualCameras(frameTimeMs, frameArena_);
 }
 
-const RGBImage& DewarpedVideoInput::getRgbFisheyeImage()
+const RGBImage& DewarpedVideoInput::getRgbFisheyeImage(const Image& rawFisheyeImage)
 {
-    Image rawFisheyeImage;
-    videoInput_->readImage(rawFisheyeImage);
-
     // Convert the fisheye image to rgb format
     RGBImage& rgbFisheyeImage = imageBuffer_->getCurrent();
     imageConverter_->convert(rawFisheyeImage, rgbFisheyeImage);
@@ -256,7 +361,7 @@ const RGBImage& DewarpedVideoInput::getRgbFisheyeImage()
 
 Image DewarpedVideoInput::dewarpInOutputFormat(const RGBImage& rgbFisheyeImage, const SphericalAngleRect& dewarpArea,
                                                const Dim2<int>& dewarpDim, const RGBImage& allocatedRgbImage, 
-                                               const Image& allocatedOutputImage)
+                                               const Image& allocatedOutputImage, bool isFiltered)
 {
     RGBImage dewarpedRgbImage(dewarpDim);
     Image dewarpedOutputImage(dewarpDim, allocatedOutputImage.format);
@@ -267,7 +372,14 @@ Image DewarpedVideoInput::dewarpInOutputFormat(const RGBImage& rgbFisheyeImage,
 
     // Dewarping of virtual camera
     DewarpingParameters vcParams = getDewarpingParametersFromSphericalAngleRect(dewarpArea, *dewarpingConfig_, fisheyeCenter_);
-    dewarper_->dewarpImageFiltered(rgbFisheyeImage, dewarpedRgbImage, vcParams);
+    if (isFiltered)
+    {
+        dewarper_->dewarpImageFiltered(rgbFisheyeImage, dewarpedRgbImage, vcParams);
+    }
+    else
+    {
+        dewarper_->dewarpImage(rgbFisheyeImage, dewarpedRgbImage, vcParams);
+    }
 
     // Use the allocated buffer, but with correct dewarp dimension
     dewarpedOutputImage.hostData = allocatedOutputImage.hostData;
@@ -290,6 +402,48 @@ void DewarpedVideoInput::addDewarpedImageBuffers(const Dim2<int> maxVcDim)
     vcOutputFormatImages_.push_back(vcOutputFormatImage);
 }
 
+/**
+ * @brief Release the virtual camera buffers that no frame used since the virtual camera count went below the buffer
+ * count, once it stayed below for the release delay. The dewarping of the previous frames is completed.
+ */
+void DewarpedVideoInput::releaseUnusedDewarpedImageBuffers(int vcCount, uint64_t timestamp)
+{
+    int bufferCount = static_cast<int>(vcRgbImages_.size());
+    if (vcCount >= bufferCount)
+    {
+        isVcCountBelowBuffers_ = false;
+        return;
+    }
+
+    if (!isVcCountBelowBuffers_)
+    {
+        isVcCountBelowBuffers_ = true;
+        vcCountBelowBuffersTimestamp_ = timestamp;
+        maxRecentVcCount_ = vcCount;
+        return;
+    }
+
+    maxRecentVcCount_ = std::max(maxRecentVcCount_, vcCount);
+    if (timestamp - vcCountBelowBuffersTimestamp_ < VC_BUFFER_RELEASE_DELAY_US)
+    {
+        return;
+    }
+
+    while (static_cast<int>(vcRgbImages_.size()) > maxRecentVcCount_)
+    {
+        objectFactory_->deallocateObject(vcRgbImages_.back());
+        objectFactory_->deallocateObject(vcOutputFormatImages_.back());
+        vcRgbImages_.pop_back();
+        vcOutputFormatImages_.pop_back();
+    }
+
+    objectFactory_->releaseUnusedMemory();
+    isVcCountBelowBuffers_ = false;
+
+    std::cout << "DewarpedVideoInput released " << bufferCount - maxRecentVcCount_ << " virtual camera buffers"
+              << std::endl;
+}
+
 void DewarpedVideoInput::cleanDewarpedImageBuffers()
 {
     // Deallocate virtual camera images
@@ -4,11 +4,16 @@
 #include "model/config/config.h"
 #include "model/stream/audio/audio_config.h"
 #include "model/stream/audio/i_position_source.h"
+#include "model/stream/quality_governor.h"
 #include "model/stream/utils/alloc/i_object_factory.h"
+#include "model/stream/utils/alloc/memory_accounting.h"
+#include "model/stream/utils/alloc/monotonic_arena.h"
 #include "model/stream/utils/images/i_image_converter.h"
+#include "model/stream/utils/threads/latest_value_mailbox.h"
 #include "model/stream/utils/threads/lock_triple_buffer.h"
 #include "model/stream/utils/threads/readerwriterqueue.h"
 #include "model/stream/utils/threads/sync/i_synchronizer.h"
+#include "model/stream/utils/threads/task_scheduler.h"
 #include "model/stream/utils/threads/thread.h"
 #include "model/stream/video/detection/detection_thread.h"
 #include "model/stream/video/dewarping/i_fisheye_dewarper.h"
@@ -23,32 +28,45 @@ class DewarpedVideoInput : public IVideoInput, protected Thread
 {
 public:
 
+    enum class OutputMode
+    {
+        QUEUE,          // Every frame is delivered, the video thread waits when the queue is full
+        LATEST_FRAME    // Only the newest frame is delivered, unconsumed frames are dropped back to the pool
+    };
+
     DewarpedVideoInput(std::unique_ptr<IVideoInput> videoInput, std::unique_ptr<IFisheyeDewarper> dewarper, 
                        std::unique_ptr<IObjectFactory> objectFactory, std::unique_ptr<ISynchronizer> synchronizer,
                        std::shared_ptr<VirtualCameraManager> virtualCameraManager,
                        std::unique_ptr<DetectionThread> detectionThread,
                        std::shared_ptr<LockTripleBuffer<RGBImage>> imageBuffer, std::unique_ptr<IImageConverter> imageConverter,
                        std::shared_ptr<IPositionSource> positionSource,
+                       std::shared_ptr<TaskScheduler> taskScheduler,
+                       std::shared_ptr<QualityGovernor> qualityGovernor,
+                       std::shared_ptr<MemoryAccounting> memoryAccounting,
                        std::shared_ptr<DewarpingConfig> dewarpingConfig, std::shared_ptr<VideoConfig> videoInputConfig,
                        std::shared_ptr<VideoConfig> videoOutputConfig,
                        int bufferCount,
-                       float classifierRangeThreshold);
+                       float classifierRangeThreshold,
+                       OutputMode outputMode);
 
     void open() override;
     void close() override;
-    bool readImage(Image& image) override;
+    bool readImage(FrameRef& frame) override;
+
+    MailboxStats getOutputStats() const;
 
 protected:
     void run() override;
 
 private:
-    void queueOutputImage(const Image& image);
+    void queueOutputImage(const FrameRef& frame);
     void updateVirtualCameras(int frameTimeMs);
-    const RGBImage& getRgbFisheyeImage();
+    const RGBImage& getRgbFisheyeImage(const Image& rawFisheyeImage);
     Image dewarpInOutputFormat(const RGBImage& rgbFisheyeImage, const SphericalAngleRect& dewarpArea,
                                const Dim2<int>& dewarpDim, const RGBImage& allocatedRgbImage, 
-                               const Image& allocatedOutputImage);
+                               const Image& allocatedOutputImage, bool isFiltered);
     void addDewarpedImageBuffers(const Dim2<int> maxVcDim);
+    void releaseUnusedDewarpedImageBuffers(int vcCount, uint64_t timestamp);
     void cleanDewarpedImageBuffers();
 
     std::unique_ptr<IVideoInput> videoInput_;
@@ -61,20 +79,31 @@ private:
     std::unique_ptr<IImageConverter> imageConverter_;
 
     std::shared_ptr<IPositionSource> positionSource_;
+    std::shared_ptr<TaskScheduler> taskScheduler_;
+    std::shared_ptr<QualityGovernor> qualityGovernor_;
+    std::shared_ptr<MemoryAccounting> memoryAccounting_;
 
     std::shared_ptr<DewarpingConfig> dewarpingConfig_;
     std::shared_ptr<VideoConfig> videoInputConfig_;
     std::shared_ptr<VideoConfig> videoOutputConfig_;
 
-    moodycamel::ReaderWriterQueue<Image> outputImageQueue_;
+    OutputMode outputMode_;
+    moodycamel::ReaderWriterQueue<FrameRef> outputImageQueue_;
+    LatestValueMailbox<FrameRef> outputMailbox_;
     int bufferCount_;
 
     float classifierRangeThreshold_;
 
     Point<float> fisheyeCenter_;
+    MonotonicArena frameArena_;
     std::vector<RGBImage> vcRgbImages_;
     std::vector<Image> vcOutputFormatImages_;
 
+    // Buffers above the virtual camera count are released once it stayed lower for a while
+    bool isVcCountBelowBuffers_;
+    uint64_t vcCountBelowBuffersTimestamp_;
+    int maxRecentVcCount_;
+
 };
 }   // Model
 
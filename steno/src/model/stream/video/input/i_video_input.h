@@ -1,17 +1,20 @@
 #ifndef I_VIDEO_INPUT_H
 #define I_VIDEO_INPUT_H
 
-#include "model/stream/utils/images/images.h"
+#include "model/stream/utils/images/frame_ref.h"
 
 namespace Model
 {
+/**
+ * @brief Source of frames, a frame stays valid while referenced and its buffer is only reused once released.
+ */
 class IVideoInput
 {
    public:
     virtual ~IVideoInput() = default;
     virtual void open() = 0;
     virtual void close() = 0;
-    virtual bool readImage(Image& image) = 0;
+    virtual bool readImage(FrameRef& frame) = 0;
 };
 
 }    // namespace Model
@@ -48,9 +48,16 @@ void ImageFileReader::close()
     // TODO: breaks interfaces segregation principle
 }
 
-bool ImageFileReader::readImage(Image& image)
+bool ImageFileReader::readImage(FrameRef& frame)
 {
-    image = image_;
+    // Created on the first read, once derived readers are done with the image
+    if (!frame_)
+    {
+        frameBuffer_ = std::make_unique<FrameBuffer>(image_);
+        frame_ = FrameRef(frameBuffer_.get(), nullptr);
+    }
+
+    frame = frame_;
     return true;
 }
 
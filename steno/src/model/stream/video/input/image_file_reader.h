@@ -18,7 +18,7 @@ class ImageFileReader : public IVideoInput
 
     void open() override;
     void close() override;
-    bool readImage(Image& image) override;
+    bool readImage(FrameRef& frame) override;
 
    protected:
     Image image_;
@@ -29,6 +29,10 @@ class ImageFileReader : public IVideoInput
 
     ImageConverter imageConverter_;
     HeapObjectFactory heapObjectFactory_;
+
+    // The image never changes, every frame shares its buffer
+    std::unique_ptr<FrameBuffer> frameBuffer_;
+    FrameRef frame_;
 };
 
 }    // namespace Model
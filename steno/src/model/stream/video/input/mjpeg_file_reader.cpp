@@ -0,0 +1,113 @@
+#include "mjpeg_file_reader.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <thread>
+
+#include "model/stream/utils/time/media_clock.h"
+
+namespace Model
+{
+namespace
+{
+// Frames held by the consumers at most, like the captures of a camera
+const std::size_t FRAME_COUNT = 3;
+}    // namespace
+
+/**
+ * @param [IN] mjpegFilePath - recorded MJPEG stream, like the output of ffmpeg -c:v copy -f mjpeg.
+ * @param [IN] videoConfig - dimensions, format and frame rate of the frames, the recording must have the same
+ * dimensions.
+ * @param [IN] objectFactory - allocates the decoded frames.
+ */
+MjpegFileReader::MjpegFileReader(const std::string& mjpegFilePath, std::shared_ptr<VideoConfig> videoConfig,
+                                 std::shared_ptr<IObjectFactory> objectFactory,
+                                 std::shared_ptr<TaskScheduler> taskScheduler)
+    : videoConfig_(videoConfig)
+    , nextFrameIndex_(0)
+    , mjpegDecoder_(taskScheduler, TaskPriority::HIGH)
+    , framePool_(std::make_shared<FramePool>(
+          objectFactory,
+          Image(videoConfig->resolution.width, videoConfig->resolution.height, videoConfig->imageFormat),
+          FRAME_COUNT))
+    , framePeriod_(std::chrono::microseconds(1000000 / std::max(videoConfig->fpsTarget, 1)))
+{
+    std::ifstream file(mjpegFilePath, std::ios::binary);
+
+    if (!file)
+    {
+        throw std::runtime_error("Could not open file " + mjpegFilePath);
+    }
+
+    fileData_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    splitFrames();
+
+    if (frames_.empty())
+    {
+        throw std::runtime_error("No MJPEG frame in file " + mjpegFilePath);
+    }
+}
+
+void MjpegFileReader::open()
+{
+    nextFrameIndex_ = 0;
+    nextFrameTime_ = std::chrono::steady_clock::now();
+}
+
+void MjpegFileReader::close()
+{
+    // Nothing to be done
+}
+
+/**
+ * @brief Get the next recorded frame, blocking until its time like a camera at the configured frame rate.
+ */
+bool MjpegFileReader::readImage(FrameRef& frame)
+{
+    frame.reset();
+
+    if (!framePool_->tryAcquire(frame))
+    {
+        throw std::runtime_error("Every frame of file reader is held by its consumers");
+    }
+
+    std::this_thread::sleep_until(nextFrameTime_);
+    nextFrameTime_ = std::max(nextFrameTime_ + framePeriod_, std::chrono::steady_clock::now());
+
+    const RecordedFrame& recordedFrame = frames_[nextFrameIndex_];
+    mjpegDecoder_.decode(fileData_.data() + recordedFrame.offset, recordedFrame.size, *frame);
+    frame->timeStamp = MediaClock::now();
+
+    nextFrameIndex_ = (nextFrameIndex_ + 1) % frames_.size();
+
+    return true;
+}
+
+/**
+ * @brief A frame starts on a SOI marker followed by another marker, and ends where the next frame starts.
+ */
+void MjpegFileReader::splitFrames()
+{
+    std::size_t frameStart = fileData_.size();
+
+    for (std::size_t i = 0; i + 2 < fileData_.size(); ++i)
+    {
+        if (fileData_[i] == 0xFF && fileData_[i + 1] == 0xD8 && fileData_[i + 2] == 0xFF)
+        {
+            if (frameStart < i)
+            {
+                frames_.push_back({frameStart, i - frameStart});
+            }
+            frameStart = i;
+        }
+    }
+
+    if (frameStart < fileData_.size())
+    {
+        frames_.push_back({frameStart, fileData_.size() - frameStart});
+    }
+}
+
+}    // namespace Model
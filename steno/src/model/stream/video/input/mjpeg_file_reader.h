@@ -0,0 +1,55 @@
+#ifndef MJPEG_FILE_READER_H
+#define MJPEG_FILE_READER_H
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "model/stream/utils/alloc/frame_pool.h"
+#include "model/stream/utils/alloc/i_object_factory.h"
+#include "model/stream/utils/images/mjpeg_decoder.h"
+#include "model/stream/utils/threads/task_scheduler.h"
+#include "model/stream/video/input/i_video_input.h"
+#include "model/stream/video/video_config.h"
+
+namespace Model
+{
+/**
+ * @brief Stand-in of a MJPEG camera, plays the frames recorded in a MJPEG file (JPEG frames back to back) in a loop
+ * at the frame rate of the video config. Frames are decoded like the camera captures.
+ */
+class MjpegFileReader : public IVideoInput
+{
+   public:
+    MjpegFileReader(const std::string& mjpegFilePath, std::shared_ptr<VideoConfig> videoConfig,
+                    std::shared_ptr<IObjectFactory> objectFactory, std::shared_ptr<TaskScheduler> taskScheduler);
+
+    void open() override;
+    void close() override;
+    bool readImage(FrameRef& frame) override;
+
+   private:
+    struct RecordedFrame
+    {
+        std::size_t offset;
+        std::size_t size;
+    };
+
+    void splitFrames();
+
+    std::shared_ptr<VideoConfig> videoConfig_;
+    std::vector<unsigned char> fileData_;
+    std::vector<RecordedFrame> frames_;
+    std::size_t nextFrameIndex_;
+
+    MjpegDecoder mjpegDecoder_;
+    std::shared_ptr<FramePool> framePool_;
+
+    std::chrono::steady_clock::duration framePeriod_;
+    std::chrono::steady_clock::time_point nextFrameTime_;
+};
+
+}    // namespace Model
+
+#endif    //! MJPEG_FILE_READER_H
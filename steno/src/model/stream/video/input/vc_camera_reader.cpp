@@ -5,21 +5,29 @@
 #include <sys/mman.h>
 #include <unistd.h>
 
-#include "model/stream/utils/time/time_utils.h"
+#include "model/stream/utils/alloc/heap_object_factory.h"
+#include "model/stream/utils/time/media_clock.h"
 
 namespace Model
 {
 VcCameraReader::VcCameraReader(std::shared_ptr<VideoConfig> videoConfig, std::size_t bufferCount)
     : BaseCameraReader(videoConfig)
-    , images_(bufferCount,
-              Image(videoConfig->resolution.width, videoConfig->resolution.height, videoConfig->imageFormat))
+    , framePool_(std::make_shared<FramePool>(
+          std::make_shared<HeapObjectFactory>(),
+          Image(videoConfig->resolution.width, videoConfig->resolution.height, videoConfig->imageFormat), bufferCount))
 {
 }
 
-bool VcCameraReader::readImage(Image& image)
+bool VcCameraReader::readImage(FrameRef& frame)
 {
-    image = images_.current();
+    frame.reset();
 
+    if (!framePool_->tryAcquire(frame))
+    {
+        throw std::runtime_error("Every frame of camera " + videoConfig_->deviceName + " is held by its consumers");
+    }
+
+    Image& image = *frame;
     size_t size = read(fd_, image.hostData, image.size);
 
     if (size != image.size)
@@ -27,20 +35,8 @@ bool VcCameraReader::readImage(Image& image)
         throw std::runtime_error("Could not read the entire image!");
     }
 
-    images_.next();
-
-    image.timeStamp = systemTimeSinceEpoch();
+    image.timeStamp = MediaClock::now();
 
     return true;
 }
-
-void VcCameraReader::initializeInternal()
-{
-    heapObjectFactory_.allocateObjectCircularBuffer(images_);
-}
-
-void VcCameraReader::finalizeInternal()
-{
-    heapObjectFactory_.deallocateObjectCircularBuffer(images_);
-}
 }    // namespace Model
@@ -3,10 +3,9 @@
 
 #include <linux/videodev2.h>
 
-#include "model/stream/utils/models/circular_buffer.h"
+#include "model/stream/utils/alloc/frame_pool.h"
 #include "model/stream/video/input/base_camera_reader.h"
 #include "model/stream/video/video_config.h"
-#include "model/stream/utils/alloc/heap_object_factory.h"
 
 namespace Model
 {
@@ -15,16 +14,10 @@ class VcCameraReader : public BaseCameraReader
    public:
     VcCameraReader(std::shared_ptr<VideoConfig> cameraConfig, std::size_t bufferCount);
 
-    bool readImage(Image& image) override;
+    bool readImage(FrameRef& frame) override;
 
    protected:
-    void initializeInternal() override;
-    void finalizeInternal() override;
-
-    CircularBuffer<Image> images_;
-
-   private:
-    HeapObjectFactory heapObjectFactory_;
+    std::shared_ptr<FramePool> framePool_;
 };
 
 }    // namespace Model
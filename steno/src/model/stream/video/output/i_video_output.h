@@ -1,7 +1,7 @@
 #ifndef I_VIDEO_OUTPUT_H
 #define I_VIDEO_OUTPUT_H
 
-#include "model/stream/utils/images/images.h"
+#include "model/stream/utils/images/frame_ref.h"
 
 namespace Model
 {
@@ -12,7 +12,7 @@ class IVideoOutput
 
     virtual void open() = 0;
     virtual void close() = 0;
-    virtual void writeImage(const Image& image) = 0;
+    virtual void writeImage(const FrameRef& frame) = 0;
 };
 
 }    // namespace Model
@@ -26,8 +26,10 @@ void ImageFileWriter::close()
     // Nothing to be done
 }
 
-void ImageFileWriter::writeImage(const Image& image)
+void ImageFileWriter::writeImage(const FrameRef& frame)
 {
+    const Image& image = *frame;
+
     Image outputImage;
 
     if (image.format != ImageFormat::RGB_FMT)
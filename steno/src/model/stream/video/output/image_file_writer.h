@@ -17,7 +17,7 @@ class ImageFileWriter : public IVideoOutput
 
     void open() override;
     void close() override;
-    void writeImage(const Image& image) override;
+    void writeImage(const FrameRef& frame) override;
 
    private:
     std::string folder_;
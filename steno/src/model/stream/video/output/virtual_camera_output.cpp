@@ -34,8 +34,10 @@ void VirtualCameraOutput::close()
     }
 }
 
-void VirtualCameraOutput::writeImage(const Image& image)
+void VirtualCameraOutput::writeImage(const FrameRef& frame)
 {
+    const Image& image = *frame;
+
     if (videoConfig_->imageFormat == image.format)
     {
         // This check doesn't seen to work as intended, for now it seems to work without the check
@@ -16,7 +16,7 @@ class VirtualCameraOutput : public IVideoOutput
 
     void open() override;
     void close() override;
-    void writeImage(const Image& image) override;
+    void writeImage(const FrameRef& frame) override;
 
    private:
     std::shared_ptr<VideoConfig> videoConfig_;
@@ -19,7 +19,8 @@ class VideoConfig : public BaseConfig
         WIDTH,
         HEIGHT,
         DEVICE_NAME,
-        IMAGE_FORMAT
+        IMAGE_FORMAT,
+        MJPEG_CAPTURE
     };
     Q_ENUM(Key)
 
@@ -35,12 +36,14 @@ class VideoConfig : public BaseConfig
         fpsTarget = value(Key::FPS).toInt();
         deviceName = value(Key::DEVICE_NAME).toString().toStdString();
         imageFormat = static_cast<ImageFormat>(value(Key::IMAGE_FORMAT).toInt());
+        isMjpegCapture = value(Key::MJPEG_CAPTURE).toBool();
     }
 
     Dim2<int> resolution;
     int fpsTarget;
     std::string deviceName;
-    ImageFormat imageFormat;
+    ImageFormat imageFormat;    // Format of the frames, decoded to it when the camera sends MJPEG
+    bool isMjpegCapture;
 };
 
 }    // namespace Model
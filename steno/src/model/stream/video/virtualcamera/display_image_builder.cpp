@@ -13,6 +13,7 @@ const int BACKGROUND_VALUE = 128;
 const RGB RGB_BACKGROUND = {220, 220, 220};
 const UYVY UYVY_BACKGROUND = {128, 220, 128, 220};
 const YUYV YUYV_BACKGROUND = {220, 128, 220, 128};
+const int ROWS_PER_TASK = 16;
 
 template <typename T>
 void setColor(T* data, int size, T color)
@@ -23,22 +24,61 @@ void setColor(T* data, int size, T color)
     }
 }
 
+/**
+ * @param [IN/OUT] inputColumns - input column of each displayed column, kept from frame to frame.
+ * @param [IN/OUT] inputColumnsWidth - input width the columns were computed for.
+ */
 template <typename T>
-void fillImage(int offset, const Dim2<int>& inputDim, const Dim2<int>& outputDim, const T* inputData, T* outputData)
+void fillImage(TaskScheduler* taskScheduler, std::vector<int>& inputColumns, int& inputColumnsWidth, int offset,
+               const Dim2<int>& inputDim, const Dim2<int>& displayedDim, const Dim2<int>& outputDim,
+               const T* inputData, T* outputData)
 {
-    for (int i = 0; i < inputDim.width; ++i)
+    if (inputDim == displayedDim)
     {
-        for (int j = 0; j < inputDim.height; ++j)
+        // Copy row by row, each row of the virtual camera is contiguous in both images
+        parallelFor(taskScheduler, TaskPriority::HIGH, 0, inputDim.height, ROWS_PER_TASK, [&](int begin, int end) {
+            for (int j = begin; j < end; ++j)
+            {
+                std::memcpy(outputData + offset + j * outputDim.width, inputData + j * inputDim.width,
+                            inputDim.width * sizeof(T));
+            }
+        });
+        return;
+    }
+
+    // Virtual camera was dewarped at a lower resolution, scale it to the displayed size with the nearest pixel. The
+    // columns only change with the virtual camera count or the quality level
+    if (inputColumnsWidth != inputDim.width || static_cast<int>(inputColumns.size()) != displayedDim.width)
+    {
+        inputColumns.resize(displayedDim.width);
+        for (int i = 0; i < displayedDim.width; ++i)
         {
-            outputData[offset + i + j * outputDim.width] = inputData[i + j * inputDim.width];
+            inputColumns[i] = (i * inputDim.width) / displayedDim.width;
         }
+        inputColumnsWidth = inputDim.width;
     }
+
+    parallelFor(taskScheduler, TaskPriority::HIGH, 0, displayedDim.height, ROWS_PER_TASK, [&](int begin, int end) {
+        for (int j = begin; j < end; ++j)
+        {
+            const T* inputRow = inputData + ((j * inputDim.height) / displayedDim.height) * inputDim.width;
+            T* outputRow = outputData + offset + j * outputDim.width;
+
+            for (int i = 0; i < displayedDim.width; ++i)
+            {
+                outputRow[i] = inputRow[inputColumns[i]];
+            }
+        }
+    });
 }
 
 }    // namespace
 
-DisplayImageBuilder::DisplayImageBuilder(const Dim2<int>& displayDimention)
+DisplayImageBuilder::DisplayImageBuilder(const Dim2<int>& displayDimention,
+                                         std::shared_ptr<TaskScheduler> taskScheduler)
     : displayDimention_(displayDimention)
+    , taskScheduler_(taskScheduler)
+    , inputColumnsWidth_(0)
 {
     int maxVcSize = displayDimention_.height - DISPLAY_HEIGHT_SPACING;
     maxVirtualCameraDim_ = Dim2<int>(maxVcSize, maxVcSize);    // For now virtual camera need to be square
@@ -75,12 +115,13 @@ Dim2<int> DisplayImageBuilder::getMaxVirtualCameraDim()
     return maxVirtualCameraDim_;
 }
 
-void DisplayImageBuilder::createDisplayImage(const std::vector<Image>& vcImages, const Image& outDisplayImage)
+void DisplayImageBuilder::createDisplayImage(const ArenaVector<Image>& vcImages, const Image& outDisplayImage)
 {
     int vcCount = (int)vcImages.size();
     if (displayDimention_ == outDisplayImage && vcCount > 0)
     {
-        Dim2<int> vcDim = vcImages[0];
+        // Virtual cameras can be smaller than their displayed size if they were dewarped at a lower resolution
+        Dim2<int> vcDim = getVirtualCameraDim(vcCount);
         int firstVcLeftOffset =
             (outDisplayImage.width - vcCount * vcDim.width - (vcCount - 1) * VIRTUAL_CAMERA_SPACING) / 2;
         int topOffset = ((outDisplayImage.height - vcDim.height) / 2) * outDisplayImage.width;
@@ -95,23 +136,28 @@ void DisplayImageBuilder::createDisplayImage(const std::vector<Image>& vcImages,
             {
                 const RGB* inputData = reinterpret_cast<const RGB*>(vcImage.hostData);
                 RGB* outputData = reinterpret_cast<RGB*>(outDisplayImage.hostData);
-                fillImage(offset, vcImage, outDisplayImage, inputData, outputData);
+                fillImage(taskScheduler_.get(), inputColumns_, inputColumnsWidth_, offset, vcImage, vcDim,
+                          outDisplayImage, inputData, outputData);
             }
             else if (vcImage.format == ImageFormat::UYVY_FMT && outDisplayImage.format == ImageFormat::UYVY_FMT)
             {
                 const UYVY* inputData = reinterpret_cast<const UYVY*>(vcImage.hostData);
                 UYVY* outputData = reinterpret_cast<UYVY*>(outDisplayImage.hostData);
                 Dim2<int> inputDim(vcImage.width / 2, vcImage.height);
+                Dim2<int> displayedDim(vcDim.width / 2, vcDim.height);
                 Dim2<int> outputDim(outDisplayImage.width / 2, outDisplayImage.height);
-                fillImage(offset / 2, inputDim, outputDim, inputData, outputData);
+                fillImage(taskScheduler_.get(), inputColumns_, inputColumnsWidth_, offset / 2, inputDim, displayedDim,
+                          outputDim, inputData, outputData);
             }
             else if (vcImage.format == ImageFormat::YUYV_FMT && outDisplayImage.format == ImageFormat::YUYV_FMT)
             {
                 const UYVY* inputData = reinterpret_cast<const UYVY*>(vcImage.hostData);
                 UYVY* outputData = reinterpret_cast<UYVY*>(outDisplayImage.hostData);
                 Dim2<int> inputDim(vcImage.width / 2, vcImage.height);
+                Dim2<int> displayedDim(vcDim.width / 2, vcDim.height);
                 Dim2<int> outputDim(outDisplayImage.width / 2, outDisplayImage.height);
-                fillImage(offset / 2, inputDim, outputDim, inputData, outputData);
+                fillImage(taskScheduler_.get(), inputColumns_, inputColumnsWidth_, offset / 2, inputDim, displayedDim,
+                          outputDim, inputData, outputData);
             }
             else
             {
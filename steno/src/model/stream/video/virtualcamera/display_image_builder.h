@@ -1,27 +1,36 @@
 #ifndef DISPLAY_IMAGE_BUILDER_H
 #define DISPLAY_IMAGE_BUILDER_H
 
+#include <memory>
 #include <vector>
 
+#include "model/stream/utils/alloc/monotonic_arena.h"
 #include "model/stream/utils/images/images.h"
 #include "model/stream/utils/models/dim2.h"
+#include "model/stream/utils/threads/task_scheduler.h"
 
 namespace Model
 {
 class DisplayImageBuilder
 {
    public:
-    explicit DisplayImageBuilder(const Dim2<int>& displayDimention);
+    explicit DisplayImageBuilder(const Dim2<int>& displayDimention,
+                                 std::shared_ptr<TaskScheduler> taskScheduler = nullptr);
 
     Dim2<int> getVirtualCameraDim(int virtualCameraCount);
     Dim2<int> getMaxVirtualCameraDim();
-    void createDisplayImage(const std::vector<Image>& vcImages, const Image& outDisplayImage);
+    void createDisplayImage(const ArenaVector<Image>& vcImages, const Image& outDisplayImage);
     void setDisplayImageColor(const Image& displayImage);
     void clearVirtualCamerasOnDisplayImage(const Image& displayImage);
 
    private:
     Dim2<int> displayDimention_;
     Dim2<int> maxVirtualCameraDim_;
+    std::shared_ptr<TaskScheduler> taskScheduler_;
+
+    // Input column of each displayed column of the virtual cameras dewarped at a lower resolution
+    std::vector<int> inputColumns_;
+    int inputColumnsWidth_;
 };
 
 }    // namespace Model
@@ -1,8 +1,7 @@
 #ifndef I_VIRTUAL_CAMERA_SOURCE_H
 #define I_VIRTUAL_CAMERA_SOURCE_H
 
-#include <vector>
-
+#include "model/stream/utils/alloc/monotonic_arena.h"
 #include "virtual_camera.h"
 
 namespace Model
@@ -12,7 +11,7 @@ class IVirtualCameraSource
    public:
     virtual ~IVirtualCameraSource() = default;
 
-    virtual std::vector<VirtualCamera> getVirtualCameras() = 0;
+    virtual void getVirtualCameras(ArenaVector<VirtualCamera>& outVirtualCameras) = 0;
 };
 
 }    // namespace Model
@@ -0,0 +1,58 @@
+#ifndef IMAGE_POSITIONS_H
+#define IMAGE_POSITIONS_H
+
+#include <array>
+#include <cstddef>
+
+#include "model/stream/utils/models/spherical_angle_rect.h"
+
+namespace Model
+{
+const int MAX_IMAGE_POSITIONS = 16;
+
+/**
+ * @brief Fixed capacity snapshot of the displayed virtual camera positions, so the video thread can publish them
+ * to the audio thread without allocating.
+ */
+struct ImagePositions
+{
+    ImagePositions()
+        : count(0)
+    {
+    }
+
+    std::size_t size() const
+    {
+        return count;
+    }
+
+    bool empty() const
+    {
+        return count == 0;
+    }
+
+    const SphericalAngleRect* begin() const
+    {
+        return positions.data();
+    }
+
+    const SphericalAngleRect* end() const
+    {
+        return positions.data() + count;
+    }
+
+    bool push(const SphericalAngleRect& position)
+    {
+        if (count == positions.size()) return false;
+
+        positions[count++] = position;
+        return true;
+    }
+
+    std::array<SphericalAngleRect, MAX_IMAGE_POSITIONS> positions;
+    std::size_t count;
+};
+
+}    // namespace Model
+
+#endif    //! IMAGE_POSITIONS_H
@@ -1,7 +1,9 @@
 #include "virtual_camera_manager.h"
 
+#include <algorithm>
 #include <cmath>
 #include <limits>
+#include <tuple>
 
 #include "model/stream/utils/math/angle_calculations.h"
 #include "model/stream/utils/math/helpers.h"
@@ -31,9 +33,10 @@ VirtualCameraManager::VirtualCameraManager(float aspectRatio, float srcImageMinE
 {
 }
 
-void VirtualCameraManager::updateVirtualCameras(int elapsedTimeMs)
+void VirtualCameraManager::updateVirtualCameras(int elapsedTimeMs, MonotonicArena& frameArena)
 {
-    std::vector<VirtualCamera> virtualCameras = getVirtualCameras();
+    ArenaVector<VirtualCamera> virtualCameras(frameArena);
+    getVirtualCameras(virtualCameras);
 
     if (virtualCameras.empty()) return;
 
@@ -76,30 +79,33 @@ void VirtualCameraManager::updateVirtualCameras(int elapsedTimeMs)
     setVirtualCameras(virtualCameras);
 }
 
-void VirtualCameraManager::updateVirtualCamerasGoal(std::vector<SphericalAngleRect> goals)
+void VirtualCameraManager::updateVirtualCamerasGoal(const std::vector<SphericalAngleRect>& newGoals,
+                                                    MonotonicArena& frameArena)
 {
-    if (goals.empty()) return;
+    if (newGoals.empty()) return;
 
     // Update the goals elevation and spans to be within bounds
+    ArenaVector<SphericalAngleRect> goals(newGoals.begin(), newGoals.end(), frameArena);
     updateRegionsBounds(goals);
 
-    // Get the distance between each virtual camera and each goal in a sorted map (map values are indices pair)
-    const std::multimap<float, std::pair<int, int>> orderedDistanceMap = getVcToGoalOrderedDistances(goals);
+    // Get the distance between each virtual camera and each goal, sorted from the closest
+    ArenaVector<VcToGoalDistance> orderedDistances(frameArena);
+    getVcToGoalOrderedDistances(goals, orderedDistances);
 
     // Create vectors to keep track of which virtual camera and goal were matched
     const int vcCount = virtualCameras_.size();
     const int goalCount = goals.size();
-    std::vector<bool> isVcUnmatchedVec(vcCount, true);
-    std::vector<bool> isGoalUnmatchedVec(goalCount, true);
+    ArenaVector<bool> isVcUnmatchedVec(vcCount, true, frameArena);
+    ArenaVector<bool> isGoalUnmatchedVec(goalCount, true, frameArena);
 
     int matchedVcCount = 0;
     int matchedGoalCount = 0;
 
     // Update the virtual camera goals
-    for (const auto& entry : orderedDistanceMap)
+    for (const VcToGoalDistance& entry : orderedDistances)
     {
-        int vcIndex = entry.second.first;
-        int goalIndex = entry.second.second;
+        int vcIndex = entry.vcIndex;
+        int goalIndex = entry.goalIndex;
 
         // Make sure the virtual camera and the goal are unmatched
         if (isVcUnmatchedVec[vcIndex] && isGoalUnmatchedVec[goalIndex])
@@ -139,17 +145,17 @@ void VirtualCameraManager::clearVirtualCameras()
     virtualCameras_.clear();
 }
 
-std::vector<VirtualCamera> VirtualCameraManager::getVirtualCameras()
+void VirtualCameraManager::getVirtualCameras(ArenaVector<VirtualCamera>& outVirtualCameras)
 {
     std::lock_guard<std::mutex> lock(mutex_);
-    return virtualCameras_;
+    outVirtualCameras.assign(virtualCameras_.begin(), virtualCameras_.end());
 }
 
- void VirtualCameraManager::setVirtualCameras(const std::vector<VirtualCamera>& virtualCameras)
- {
-     std::lock_guard<std::mutex> lock(mutex_);
-     virtualCameras_ = virtualCameras;
- }
+void VirtualCameraManager::setVirtualCameras(const ArenaVector<VirtualCamera>& virtualCameras)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    virtualCameras_.assign(virtualCameras.begin(), virtualCameras.end());
+}
 
 float VirtualCameraManager::getElevationOverflow(float elevation, float elevationSpan)
 {
@@ -168,7 +174,7 @@ float VirtualCameraManager::getElevationOverflow(float elevation, float elevatio
     return elevationOverflow;
 }
 
-void VirtualCameraManager::updateRegionsBounds(std::vector<SphericalAngleRect>& regions)
+void VirtualCameraManager::updateRegionsBounds(ArenaVector<SphericalAngleRect>& regions)
 {
     for (SphericalAngleRect& region : regions)
     {
@@ -180,12 +186,13 @@ void VirtualCameraManager::updateRegionsBounds(std::vector<SphericalAngleRect>&
     }
 }
 
-std::multimap<float, std::pair<int, int>> VirtualCameraManager::getVcToGoalOrderedDistances(
-    const std::vector<SphericalAngleRect>& goals)
+void VirtualCameraManager::getVcToGoalOrderedDistances(const ArenaVector<SphericalAngleRect>& goals,
+                                                       ArenaVector<VcToGoalDistance>& outDistances)
 {
-    std::multimap<float, std::pair<int, int>> distanceIndicesMap;
     const int regionCount = virtualCameras_.size();
     const int goalsCount = goals.size();
+    outDistances.clear();
+    outDistances.reserve(regionCount * goalsCount);
 
     for (int regionIndex = 0; regionIndex < regionCount; ++regionIndex)
     {
@@ -196,11 +203,14 @@ std::multimap<float, std::pair<int, int>> VirtualCameraManager::getVcToGoalOrder
             const SphericalAngleRect& goal = goals[goalIndex];
             float distance = math::getApproximatedSphericalAnglesDistance(region.azimuth, region.elevation,
                                                                           goal.azimuth, goal.elevation);
-            distanceIndicesMap.emplace(distance, std::pair<int, int>(regionIndex, goalIndex));
+            outDistances.push_back({distance, regionIndex, goalIndex});
         }
     }
 
-    return distanceIndicesMap;
+    // Equal distances are in insertion order, as they would be in a multimap
+    std::sort(outDistances.begin(), outDistances.end(), [](const VcToGoalDistance& lhs, const VcToGoalDistance& rhs) {
+        return std::tie(lhs.distance, lhs.vcIndex, lhs.goalIndex) < std::tie(rhs.distance, rhs.vcIndex, rhs.goalIndex);
+    });
 }
 
 }    // namespace Model
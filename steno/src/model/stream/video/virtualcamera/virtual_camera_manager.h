@@ -1,10 +1,10 @@
 #ifndef VIRTUAL_CAMERA_MANAGER_H
 #define VIRTUAL_CAMERA_MANAGER_H
 
-#include <map>
 #include <mutex>
 #include <vector>
 
+#include "model/stream/utils/alloc/monotonic_arena.h"
 #include "model/stream/utils/models/spherical_angle_rect.h"
 #include "model/stream/video/virtualcamera/i_virtual_camera_source.h"
 #include "model/stream/video/virtualcamera/virtual_camera.h"
@@ -16,18 +16,25 @@ class VirtualCameraManager : public IVirtualCameraSource
    public:
     VirtualCameraManager(float aspectRatio, float srcImageMinElevation, float srcImageMaxElevation);
 
-    void updateVirtualCameras(int elapsedTimeMs);
-    void updateVirtualCamerasGoal(std::vector<SphericalAngleRect> goals);
+    void updateVirtualCameras(int elapsedTimeMs, MonotonicArena& frameArena);
+    void updateVirtualCamerasGoal(const std::vector<SphericalAngleRect>& newGoals, MonotonicArena& frameArena);
     void clearVirtualCameras();
 
-    std::vector<VirtualCamera> getVirtualCameras() override;
+    void getVirtualCameras(ArenaVector<VirtualCamera>& outVirtualCameras) override;
 
    private:
+    struct VcToGoalDistance
+    {
+        float distance;
+        int vcIndex;
+        int goalIndex;
+    };
+
     float getElevationOverflow(float elevation, float elevationSpan);
-    void updateRegionsBounds(std::vector<SphericalAngleRect>& regions);
-    std::multimap<float, std::pair<int, int>> getVcToGoalOrderedDistances(
-        const std::vector<SphericalAngleRect>& targets);
-    void setVirtualCameras(const std::vector<VirtualCamera>& virtualCameras);
+    void updateRegionsBounds(ArenaVector<SphericalAngleRect>& regions);
+    void getVcToGoalOrderedDistances(const ArenaVector<SphericalAngleRect>& goals,
+                                     ArenaVector<VcToGoalDistance>& outDistances);
+    void setVirtualCameras(const ArenaVector<VirtualCamera>& virtualCameras);
 
     float aspectRatio_;
     float srcImageMinElevation_;
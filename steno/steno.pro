@@ -37,12 +37,13 @@ MOC_DIR = bin
 UI_DIR = bin
 
 # Add 3rd party library dependency
-LIBS += $$V4L2_LIBS $$DARKNET_LIBS -lpulse-simple -lpulse -lpthread
+LIBS += $$V4L2_LIBS $$DARKNET_LIBS -ljpeg -lpulse -lpthread
 
 INCLUDEPATH *= src
 
 SOURCES += \
     src/main.cpp \
+    src/model/audio_mixer/audio_mixer.cpp \
     src/model/audio_suppresser/audio_suppresser.cpp \
     src/model/classifier/classifier.cpp \
     src/model/config/base_config.cpp \
@@ -59,24 +60,44 @@ SOURCES += \
     src/model/utils/filesutil.cpp \
     src/model/utils/observer/subject.cpp \
     src/model/utils/time.cpp \
+    src/model/stream/audio/audio_jitter_buffer.cpp \
+    src/model/stream/audio/audio_ring_buffer.cpp \
+    src/model/stream/audio/file/async_file_audio_sink.cpp \
     src/model/stream/audio/file/raw_file_audio_sink.cpp \
     src/model/stream/audio/odas/odas_audio_source.cpp \
     src/model/stream/audio/odas/odas_client.cpp \
+    src/model/stream/audio/odas/odas_position_parser.cpp \
     src/model/stream/audio/odas/odas_position_source.cpp \
+    src/model/stream/audio/odas/odas_socket_reactor.cpp \
     src/model/stream/audio/pulseaudio/pulseaudio_sink.cpp \
     src/model/stream/audio/source_position.cpp \
-    src/model/stream/frame_rate_stabilizer.cpp \
+    src/model/stream/audio/source_position_history.cpp \
+    src/model/stream/frame_pacer.cpp \
+    src/model/stream/audio_thread.cpp \
     src/model/stream/media_synchronizer.cpp \
     src/model/stream/media_thread.cpp \
+    src/model/stream/quality_governor.cpp \
     src/model/stream/stream.cpp \
+    src/model/stream/utils/alloc/accounting_object_factory.cpp \
+    src/model/stream/utils/alloc/block_pool.cpp \
+    src/model/stream/utils/alloc/frame_pool.cpp \
     src/model/stream/utils/alloc/heap_object_factory.cpp \
+    src/model/stream/utils/alloc/memory_accounting.cpp \
+    src/model/stream/utils/alloc/monotonic_arena.cpp \
+    src/model/stream/utils/alloc/pooled_object_factory.cpp \
+    src/model/stream/utils/audio/polyphase_resampler.cpp \
+    src/model/stream/utils/audio/sample_conversion.cpp \
+    src/model/stream/utils/images/frame_ref.cpp \
     src/model/stream/utils/images/image_converter.cpp \
     src/model/stream/utils/images/image_format.cpp \
+    src/model/stream/utils/images/mjpeg_decoder.cpp \
     src/model/stream/utils/images/stb/stb_image.cpp \
     src/model/stream/utils/images/stb/stb_image_write.cpp \
     src/model/stream/utils/math/angle_calculations.cpp \
     src/model/stream/utils/math/geometry_utils.cpp \
+    src/model/stream/utils/time/media_clock.cpp \
     src/model/stream/utils/time/time_utils.cpp \
+    src/model/stream/utils/threads/task_scheduler.cpp \
     src/model/stream/utils/threads/thread.cpp \
     src/model/stream/video/detection/base_darknet_detector.cpp \
     src/model/stream/video/detection/darknet_detector.cpp \
@@ -93,6 +114,7 @@ SOURCES += \
     src/model/stream/video/input/vc_camera_reader.cpp \
     src/model/stream/video/input/dewarped_video_input.cpp \
     src/model/stream/video/input/image_file_reader.cpp \
+    src/model/stream/video/input/mjpeg_file_reader.cpp \
     src/model/stream/video/output/image_file_writer.cpp \
     src/model/stream/video/output/virtual_camera_output.cpp \
     src/model/stream/video/virtualcamera/display_image_builder.cpp \
@@ -107,6 +129,7 @@ SOURCES += \
 
 HEADERS += \
     src/model/app_config.h \
+    src/model/audio_mixer/audio_mixer.h \
     src/model/audio_suppresser/audio_suppresser.h \
     src/model/classifier/classifier.h \
     src/model/config/base_config.h \
@@ -119,6 +142,9 @@ HEADERS += \
     src/model/media_player/subtitles/subtitles.h \
     src/model/recorder/i_recorder.h \
     src/model/stream/audio/audio_config.h \
+    src/model/stream/audio/audio_format.h \
+    src/model/stream/audio/audio_jitter_buffer.h \
+    src/model/stream/audio/audio_ring_buffer.h \
     src/model/stream/default_image_thread.h \
     src/model/stream/default_stream.h \
     src/model/stream/stream_config.h \
@@ -133,28 +159,46 @@ HEADERS += \
     src/model/stream/audio/i_audio_sink.h \
     src/model/stream/audio/i_audio_source.h \
     src/model/stream/audio/i_position_source.h \
+    src/model/stream/audio/file/async_file_audio_sink.h \
     src/model/stream/audio/file/raw_file_audio_sink.h \
     src/model/stream/audio/odas/odas_audio_source.h \
     src/model/stream/audio/odas/odas_client.h \
+    src/model/stream/audio/odas/odas_position_parser.h \
     src/model/stream/audio/odas/odas_position_source.h \
+    src/model/stream/audio/odas/odas_shm_format.h \
+    src/model/stream/audio/odas/odas_socket_reactor.h \
     src/model/stream/audio/pulseaudio/pulseaudio_sink.h \
     src/model/stream/audio/source_position.h \
-    src/model/stream/frame_rate_stabilizer.h \
+    src/model/stream/audio/source_position_history.h \
+    src/model/stream/audio/source_positions.h \
+    src/model/stream/frame_pacer.h \
     src/model/stream/i_stream.h \
+    src/model/stream/audio_thread.h \
     src/model/stream/media_synchronizer.h \
     src/model/stream/media_thread.h \
+    src/model/stream/quality_governor.h \
     src/model/stream/stream.h \
     src/model/stream/utils/alloc/cuda/device_cuda_object_factory.h \
     src/model/stream/utils/alloc/cuda/managed_memory_cuda_object_factory.h \
     src/model/stream/utils/alloc/cuda/zero_copy_cuda_object_factory.h \
+    src/model/stream/utils/alloc/accounting_object_factory.h \
+    src/model/stream/utils/alloc/block_pool.h \
+    src/model/stream/utils/alloc/frame_pool.h \
     src/model/stream/utils/alloc/heap_object_factory.h \
+    src/model/stream/utils/alloc/memory_accounting.h \
+    src/model/stream/utils/alloc/monotonic_arena.h \
+    src/model/stream/utils/alloc/pooled_object_factory.h \
     src/model/stream/utils/alloc/i_object_factory.h \
+    src/model/stream/utils/audio/polyphase_resampler.h \
+    src/model/stream/utils/audio/sample_conversion.h \
     src/model/stream/utils/array_utils.h \
     src/model/stream/utils/images/cuda/cuda_image_converter.h \
+    src/model/stream/utils/images/frame_ref.h \
     src/model/stream/utils/images/i_image_converter.h \
     src/model/stream/utils/images/image_converter.h \
     src/model/stream/utils/images/image_format.h \
     src/model/stream/utils/images/images.h \
+    src/model/stream/utils/images/mjpeg_decoder.h \
     src/model/stream/utils/images/stb/stb_image.h \
     src/model/stream/utils/images/stb/stb_image_write.h \
     src/model/stream/utils/macros/packing.h \
@@ -172,12 +216,16 @@ HEADERS += \
     src/model/stream/utils/models/spherical_angle_box.h \
     src/model/stream/utils/models/spherical_angle_rect.h \
     src/model/stream/utils/threads/atomicops.h \
+    src/model/stream/utils/threads/latest_value_mailbox.h \
     src/model/stream/utils/threads/lock_triple_buffer.h \
     src/model/stream/utils/threads/readerwriterqueue.h \
+    src/model/stream/utils/threads/seqlock.h \
+    src/model/stream/utils/threads/task_scheduler.h \
     src/model/stream/utils/threads/sync/cuda_synchronizer.h \
     src/model/stream/utils/threads/sync/i_synchronizer.h \
     src/model/stream/utils/threads/sync/nop_synchronizer.h \
     src/model/stream/utils/threads/thread.h \
+    src/model/stream/utils/time/media_clock.h \
     src/model/stream/utils/time/time_utils.h \
     src/model/stream/utils/time/timer.h \
     src/model/stream/utils/vector_utils.h \
@@ -213,12 +261,14 @@ HEADERS += \
     src/model/stream/video/input/dewarped_video_input.h \
     src/model/stream/video/input/image_file_reader.h \
     src/model/stream/video/input/i_video_input.h \
+    src/model/stream/video/input/mjpeg_file_reader.h \
     src/model/stream/video/output/image_file_writer.h \
     src/model/stream/video/output/i_video_output.h \
     src/model/stream/video/output/virtual_camera_output.h \
     src/model/stream/video/video_config.h \
     src/model/stream/video/virtualcamera/display_image_builder.h \
     src/model/stream/video/virtualcamera/i_virtual_camera_source.h \
+    src/model/stream/video/virtualcamera/image_positions.h \
     src/model/stream/video/virtualcamera/virtual_camera.h \
     src/model/stream/video/virtualcamera/virtual_camera_manager.h \
     src/view/components/colors.h \
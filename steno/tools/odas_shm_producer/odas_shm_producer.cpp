@@ -0,0 +1,310 @@
+/**
+ * Stand-in for an odaslive with the shared memory interface of odas_shm_format.h, to run steno with
+ * ODAS_TRANSPORT=shm without the microphone array. It connects to the socket of one stream and publishes
+ * synthetic messages until steno closes the connection:
+ *  - audio : packets of the default odas audio input config, an 8 bytes microseconds timestamp followed by 4096
+ *            bytes of 16 bits samples. Each channel is a tone of its own.
+ *  - positions : tracked sources messages, one source going around the array every 10 seconds.
+ *
+ * Usage : odas_shm_producer <audio|positions> <socket path> [channels] [rate]
+ * The sockets are steno-odas-audio.sock and steno-odas-positions.sock in the ODAS_SOCKET_FOLDER of steno.
+ */
+
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "model/stream/audio/odas/odas_shm_format.h"
+
+using namespace Model;
+
+namespace
+{
+const std::size_t PACKET_HEADER_SIZE = 8;
+const std::size_t PACKET_AUDIO_SIZE = 4096;
+const int DEFAULT_CHANNELS = 4;
+const int DEFAULT_RATE = 16000;
+
+// Odas sends the tracked sources once per frame of 128 samples at 16 kHz
+const std::chrono::microseconds POSITIONS_PERIOD(8000);
+const int MAX_POSITION_SOURCES = 4;
+const double SOURCE_TURN_SECONDS = 10;
+
+const double PI = 3.14159265358979323846;
+
+volatile sig_atomic_t isStopRequested = 0;
+
+void requestStop(int)
+{
+    isStopRequested = 1;
+}
+
+struct SharedMemory
+{
+    int eventFd = -1;
+    uint8_t* ring = nullptr;
+    std::size_t size = 0;
+};
+
+int connectSocket(const std::string& socketPath)
+{
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path))
+    {
+        std::cout << "Socket path is too long : " << socketPath << std::endl;
+        return -1;
+    }
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    int socketFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (socketFd < 0 || connect(socketFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0)
+    {
+        std::cout << "Can't connect to " << socketPath << " : " << std::strerror(errno) << std::endl;
+        if (socketFd >= 0)
+        {
+            close(socketFd);
+        }
+        return -1;
+    }
+
+    return socketFd;
+}
+
+/**
+ * @brief Receive the handshake and the [memfd, eventfd] descriptors steno sends on connection, and map the ring.
+ */
+bool receiveSharedMemory(int socketFd, SharedMemory& outMemory)
+{
+    OdasShmHandshake handshake = {};
+    iovec data = {&handshake, sizeof(handshake)};
+
+    int fds[2] = {-1, -1};
+    char control[CMSG_SPACE(sizeof(fds))] = {};
+
+    msghdr message = {};
+    message.msg_iov = &data;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+
+    ssize_t byteCount = recvmsg(socketFd, &message, MSG_CMSG_CLOEXEC | MSG_WAITALL);
+    cmsghdr* controlMessage = CMSG_FIRSTHDR(&message);
+    if (byteCount != static_cast<ssize_t>(sizeof(handshake)) || controlMessage == nullptr ||
+        controlMessage->cmsg_type != SCM_RIGHTS || controlMessage->cmsg_len != CMSG_LEN(sizeof(fds)))
+    {
+        std::cout << "Invalid handshake" << std::endl;
+        return false;
+    }
+    std::memcpy(fds, CMSG_DATA(controlMessage), sizeof(fds));
+
+    if (handshake.magic != ODAS_SHM_MAGIC || handshake.version != ODAS_SHM_VERSION)
+    {
+        std::cout << "Unsupported shared memory version " << handshake.version << std::endl;
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+
+    void* ring = mmap(nullptr, handshake.memorySize, PROT_READ | PROT_WRITE, MAP_SHARED, fds[0], 0);
+    close(fds[0]);
+    if (ring == MAP_FAILED)
+    {
+        std::cout << "Can't map the shared memory : " << std::strerror(errno) << std::endl;
+        close(fds[1]);
+        return false;
+    }
+
+    const OdasShmRingHeader* header = static_cast<const OdasShmRingHeader*>(ring);
+    if (header->magic != ODAS_SHM_MAGIC || header->version != ODAS_SHM_VERSION || header->slotCount == 0 ||
+        getOdasShmMemorySize(header->slotSize, header->slotCount) > handshake.memorySize)
+    {
+        std::cout << "Invalid ring header" << std::endl;
+        munmap(ring, handshake.memorySize);
+        close(fds[1]);
+        return false;
+    }
+
+    outMemory.eventFd = fds[1];
+    outMemory.ring = static_cast<uint8_t*>(ring);
+    outMemory.size = handshake.memorySize;
+    return true;
+}
+
+/**
+ * @brief Publish one message as described in odas_shm_format.h.
+ * @return false if the ring was full and the message dropped.
+ */
+bool publish(SharedMemory& memory, const uint8_t* payload, std::size_t size)
+{
+    OdasShmRingHeader* header = reinterpret_cast<OdasShmRingHeader*>(memory.ring);
+    uint64_t writeIndex = header->writeIndex;
+
+    if (writeIndex - __atomic_load_n(&header->readIndex, __ATOMIC_ACQUIRE) == header->slotCount)
+    {
+        ++header->droppedCount;
+        return false;
+    }
+
+    uint8_t* slot = memory.ring + sizeof(OdasShmRingHeader) +
+                    (writeIndex % header->slotCount) * getOdasShmSlotStride(header->slotSize);
+    OdasShmSlotHeader* slotHeader = reinterpret_cast<OdasShmSlotHeader*>(slot);
+    slotHeader->size = static_cast<uint32_t>(std::min<std::size_t>(size, header->slotSize));
+    std::memcpy(slot + sizeof(OdasShmSlotHeader), payload, slotHeader->size);
+
+    __atomic_store_n(&header->writeIndex, writeIndex + 1, __ATOMIC_RELEASE);
+
+    uint64_t notification = 1;
+    return write(memory.eventFd, &notification, sizeof(notification)) == sizeof(notification);
+}
+
+/**
+ * @brief Steno closes the connection when the stream stops or a new producer replaces this one.
+ */
+bool isConnected(int socketFd)
+{
+    char byte;
+    ssize_t byteCount = recv(socketFd, &byte, sizeof(byte), MSG_DONTWAIT | MSG_PEEK);
+    return byteCount != 0 && (byteCount > 0 || errno == EAGAIN || errno == EWOULDBLOCK);
+}
+
+uint64_t getMicroseconds()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void produceAudio(int socketFd, SharedMemory& memory, int channels, int rate)
+{
+    std::size_t frameCount = PACKET_AUDIO_SIZE / (channels * sizeof(int16_t));
+    std::chrono::microseconds packetPeriod(static_cast<int64_t>(frameCount * 1000000 / rate));
+
+    std::vector<uint8_t> packet(PACKET_HEADER_SIZE + PACKET_AUDIO_SIZE, 0);
+    int16_t* samples = reinterpret_cast<int16_t*>(packet.data() + PACKET_HEADER_SIZE);
+
+    uint64_t timestamp = getMicroseconds();
+    uint64_t frameIndex = 0;
+    std::size_t droppedCount = 0;
+    auto nextPacketTime = std::chrono::steady_clock::now();
+
+    while (!isStopRequested && isConnected(socketFd))
+    {
+        std::memcpy(packet.data(), &timestamp, sizeof(timestamp));
+
+        for (std::size_t frame = 0; frame < frameCount; ++frame, ++frameIndex)
+        {
+            for (int channel = 0; channel < channels; ++channel)
+            {
+                double frequency = 220.0 * (channel + 1);
+                samples[frame * channels + channel] =
+                    static_cast<int16_t>(8000 * std::sin(2 * PI * frequency * frameIndex / rate));
+            }
+        }
+
+        droppedCount += publish(memory, packet.data(), packet.size()) ? 0 : 1;
+
+        timestamp += packetPeriod.count();
+        nextPacketTime += packetPeriod;
+        std::this_thread::sleep_until(nextPacketTime);
+    }
+
+    std::cout << droppedCount << " audio packets dropped" << std::endl;
+}
+
+void producePositions(int socketFd, SharedMemory& memory)
+{
+    uint64_t startTime = getMicroseconds();
+    uint64_t frameIndex = 0;
+    std::size_t droppedCount = 0;
+    auto nextMessageTime = std::chrono::steady_clock::now();
+
+    while (!isStopRequested && isConnected(socketFd))
+    {
+        double angle = 2 * PI * (getMicroseconds() - startTime) / (SOURCE_TURN_SECONDS * 1000000);
+
+        std::string message = "{\n    \"timeStamp\": " + std::to_string(frameIndex++) + ",\n    \"src\": [\n";
+        for (int source = 0; source < MAX_POSITION_SOURCES; ++source)
+        {
+            // Odas always sends every tracked source, the inactive ones are at the origin
+            bool isActive = source == 0;
+            char sourceText[160];
+            std::snprintf(sourceText, sizeof(sourceText),
+                          "        { \"id\": %d, \"tag\": \"%s\", \"x\": %.3f, \"y\": %.3f, \"z\": %.3f, "
+                          "\"activity\": %.3f }%s\n",
+                          isActive ? 1 : 0, isActive ? "dynamic" : "", isActive ? 0.866 * std::cos(angle) : 0.0,
+                          isActive ? 0.866 * std::sin(angle) : 0.0, isActive ? 0.5 : 0.0, isActive ? 0.9 : 0.0,
+                          source + 1 < MAX_POSITION_SOURCES ? "," : "");
+            message += sourceText;
+        }
+        message += "    ]\n}\n";
+
+        droppedCount += publish(memory, reinterpret_cast<const uint8_t*>(message.data()), message.size()) ? 0 : 1;
+
+        nextMessageTime += POSITIONS_PERIOD;
+        std::this_thread::sleep_until(nextMessageTime);
+    }
+
+    std::cout << droppedCount << " position messages dropped" << std::endl;
+}
+
+}    // namespace
+
+int main(int argc, char* argv[])
+{
+    std::string stream = argc > 1 ? argv[1] : "";
+    if (argc < 3 || (stream != "audio" && stream != "positions"))
+    {
+        std::cout << "Usage : " << argv[0] << " <audio|positions> <socket path> [channels] [rate]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    int channels = argc > 3 ? std::atoi(argv[3]) : DEFAULT_CHANNELS;
+    int rate = argc > 4 ? std::atoi(argv[4]) : DEFAULT_RATE;
+    if (channels <= 0 || rate <= 0 || PACKET_AUDIO_SIZE % (channels * sizeof(int16_t)) != 0)
+    {
+        std::cout << "Invalid audio format" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    signal(SIGINT, requestStop);
+    signal(SIGTERM, requestStop);
+
+    int socketFd = connectSocket(argv[2]);
+    SharedMemory memory;
+    if (socketFd < 0 || !receiveSharedMemory(socketFd, memory))
+    {
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Connected to " << argv[2] << ", publishing " << stream << std::endl;
+
+    if (stream == "audio")
+    {
+        produceAudio(socketFd, memory, channels, rate);
+    }
+    else
+    {
+        producePositions(socketFd, memory);
+    }
+
+    munmap(memory.ring, memory.size);
+    close(memory.eventFd);
+    close(socketFd);
+
+    return EXIT_SUCCESS;
+}
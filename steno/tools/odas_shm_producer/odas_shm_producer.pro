@@ -0,0 +1,17 @@
+# Stand-in producer for the ODAS shared memory transport, see odas_shm_producer.cpp
+
+TEMPLATE = app
+TARGET = odas_shm_producer
+
+CONFIG += console c++14
+CONFIG -= qt app_bundle
+
+DESTDIR = bin
+OBJECTS_DIR = bin
+
+INCLUDEPATH += ../../src
+
+LIBS += -lpthread
+
+SOURCES += \
+    odas_shm_producer.cpp